@@ -0,0 +1,88 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "kassert/kassert.hpp"
+
+// Compares the cost of a cheap assertion in a hot loop against the same loop without assertions. Build the benchmark
+// with and without KASSERT_RUNTIME_ASSERTION_LEVEL to compare the runtime gate against the pure compile-time gate.
+
+namespace {
+std::vector<std::int64_t> make_input(std::size_t const size) {
+    std::vector<std::int64_t> input(size);
+    std::iota(input.begin(), input.end(), 0);
+    return input;
+}
+
+void BM_sum_unchecked(benchmark::State& state) {
+    auto const input = make_input(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (auto const value: input) {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_sum_unchecked)->Arg(1 << 16);
+
+void BM_sum_checked(benchmark::State& state) {
+    auto const input = make_input(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (auto const value: input) {
+            KASSERT(value >= 0, "", kassert::assert::normal);
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_sum_checked)->Arg(1 << 16);
+
+void BM_sum_checked_sampled(benchmark::State& state) {
+    auto const input = make_input(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (auto const value: input) {
+            KASSERT_SAMPLED(value >= 0, "", kassert::assert::normal, 100);
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_sum_checked_sampled)->Arg(1 << 16);
+
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+void BM_sum_checked_disabled_at_runtime(benchmark::State& state) {
+    auto const input = make_input(static_cast<std::size_t>(state.range(0)));
+    int const  level = kassert::assertion_level();
+    kassert::set_assertion_level(kassert::assert::normal - 1);
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (auto const value: input) {
+            KASSERT(value >= 0, "", kassert::assert::normal);
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    kassert::set_assertion_level(level);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_sum_checked_disabled_at_runtime)->Arg(1 << 16);
+#endif
+} // namespace
+
+BENCHMARK_MAIN();
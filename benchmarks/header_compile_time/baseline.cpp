@@ -0,0 +1,8 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Baseline of the header compile time benchmark: plain checks without KAssert.
+
+#define ASSERTIONS_WITHOUT_KASSERT
+#include "assertions.inc"
@@ -0,0 +1,9 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Assertions using the iostream-free header.
+
+#include "kassert/core.hpp"
+
+#include "assertions.inc"
@@ -0,0 +1,9 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Assertions using the full header, including the stream-based stringification.
+
+#include "kassert/kassert.hpp"
+
+#include "assertions.inc"
@@ -0,0 +1,78 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// 10000 decomposed assertions over operands of ten different types, generated by the preprocessor: 1000 functions
+// with ten assertions each. Measures how the compile time scales with the number of call sites and expression types,
+// e.g., with KASSERT_TYPE_ERASED_OPERANDS. If ASSERTIONS_WITHOUT_KASSERT is defined, the assertions are replaced by
+// plain checks.
+
+#include <cstddef>
+#include <cstdlib>
+
+#ifdef ASSERTIONS_WITHOUT_KASSERT
+    #define CHECK(expression, message) \
+        if (!(expression)) {           \
+            std::abort();              \
+        }
+#else
+    #include "kassert/kassert.hpp"
+    #define CHECK(expression, message) KASSERT(expression, message)
+#endif
+
+enum class Color { red, green, blue };
+
+// Ten assertions with different operand types; `offset` makes the expressions of the functions differ.
+#define FUNCTION(name)                                                                                                 \
+    int name(                                                                                                          \
+        int i, unsigned u, long l, double d, float f, char c, std::size_t s, int const* p, Color e, bool b, int offset \
+    ) {                                                                                                                \
+        CHECK(i == offset, "int");                                                                                     \
+        CHECK(u != 2u, "unsigned " << u);                                                                              \
+        CHECK(l < 3l + offset, "long");                                                                                \
+        CHECK(d <= 4.0, "double " << d);                                                                               \
+        CHECK(f > 5.0f, "float");                                                                                      \
+        CHECK(c >= 'a', "char " << c);                                                                                 \
+        CHECK(s == static_cast<std::size_t>(offset), "size");                                                          \
+        CHECK(p != nullptr, "pointer");                                                                                \
+        CHECK(e == Color::green, "enum");                                                                              \
+        CHECK(b, "bool");                                                                                              \
+        return i + offset;                                                                                             \
+    }
+
+// Each level of macros pastes one more digit to the function name, i.e., FUNCTIONS_1000(f) defines f000 to f999.
+#define FUNCTIONS_10(prefix) \
+    FUNCTION(prefix##0)      \
+    FUNCTION(prefix##1)      \
+    FUNCTION(prefix##2)      \
+    FUNCTION(prefix##3)      \
+    FUNCTION(prefix##4)      \
+    FUNCTION(prefix##5)      \
+    FUNCTION(prefix##6)      \
+    FUNCTION(prefix##7)      \
+    FUNCTION(prefix##8)      \
+    FUNCTION(prefix##9)
+#define FUNCTIONS_100(prefix) \
+    FUNCTIONS_10(prefix##0)   \
+    FUNCTIONS_10(prefix##1)   \
+    FUNCTIONS_10(prefix##2)   \
+    FUNCTIONS_10(prefix##3)   \
+    FUNCTIONS_10(prefix##4)   \
+    FUNCTIONS_10(prefix##5)   \
+    FUNCTIONS_10(prefix##6)   \
+    FUNCTIONS_10(prefix##7)   \
+    FUNCTIONS_10(prefix##8)   \
+    FUNCTIONS_10(prefix##9)
+#define FUNCTIONS_1000(prefix) \
+    FUNCTIONS_100(prefix##0)   \
+    FUNCTIONS_100(prefix##1)   \
+    FUNCTIONS_100(prefix##2)   \
+    FUNCTIONS_100(prefix##3)   \
+    FUNCTIONS_100(prefix##4)   \
+    FUNCTIONS_100(prefix##5)   \
+    FUNCTIONS_100(prefix##6)   \
+    FUNCTIONS_100(prefix##7)   \
+    FUNCTIONS_100(prefix##8)   \
+    FUNCTIONS_100(prefix##9)
+
+FUNCTIONS_1000(checks_)
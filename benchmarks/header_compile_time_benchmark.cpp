@@ -0,0 +1,80 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+#include <cstdlib>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// Measures the time it takes to compile a translation unit with a few assertions using kassert/core.hpp (no
+// iostreams) and using kassert/kassert.hpp (with the stream-based stringification), compared to the same translation
+// unit with plain checks. Each iteration invokes the compiler that was used to build this benchmark. The `many_*`
+// benchmarks compile 10000 decomposed assertions, with and without KASSERT_TYPE_ERASED_OPERANDS; with Clang, add
+// `-ftime-trace` to the flags to see where the time goes.
+
+namespace {
+/// @brief Compiles one of the translation units in `header_compile_time/`.
+/// @param state The benchmark state.
+/// @param source The file name of the translation unit.
+/// @param flags Compiler flags, e.g., `-fsyntax-only` to only measure the front end.
+void compile(benchmark::State& state, char const* source, char const* flags) {
+    std::string const command = std::string("\"" KASSERT_BENCHMARK_CXX_COMPILER "\" -std=c++17 ") + flags
+                                + " -DKASSERT_ASSERTION_LEVEL=30 -I\"" KASSERT_BENCHMARK_INCLUDE_DIR "\" \""
+                                + KASSERT_BENCHMARK_SOURCE_DIR "/" + source + "\"";
+
+    for (auto _: state) {
+        if (std::system(command.c_str()) != 0) {
+            state.SkipWithError("compilation failed");
+            break;
+        }
+    }
+}
+
+// Front end only, which is dominated by parsing the included headers
+BENCHMARK_CAPTURE(compile, parse_without_kassert, "baseline.cpp", "-fsyntax-only")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, parse_core_header, "core.cpp", "-fsyntax-only")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, parse_kassert_header, "kassert.cpp", "-fsyntax-only")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Optimized build of an object file, which is discarded
+BENCHMARK_CAPTURE(compile, o2_without_kassert, "baseline.cpp", "-O2 -c -o /dev/null")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, o2_core_header, "core.cpp", "-O2 -c -o /dev/null")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, o2_kassert_header, "kassert.cpp", "-O2 -c -o /dev/null")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// 10000 assertions, where the time is dominated by generating the code of the failure paths
+BENCHMARK_CAPTURE(
+    compile, many_without_kassert, "many_assertions.cpp", "-DASSERTIONS_WITHOUT_KASSERT -O2 -c -o /dev/null"
+)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, many_parse, "many_assertions.cpp", "-fsyntax-only")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(
+    compile, many_parse_type_erased, "many_assertions.cpp", "-DKASSERT_TYPE_ERASED_OPERANDS -fsyntax-only"
+)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(compile, many_o2, "many_assertions.cpp", "-O2 -c -o /dev/null")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(
+    compile, many_o2_type_erased, "many_assertions.cpp", "-DKASSERT_TYPE_ERASED_OPERANDS -O2 -c -o /dev/null"
+)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+} // namespace
+
+BENCHMARK_MAIN();
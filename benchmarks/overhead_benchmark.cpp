@@ -0,0 +1,237 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "kassert/kassert.hpp"
+
+// Measures the overhead of assertions in three typical loops: a sequential scan over a vector, a gather with index
+// bounds checks and pointer chasing through a linked list. Each loop is run without checks, with a raw `if` check
+// (the baseline that assertions should match), with KASSERT() (decomposed and non-decomposed expressions),
+// THROWING_KASSERT() and with a KASSERT() whose level is disabled at compile time.
+//
+// The benchmark is built once in assertion mode and once in exception mode for each optimization level. The compiler,
+// optimization level and mode are reported in the context of the benchmark output.
+
+namespace {
+/// @brief Assertion level that is disabled at compile time.
+constexpr int disabled_level = KASSERT_ASSERTION_LEVEL + 1;
+
+/// @brief Number of elements processed by each benchmark.
+constexpr std::int64_t problem_size = 1 << 16;
+
+/// @brief Aborts the program if the check failed. Used as baseline for the assertion macros.
+#define RAW_CHECK(expression) \
+    if (!(expression)) {      \
+        std::abort();         \
+    }
+
+// Sequential scan over a vector
+
+template <typename CheckT>
+void scan(benchmark::State& state, CheckT&& check) {
+    std::vector<std::int64_t> values(static_cast<std::size_t>(state.range(0)));
+    std::iota(values.begin(), values.end(), 0);
+    std::int64_t const limit = state.range(0);
+
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (std::int64_t const value: values) {
+            check(value, limit);
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_scan_unchecked(benchmark::State& state) {
+    scan(state, [](std::int64_t, std::int64_t) {});
+}
+BENCHMARK(BM_scan_unchecked)->Arg(problem_size);
+
+void BM_scan_raw(benchmark::State& state) {
+    scan(state, [](std::int64_t const value, std::int64_t) { RAW_CHECK(value >= 0); });
+}
+BENCHMARK(BM_scan_raw)->Arg(problem_size);
+
+void BM_scan_kassert(benchmark::State& state) {
+    scan(state, [](std::int64_t const value, std::int64_t) { KASSERT(value >= 0); });
+}
+BENCHMARK(BM_scan_kassert)->Arg(problem_size);
+
+void BM_scan_raw_conjunction(benchmark::State& state) {
+    scan(state, [](std::int64_t const value, std::int64_t const limit) { RAW_CHECK(value >= 0 && value < limit); });
+}
+BENCHMARK(BM_scan_raw_conjunction)->Arg(problem_size);
+
+void BM_scan_kassert_conjunction(benchmark::State& state) {
+    // expressions using && cannot be decomposed
+    scan(state, [](std::int64_t const value, std::int64_t const limit) { KASSERT(value >= 0 && value < limit); });
+}
+BENCHMARK(BM_scan_kassert_conjunction)->Arg(problem_size);
+
+void BM_scan_throwing_kassert(benchmark::State& state) {
+    scan(state, [](std::int64_t const value, std::int64_t) { THROWING_KASSERT(value >= 0); });
+}
+BENCHMARK(BM_scan_throwing_kassert)->Arg(problem_size);
+
+void BM_scan_kassert_disabled(benchmark::State& state) {
+    scan(state, [](std::int64_t const value, std::int64_t) { KASSERT(value >= 0, "", disabled_level); });
+}
+BENCHMARK(BM_scan_kassert_disabled)->Arg(problem_size);
+
+// Gather with index bounds checks
+
+template <typename CheckT>
+void gather(benchmark::State& state, CheckT&& check) {
+    std::size_t const         size = static_cast<std::size_t>(state.range(0));
+    std::vector<std::int64_t> values(size);
+    std::iota(values.begin(), values.end(), 0);
+    std::vector<std::size_t> indices(size);
+    std::iota(indices.begin(), indices.end(), std::size_t{0});
+    std::shuffle(indices.begin(), indices.end(), std::mt19937_64{42});
+
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (std::size_t const index: indices) {
+            check(index, values.size());
+            sum += values[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_gather_unchecked(benchmark::State& state) {
+    gather(state, [](std::size_t, std::size_t) {});
+}
+BENCHMARK(BM_gather_unchecked)->Arg(problem_size);
+
+void BM_gather_raw(benchmark::State& state) {
+    gather(state, [](std::size_t const index, std::size_t const size) { RAW_CHECK(index < size); });
+}
+BENCHMARK(BM_gather_raw)->Arg(problem_size);
+
+void BM_gather_kassert(benchmark::State& state) {
+    gather(state, [](std::size_t const index, std::size_t const size) { KASSERT(index < size); });
+}
+BENCHMARK(BM_gather_kassert)->Arg(problem_size);
+
+void BM_gather_throwing_kassert(benchmark::State& state) {
+    gather(state, [](std::size_t const index, std::size_t const size) { THROWING_KASSERT(index < size); });
+}
+BENCHMARK(BM_gather_throwing_kassert)->Arg(problem_size);
+
+void BM_gather_kassert_disabled(benchmark::State& state) {
+    gather(state, [](std::size_t const index, std::size_t const size) {
+        KASSERT(index < size, "", disabled_level);
+    });
+}
+BENCHMARK(BM_gather_kassert_disabled)->Arg(problem_size);
+
+// Pointer chasing through a linked list
+
+/// @brief Node of a linked list.
+struct Node {
+    Node*        next;  ///< @brief The next node.
+    std::int64_t value; ///< @brief The value of this node.
+};
+
+template <typename CheckT>
+void chase(benchmark::State& state, CheckT&& check) {
+    // link the nodes in random order to defeat the prefetcher
+    std::size_t const        size = static_cast<std::size_t>(state.range(0));
+    std::vector<Node>        nodes(size);
+    std::vector<std::size_t> order(size);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::shuffle(order.begin() + 1, order.end(), std::mt19937_64{42});
+    for (std::size_t i = 0; i < size; ++i) {
+        nodes[order[i]].next  = i + 1 < size ? &nodes[order[i + 1]] : nullptr;
+        nodes[order[i]].value = static_cast<std::int64_t>(i);
+    }
+
+    for (auto _: state) {
+        std::int64_t sum = 0;
+        for (Node const* node = &nodes[order.front()]; node != nullptr; node = node->next) {
+            check(node);
+            sum += node->value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_chase_unchecked(benchmark::State& state) {
+    chase(state, [](Node const*) {});
+}
+BENCHMARK(BM_chase_unchecked)->Arg(problem_size);
+
+void BM_chase_raw(benchmark::State& state) {
+    chase(state, [](Node const* node) { RAW_CHECK(node->value >= 0); });
+}
+BENCHMARK(BM_chase_raw)->Arg(problem_size);
+
+void BM_chase_kassert(benchmark::State& state) {
+    chase(state, [](Node const* node) { KASSERT(node->value >= 0); });
+}
+BENCHMARK(BM_chase_kassert)->Arg(problem_size);
+
+void BM_chase_throwing_kassert(benchmark::State& state) {
+    chase(state, [](Node const* node) { THROWING_KASSERT(node->value >= 0); });
+}
+BENCHMARK(BM_chase_throwing_kassert)->Arg(problem_size);
+
+void BM_chase_kassert_disabled(benchmark::State& state) {
+    chase(state, [](Node const* node) { KASSERT(node->value >= 0, "", disabled_level); });
+}
+BENCHMARK(BM_chase_kassert_disabled)->Arg(problem_size);
+
+/// @brief Returns the name and version of the compiler.
+/// @return The name and version of the compiler.
+std::string compiler() {
+#if defined(__clang__)
+    return "Clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "GCC " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    // report the configuration such that results of different builds can be told apart
+    benchmark::AddCustomContext("kassert_compiler", compiler());
+#ifdef KASSERT_BENCHMARK_OPTIMIZATION
+    benchmark::AddCustomContext("kassert_optimization", KASSERT_BENCHMARK_OPTIMIZATION);
+#endif
+#ifdef KASSERT_EXCEPTION_MODE
+    benchmark::AddCustomContext("kassert_mode", "exception");
+#else
+    benchmark::AddCustomContext("kassert_mode", "assertion");
+#endif
+    benchmark::AddCustomContext("kassert_assertion_level", std::to_string(KASSERT_ASSERTION_LEVEL));
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,112 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "kassert/range.hpp"
+#include "kassert/thread_range_executor.hpp"
+
+// Compares the range assertions of kassert/range.hpp with the equivalent KASSERT() on large vectors of integers, i.e.,
+// the success path of expensive checks. Each benchmark checks a vector of `state.range(0)` elements. The benchmarks
+// with a thread executor check the vector in parallel on all hardware threads.
+
+namespace {
+/// @brief Number of elements of the checked vectors.
+constexpr std::int64_t problem_size = 1 << 20;
+
+/// @brief Returns the vector `[0, 1, ..., size - 1]`.
+std::vector<std::int32_t> iota_vector(benchmark::State const& state) {
+    std::vector<std::int32_t> values(static_cast<std::size_t>(state.range(0)));
+    std::iota(values.begin(), values.end(), 0);
+    return values;
+}
+
+/// @brief Runs a check on each iteration and reports the number of checked elements.
+template <typename CheckT>
+void run(benchmark::State& state, CheckT&& check) {
+    for (auto _: state) {
+        check();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+// Element-wise equality
+
+void BM_equal_kassert(benchmark::State& state) {
+    std::vector<std::int32_t> const lhs = iota_vector(state);
+    std::vector<std::int32_t> const rhs = lhs;
+    run(state, [&] { KASSERT(lhs == rhs); });
+}
+BENCHMARK(BM_equal_kassert)->Arg(1 << 14)->Arg(problem_size);
+
+void BM_equal_kassert_range_eq(benchmark::State& state) {
+    std::vector<std::int32_t> const lhs = iota_vector(state);
+    std::vector<std::int32_t> const rhs = lhs;
+    run(state, [&] { KASSERT_RANGE_EQ(lhs, rhs); });
+}
+BENCHMARK(BM_equal_kassert_range_eq)->Arg(1 << 14)->Arg(problem_size);
+
+// Sortedness
+
+void BM_sorted_kassert(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    run(state, [&] { KASSERT(std::is_sorted(values.begin(), values.end())); });
+}
+BENCHMARK(BM_sorted_kassert)->Arg(1 << 14)->Arg(problem_size);
+
+void BM_sorted_kassert_sorted(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    run(state, [&] { KASSERT_SORTED(values); });
+}
+BENCHMARK(BM_sorted_kassert_sorted)->Arg(1 << 14)->Arg(problem_size);
+
+void BM_sorted_kassert_sorted_thread_executor(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    kassert::ThreadRangeExecutor    executor(std::thread::hardware_concurrency(), 0);
+    kassert::RangeExecutor* const   previous = kassert::set_range_executor(&executor);
+    run(state, [&] { KASSERT_SORTED(values); });
+    kassert::set_range_executor(previous);
+}
+BENCHMARK(BM_sorted_kassert_sorted_thread_executor)->Arg(1 << 14)->Arg(problem_size)->UseRealTime();
+
+// Predicate on all elements
+
+void BM_all_of_kassert(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    std::int32_t const              limit  = static_cast<std::int32_t>(state.range(0));
+    run(state, [&] {
+        KASSERT(std::all_of(values.begin(), values.end(), [&](std::int32_t const value) {
+            return value >= 0 && value < limit;
+        }));
+    });
+}
+BENCHMARK(BM_all_of_kassert)->Arg(1 << 14)->Arg(problem_size);
+
+void BM_all_of_kassert_all_of(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    std::int32_t const              limit  = static_cast<std::int32_t>(state.range(0));
+    run(state, [&] { KASSERT_ALL_OF(values, [&](std::int32_t const value) { return value >= 0 && value < limit; }); });
+}
+BENCHMARK(BM_all_of_kassert_all_of)->Arg(1 << 14)->Arg(problem_size);
+
+// Pairwise distinct elements
+
+void BM_unique_kassert_unique(benchmark::State& state) {
+    std::vector<std::int32_t> const values = iota_vector(state);
+    run(state, [&] { KASSERT_UNIQUE(values); });
+}
+BENCHMARK(BM_unique_kassert_unique)->Arg(1 << 14)->Arg(problem_size);
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,219 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Report sink that writes non-fatal reports from a background thread.
+///
+/// This header uses \c std::thread and is not included by \c kassert/kassert.hpp. Programs using it must link a
+/// threading library, e.g., the CMake target \c Threads::Threads.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "kassert/core.hpp"
+
+namespace kassert {
+/// @brief Report sink that decouples the threads reporting non-fatal assertions (e.g., KASSERT_WARN()) from writing
+/// the reports.
+///
+/// Non-fatal reports are copied into a bounded multi-producer ring buffer, which a background thread drains to a file
+/// descriptor. Submitting a report is lock-free: it claims a slot with a single compare-and-swap and never waits for
+/// the writer or for other reporting threads. If the ring buffer is full, the report is dropped and counted (see
+/// \c dropped()). Reports that are longer than \c KASSERT_LOGGER_BUFFER_SIZE are truncated.
+///
+/// Fatal reports are written synchronously by the reporting thread, after all reports that were completely submitted
+/// before have been written.
+///
+/// Install the sink using \c kassert::set_report_sink(). The sink uninstalls itself when it is destroyed.
+class AsyncReportSink final : public ReportSink {
+public:
+    /// @brief Default number of slots of the ring buffer.
+    static constexpr std::size_t default_capacity = 64;
+
+    /// @brief Constructs the sink and starts the background thread.
+    /// @param capacity Number of reports that can be pending, rounded up to the next power of two (at least two).
+    /// @param out File descriptor to which the reports are written.
+    explicit AsyncReportSink(
+        std::size_t const capacity = default_capacity, internal::FileDescriptor const out = internal::standard_error
+    )
+        : _capacity(round_up_to_power_of_two(capacity)),
+          _slots(new Slot[_capacity]),
+          _out(out) {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        _worker = std::thread([this] { run(); });
+    }
+
+    AsyncReportSink(AsyncReportSink const&)            = delete;
+    AsyncReportSink& operator=(AsyncReportSink const&) = delete;
+
+    /// @brief Uninstalls the sink if it is installed, stops the background thread and writes all pending reports.
+    ~AsyncReportSink() override {
+        ReportSink* expected = this;
+        internal::installed_report_sink.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+        _stop.store(true, std::memory_order_release);
+        _worker.join();
+        flush();
+    }
+
+    /// @brief Submits a report. Non-fatal reports are enqueued, fatal reports are written after all pending reports.
+    /// @param data The formatted report.
+    /// @param size The length of the report.
+    /// @param severity The severity of the report.
+    void write(char const* data, std::size_t const size, ReportSeverity const severity) override {
+        if (severity == ReportSeverity::fatal) {
+            lock_writer();
+            drain();
+            internal::write_to(_out, data, size);
+            unlock_writer();
+        } else {
+            enqueue(data, size);
+        }
+    }
+
+    /// @brief Writes all pending reports from the calling thread.
+    void flush() override {
+        lock_writer();
+        drain();
+        unlock_writer();
+    }
+
+    /// @brief Returns the number of reports that were dropped because the ring buffer was full.
+    /// @return The number of dropped reports.
+    [[nodiscard]] std::uint64_t dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the number of slots of the ring buffer.
+    /// @return The capacity.
+    [[nodiscard]] std::size_t capacity() const {
+        return _capacity;
+    }
+
+private:
+    /// @brief An entry of the ring buffer.
+    ///
+    /// The sequence number implements the bounded queue by D. Vyukov: a slot with sequence number \c s is free for the
+    /// producer of position \c s and contains the report of position \c p if \c s equals \c p+1.
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};                        ///< @brief Sequence number of the slot.
+        std::size_t                size = 0;                           ///< @brief Length of the report.
+        char                       data[KASSERT_LOGGER_BUFFER_SIZE]{}; ///< @brief The report.
+    };
+
+    /// @brief Poll interval of the background thread after the ring buffer was found empty for a while.
+    static constexpr std::chrono::microseconds max_poll_interval{1000};
+
+    /// @brief Rounds up to the next power of two. The sequence numbers of the slots require at least two slots.
+    /// @param value The value.
+    /// @return The smallest power of two that is not smaller than \c value and at least \c 2.
+    static std::size_t round_up_to_power_of_two(std::size_t const value) {
+        std::size_t power = 2;
+        while (power < value) {
+            power *= 2;
+        }
+        return power;
+    }
+
+    /// @brief Copies a report into the next free slot, or drops it if the ring buffer is full.
+    /// @param data The report.
+    /// @param size The length of the report.
+    void enqueue(char const* data, std::size_t const size) {
+        std::uint64_t position = _enqueue_position.load(std::memory_order_relaxed);
+        Slot*         slot     = nullptr;
+        while (true) {
+            slot                         = &_slots[position & (_capacity - 1)];
+            std::uint64_t const sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (sequence < position) {
+                // the slot still holds the report of the previous round, i.e., the ring buffer is full
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = _enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->size = std::min(size, sizeof(slot->data));
+        std::memcpy(slot->data, data, slot->size);
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /// @brief Writes all reports that were completely submitted. Requires the writer lock.
+    /// @return Whether some report was written.
+    bool drain() {
+        bool written = false;
+        while (true) {
+            Slot& slot = _slots[_dequeue_position & (_capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != _dequeue_position + 1) {
+                return written;
+            }
+            internal::write_to(_out, slot.data, slot.size);
+            slot.sequence.store(_dequeue_position + _capacity, std::memory_order_release);
+            ++_dequeue_position;
+            written = true;
+        }
+    }
+
+    /// @brief Acquires the writer lock, which serializes the background thread and fatal reports. Reporting threads
+    /// never take this lock for non-fatal reports.
+    void lock_writer() {
+        while (_writer_lock.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @brief Releases the writer lock.
+    void unlock_writer() {
+        _writer_lock.clear(std::memory_order_release);
+    }
+
+    /// @brief Main loop of the background thread: drains the ring buffer and backs off exponentially up to
+    /// \c max_poll_interval while it is empty.
+    void run() {
+        std::chrono::microseconds poll_interval{1};
+        while (!_stop.load(std::memory_order_acquire)) {
+            lock_writer();
+            bool const written = drain();
+            unlock_writer();
+            if (written) {
+                poll_interval = std::chrono::microseconds{1};
+            } else {
+                std::this_thread::sleep_for(poll_interval);
+                poll_interval = std::min(2 * poll_interval, max_poll_interval);
+            }
+        }
+    }
+
+    std::size_t              _capacity; ///< @brief Number of slots, a power of two.
+    std::unique_ptr<Slot[]>  _slots;    ///< @brief The ring buffer.
+    internal::FileDescriptor _out;      ///< @brief Destination of the reports.
+
+    /// @brief Next position to be claimed by a producer. Kept apart from the consumer state to avoid false sharing.
+    alignas(64) std::atomic<std::uint64_t> _enqueue_position{0};
+    /// @brief Number of dropped reports.
+    std::atomic<std::uint64_t> _dropped{0};
+
+    /// @brief Next position to be written by the consumer.
+    alignas(64) std::uint64_t _dequeue_position = 0;
+    /// @brief Serializes the background thread and fatal reports.
+    std::atomic_flag _writer_lock = ATOMIC_FLAG_INIT;
+    /// @brief Whether the background thread should stop.
+    std::atomic<bool> _stop{false};
+    /// @brief The background thread.
+    std::thread _worker;
+};
+} // namespace kassert
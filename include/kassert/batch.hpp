@@ -0,0 +1,196 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Batches of assertions whose failures are reported once at the end of the scope.
+///
+/// A KASSERT() per element of a loop adds a branch per element to the loop, which usually prevents the compiler from
+/// vectorizing it. An assertion batch instead only counts its failures and keeps the smallest failing index with
+/// branchless updates, and reports the failed assertion once the batch goes out of scope:
+///
+/// ```
+/// KASSERT_BATCH(nonnegative, i, values[i] >= 0, "negative value", kassert::assert::heavy);
+/// for (std::size_t i = 0; i < values.size(); ++i) {
+///     nonnegative.check(i);
+///     sum += values[i];
+/// }
+/// // reported here if some value is negative
+/// ```
+///
+/// The report is formatted like the report of KASSERT(): the expression is evaluated once more for the smallest
+/// failing index to print its decomposed operands, followed by the index and the number of failures. Thus, the
+/// operands of the failing element must not change until the end of the scope.
+///
+/// This header is not included by \c kassert/kassert.hpp.
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+#include "kassert/kassert.hpp"
+
+/// @brief Declares an assertion batch. Accepts between three and five parameters.
+/// @ingroup assertion
+///
+/// Declares a variable `name` whose member `check(index)` evaluates the assertion expression for an index of type
+/// \c std::size_t. The checks do not branch on their result; instead, the failures are reported once `name` goes out
+/// of scope. If the assertion level is disabled, `check()` does not generate any code. If \c
+/// KASSERT_RUNTIME_ASSERTION_LEVEL is defined, the runtime assertion level is checked once when the batch is declared.
+///
+/// The macro accepts 3 to 5 parameters:
+/// 1. The name of the batch variable (mandatory).
+/// 2. The name of the index in the expression (mandatory).
+/// 3. The assertion expression, which depends on the index (mandatory).
+/// 4. Error message that is printed in addition to the decomposed expression (optional).
+/// 5. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_BATCH(name, index, ...)            \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3(           \
+        ,                                          \
+        __VA_ARGS__,                               \
+        KASSERT_BATCH_3(name, index, __VA_ARGS__), \
+        KASSERT_BATCH_2(name, index, __VA_ARGS__), \
+        KASSERT_BATCH_1(name, index, __VA_ARGS__), \
+        ignore                                     \
+    )
+
+/// @cond IMPLEMENTATION
+
+// Implementation of KASSERT_BATCH(). The call site metadata has to outlive the batch, i.e., it is declared before the
+// batch in the same scope. The expression is wrapped in a lambda that takes the index, such that the batch can evaluate
+// it once more on the failure path to obtain the decomposed operands.
+#define KASSERT_KASSERT_HPP_KASSERT_BATCH_IMPL(type, name, index, expression, message, level)                \
+    KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(name##_kassert_site, type, #expression)                        \
+    auto name = kassert::internal::make_assertion_batch<kassert::internal::assertion_enabled(level)>(        \
+        &name##_kassert_site,                                                                                \
+        kassert::internal::assertion_enabled(level) && KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level), \
+        [&](std::size_t const index) {                                                                       \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                              \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                                \
+            return kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression);          \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                               \
+        },                                                                                                   \
+        KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level)                                                   \
+    )
+
+// KASSERT_BATCH() chooses the right implementation depending on its number of arguments.
+#define KASSERT_BATCH_3(name, index, expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_BATCH_IMPL("ASSERTION", name, index, expression, message, level)
+#define KASSERT_BATCH_2(name, index, expression, message) \
+    KASSERT_BATCH_3(name, index, expression, message, kassert::assert::normal)
+#define KASSERT_BATCH_1(name, index, expression) KASSERT_BATCH_2(name, index, expression, "")
+
+/// @endcond
+
+namespace kassert::internal {
+/// @brief Failure path of an assertion batch: evaluates the assertion once more for the smallest failing index, prints
+/// an error describing the failed assertion, the index and the number of failures, followed by the user message, and
+/// aborts the program. This function is cold and never inlined.
+/// @tparam CheckT Callable that evaluates the decomposed assertion expression for an index.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site.
+/// @param check Callable that evaluates the assertion expression.
+/// @param first_failure Smallest failing index.
+/// @param failures Number of failed checks.
+/// @param message Callable that writes the user message.
+template <typename CheckT, typename MessageT>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void fail_assertion_batch(
+    AssertionSite const* site,
+    CheckT const&        check,
+    std::size_t const    first_failure,
+    std::size_t const    failures,
+    MessageT const&      message
+) {
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, site->type, check(first_failure), site->location, site->expression);
+    logger << "first failure at index " << first_failure << " (" << failures << " failed check(s) in total)\n";
+    message(logger);
+    finish_failed_assertion(logger);
+}
+
+/// @brief A batch of checks of the same assertion for different indices, declared by KASSERT_BATCH(). The checks
+/// accumulate their failures without branching, which are reported when the batch is destroyed.
+/// @tparam enabled Whether the assertion level of the batch is enabled at compile time.
+/// @tparam CheckT Callable that evaluates the decomposed assertion expression for an index.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+template <bool enabled, typename CheckT, typename MessageT>
+class AssertionBatch {
+public:
+    /// @brief Constructs an empty batch.
+    /// @param site Static metadata of the assertion call site, which must outlive the batch.
+    /// @param runtime_enabled Whether the assertion is enabled at runtime.
+    /// @param check Callable that evaluates the assertion expression.
+    /// @param message Callable that writes the user message.
+    AssertionBatch(AssertionSite const* site, bool const runtime_enabled, CheckT check, MessageT message)
+        : _site(site),
+          _runtime_enabled(runtime_enabled),
+          _check(std::move(check)),
+          _message(std::move(message)) {}
+
+    /// @brief Each batch reports its failures once.
+    AssertionBatch(AssertionBatch const&) = delete;
+
+    /// @brief Each batch reports its failures once.
+    /// @return This batch.
+    AssertionBatch& operator=(AssertionBatch const&) = delete;
+
+    /// @brief Reports the failed checks, if any, and aborts the program. May throw if the installed failure handler
+    /// throws (see \c kassert::testing::ThrowOnFailure).
+    ~AssertionBatch() noexcept(false) {
+        if constexpr (enabled) {
+            if (KASSERT_KASSERT_HPP_UNLIKELY(_failures != 0)) {
+                fail_assertion_batch(_site, _check, _first_failure, _failures, _message);
+            }
+        }
+    }
+
+    /// @brief Evaluates the assertion for an index and records a failure without branching on the result.
+    /// @param index The index.
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE void check(std::size_t const index) {
+        if constexpr (enabled) {
+            if (_runtime_enabled) {
+                bool const failed = !expression_result(_check(index));
+                _failures += static_cast<std::size_t>(failed);
+                // the index if the check failed and all ones otherwise, such that the compiler recognizes a
+                // minimum reduction (unlike for a conditional expression)
+                std::size_t const candidate = index | (static_cast<std::size_t>(failed) - 1);
+                _first_failure              = candidate < _first_failure ? candidate : _first_failure;
+            }
+        }
+    }
+
+    /// @brief Returns the number of failed checks so far.
+    /// @return The number of failed checks.
+    [[nodiscard]] std::size_t failures() const {
+        return _failures;
+    }
+
+private:
+    /// @brief Smallest failing index if no check failed.
+    static constexpr std::size_t no_failure = std::numeric_limits<std::size_t>::max();
+
+    AssertionSite const* _site;                       ///< @brief Static metadata of the assertion call site.
+    bool                 _runtime_enabled;            ///< @brief Whether the assertion is enabled at runtime.
+    std::size_t          _failures      = 0;          ///< @brief Number of failed checks.
+    std::size_t          _first_failure = no_failure; ///< @brief Smallest failing index.
+    CheckT               _check;                      ///< @brief Evaluates the assertion expression.
+    MessageT             _message;                    ///< @brief Writes the user message.
+};
+
+/// @brief Constructs an assertion batch (see KASSERT_BATCH()).
+/// @tparam enabled Whether the assertion level of the batch is enabled at compile time.
+/// @tparam CheckT Callable that evaluates the decomposed assertion expression for an index.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site, which must outlive the batch.
+/// @param runtime_enabled Whether the assertion is enabled at runtime.
+/// @param check Callable that evaluates the assertion expression.
+/// @param message Callable that writes the user message.
+/// @return The empty batch.
+template <bool enabled, typename CheckT, typename MessageT>
+AssertionBatch<enabled, CheckT, MessageT>
+make_assertion_batch(AssertionSite const* site, bool const runtime_enabled, CheckT check, MessageT message) {
+    return AssertionBatch<enabled, CheckT, MessageT>(site, runtime_enabled, std::move(check), std::move(message));
+}
+} // namespace kassert::internal
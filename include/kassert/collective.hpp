@@ -0,0 +1,498 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Collective assertions for MPI programs.
+///
+/// If an assertion fails on a single MPI rank and the rank aborts, the other ranks block in their next collective
+/// operation until the job is killed. KASSERT_COLLECTIVE() instead only records local failures in a
+/// \c kassert::CollectiveChecker. At an explicit synchronization point, all ranks agree on the failed checks with a
+/// single \c MPI_Allreduce over a bitmask covering all checks since the last synchronization point, i.e., \c N checks
+/// cost one reduction instead of \c N. The reduction can also be piggybacked on a reduction that the application
+/// performs anyway. If any check failed, the error messages of the failing ranks are reported by rank 0 and the job
+/// is stopped by all ranks.
+///
+/// This header requires MPI and is not included by \c kassert/kassert.hpp. Link the CMake target
+/// \c kassert::collective to use it.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "kassert/kassert.hpp"
+
+/// @brief Collective assertion macro. Accepts between two and four parameters.
+/// @ingroup assertion
+///
+/// Evaluates the assertion like KASSERT(), but does not abort the program if it fails. Instead, the decomposed
+/// expression and the error message are recorded in the given \c kassert::CollectiveChecker, which reports them once
+/// all ranks reach the next synchronization point (see \c kassert::CollectiveChecker::sync()).
+///
+/// Checks are identified by the order in which they are evaluated since the last synchronization point. Thus, all
+/// ranks must evaluate the same number of collective checks between two synchronization points, which is the case if
+/// the checks are not placed in rank-dependent control flow. Since the assertion level decides at compile time whether
+/// a check is evaluated, all ranks must also use the same (runtime) assertion level.
+///
+/// The macro accepts 2 to 4 parameters:
+/// 1. The \c kassert::CollectiveChecker that records failures (mandatory).
+/// 2. The assertion expression (mandatory).
+/// 3. Error message that is reported in addition to the decomposed expression (optional).
+/// 4. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_COLLECTIVE(checker, ...)                 \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3(                 \
+        ,                                                \
+        __VA_ARGS__,                                     \
+        KASSERT_COLLECTIVE_3(checker, __VA_ARGS__),      \
+        KASSERT_COLLECTIVE_2(checker, __VA_ARGS__),      \
+        KASSERT_COLLECTIVE_1(checker, __VA_ARGS__),      \
+        ignore                                           \
+    )
+
+/// @cond IMPLEMENTATION
+
+// Implementation of KASSERT_COLLECTIVE(): same as KASSERT(), but the cold failure path records the failure in the
+// checker instead of aborting. Each evaluated check consumes one bit of the checker's failure bitmask.
+#define KASSERT_KASSERT_HPP_KASSERT_COLLECTIVE_IMPL(checker, expression, message, level)                  \
+    do {                                                                                                  \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                                      \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                                   \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                       \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                         \
+                kassert::internal::evaluate_collective_assertion(                                         \
+                    checker,                                                                              \
+                    KASSERT_KASSERT_HPP_SOURCE_LOCATION,                                                  \
+                    #expression,                                                                          \
+                    kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression),      \
+                    [&](kassert::internal::StringLogger& kassert_logger) { kassert_logger << message; }   \
+                );                                                                                        \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                        \
+            }                                                                                             \
+        }                                                                                                 \
+    } while (false)
+
+// KASSERT_COLLECTIVE() chooses the right implementation depending on its number of arguments.
+#define KASSERT_COLLECTIVE_3(checker, expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_COLLECTIVE_IMPL(checker, expression, message, level)
+#define KASSERT_COLLECTIVE_2(checker, expression, message) \
+    KASSERT_COLLECTIVE_3(checker, expression, message, kassert::assert::normal)
+#define KASSERT_COLLECTIVE_1(checker, expression) KASSERT_COLLECTIVE_2(checker, expression, "")
+
+/// @endcond
+
+namespace kassert {
+/// @brief Error message of the failed collective checks of one rank.
+struct CollectiveFailureReport {
+    /// @brief The rank on which the checks failed.
+    int rank;
+    /// @brief The error messages of all checks that failed on this rank.
+    std::string message;
+};
+
+/// @brief Records the failures of collective assertions (see KASSERT_COLLECTIVE()) of one communicator and lets all
+/// ranks of the communicator agree on them.
+///
+/// The checker keeps one bit per check evaluated since the last synchronization point. The bitmask has a fixed
+/// capacity that must be the same on all ranks; checks beyond the capacity share the last bit. Agreeing on the failed
+/// checks costs a single \c MPI_Allreduce over the bitmask. Only if some check failed, the error messages are gathered
+/// on rank 0.
+class CollectiveChecker {
+public:
+    /// @brief Default number of checks that are distinguished between two synchronization points.
+    static constexpr std::size_t default_capacity = 256;
+
+    /// @brief Constructs a checker for a communicator.
+    /// @param comm The communicator. All of its ranks must call the same synchronization functions.
+    /// @param capacity Number of checks that are distinguished between two synchronization points. Must be the same on
+    /// all ranks.
+    explicit CollectiveChecker(MPI_Comm comm = MPI_COMM_WORLD, std::size_t capacity = default_capacity)
+        : _comm(comm),
+          _capacity(capacity > 0 ? capacity : 1),
+          _local_failures((_capacity + bits_per_word - 1) / bits_per_word, 0),
+          _global_failures(_local_failures.size(), 0) {}
+
+    CollectiveChecker(CollectiveChecker const&)            = delete;
+    CollectiveChecker& operator=(CollectiveChecker const&) = delete;
+
+    /// @brief Destroys the checker. Failures that were not agreed upon are written to \c stderr by the local rank,
+    /// such that they are not lost silently.
+    ~CollectiveChecker() {
+        if (!_local_report.empty()) {
+            std::string const message =
+                "KASSERT_COLLECTIVE: failed checks were never synchronized:\n" + _local_report;
+            internal::submit_report(
+                internal::standard_error,
+                message.data(),
+                message.size(),
+                ReportSeverity::warning
+            );
+        }
+    }
+
+    /// @brief Returns the communicator of this checker.
+    /// @return The communicator.
+    [[nodiscard]] MPI_Comm communicator() const {
+        return _comm;
+    }
+
+    /// @brief Returns the number of checks evaluated on this rank since the last synchronization point.
+    /// @return The number of pending checks.
+    [[nodiscard]] std::size_t pending_checks() const {
+        return _pending_checks;
+    }
+
+    /// @brief Returns whether some check failed on this rank since the last synchronization point.
+    /// @return Whether some local check failed.
+    [[nodiscard]] bool has_local_failures() const {
+        return !_local_report.empty();
+    }
+
+    /// @brief Lets all ranks agree on the failed checks. Must be called by all ranks of the communicator.
+    ///
+    /// Performs a single \c MPI_Allreduce over the failure bitmask. If some check failed on any rank, the error
+    /// messages of the failing ranks are additionally gathered on rank 0 (see \c reports()). Afterwards, the next
+    /// synchronization period starts.
+    /// @return Whether all checks passed on all ranks.
+    bool agree() {
+        std::vector<std::uint64_t> global_failures(_local_failures.size());
+        MPI_Allreduce(
+            _local_failures.data(),
+            global_failures.data(),
+            static_cast<int>(_local_failures.size()),
+            MPI_UINT64_T,
+            MPI_BOR,
+            _comm
+        );
+        return finish_agreement(global_failures.data());
+    }
+
+    /// @brief Performs an \c MPI_Allreduce on behalf of the application and piggybacks the agreement on the failed
+    /// checks (see \c agree()) on it, i.e., both are done in a single reduction. Must be called by all ranks of the
+    /// communicator.
+    ///
+    /// The arguments are the same as for \c MPI_Allreduce (\c MPI_IN_PLACE is supported). If the datatype is not
+    /// contiguous, the reductions are performed one after another.
+    /// @param sendbuf Send buffer or \c MPI_IN_PLACE.
+    /// @param recvbuf Receive buffer.
+    /// @param count Number of elements.
+    /// @param datatype Datatype of the elements.
+    /// @param op Reduction operation.
+    /// @return Whether all checks passed on all ranks.
+    bool agree(void const* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op);
+
+    /// @brief Lets all ranks agree on the failed checks (see \c agree()). If some check failed on any rank, rank 0
+    /// reports the error messages of all failing ranks and the job is stopped with \c MPI_Abort(). Must be called by
+    /// all ranks of the communicator.
+    void sync() {
+        if (!agree()) {
+            abort_job();
+        }
+    }
+
+    /// @brief Performs an \c MPI_Allreduce on behalf of the application and piggybacks \c sync() on it. The arguments
+    /// are the same as for \c MPI_Allreduce.
+    /// @param sendbuf Send buffer or \c MPI_IN_PLACE.
+    /// @param recvbuf Receive buffer.
+    /// @param count Number of elements.
+    /// @param datatype Datatype of the elements.
+    /// @param op Reduction operation.
+    void sync(void const* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op) {
+        if (!agree(sendbuf, recvbuf, count, datatype, op)) {
+            abort_job();
+        }
+    }
+
+    /// @brief Returns whether a check failed on any rank in the last agreement.
+    /// @param check Index of the check in the order of evaluation during the last synchronization period.
+    /// @return Whether the check failed on some rank.
+    [[nodiscard]] bool failed(std::size_t check) const {
+        std::size_t const bit = check < _capacity ? check : _capacity - 1;
+        return (_global_failures[bit / bits_per_word] >> (bit % bits_per_word)) & 1u;
+    }
+
+    /// @brief Returns the error messages of the failing ranks of the last agreement. Only available on rank 0, empty
+    /// on all other ranks.
+    /// @return One report per failing rank, ordered by rank.
+    [[nodiscard]] std::vector<CollectiveFailureReport> const& reports() const {
+        return _reports;
+    }
+
+    /// @brief Returns the index of the next check and advances the check counter. Used by KASSERT_COLLECTIVE().
+    /// @return Index of the next check.
+    std::size_t next_check() {
+        return _pending_checks++;
+    }
+
+    /// @brief Records a failed check on this rank. Used by KASSERT_COLLECTIVE().
+    /// @param check Index of the check (see \c next_check()).
+    /// @param message Error message of the check.
+    void record_failure(std::size_t check, std::string const& message) {
+        std::size_t const bit = check < _capacity ? check : _capacity - 1;
+        _local_failures[bit / bits_per_word] |= std::uint64_t{1} << (bit % bits_per_word);
+        _local_report += message;
+    }
+
+private:
+    /// @brief Number of checks per word of the bitmask.
+    static constexpr std::size_t bits_per_word = 64;
+
+    /// @brief Stores the agreed upon failures, gathers the error messages on rank 0 if some check failed and starts
+    /// the next synchronization period.
+    /// @param global_failures The reduced failure bitmask.
+    /// @return Whether all checks passed on all ranks.
+    bool finish_agreement(std::uint64_t const* global_failures) {
+        bool any_failure = false;
+        for (std::size_t i = 0; i < _global_failures.size(); ++i) {
+            _global_failures[i] = global_failures[i];
+            any_failure |= global_failures[i] != 0;
+        }
+
+        _reports.clear();
+        if (any_failure) {
+            gather_reports();
+        }
+
+        std::fill(_local_failures.begin(), _local_failures.end(), 0);
+        _local_report.clear();
+        _pending_checks = 0;
+        return !any_failure;
+    }
+
+    /// @brief Gathers the error messages of all failing ranks on rank 0.
+    void gather_reports() {
+        int rank = 0;
+        int size = 0;
+        MPI_Comm_rank(_comm, &rank);
+        MPI_Comm_size(_comm, &size);
+
+        int const        length = static_cast<int>(_local_report.size());
+        std::vector<int> lengths(rank == 0 ? static_cast<std::size_t>(size) : 0);
+        MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, _comm);
+
+        std::vector<int> displacements(lengths.size());
+        int              total_length = 0;
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            displacements[i] = total_length;
+            total_length += lengths[i];
+        }
+
+        std::string messages(static_cast<std::size_t>(total_length), '\0');
+        MPI_Gatherv(
+            _local_report.data(),
+            length,
+            MPI_CHAR,
+            messages.data(),
+            lengths.data(),
+            displacements.data(),
+            MPI_CHAR,
+            0,
+            _comm
+        );
+
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            if (lengths[i] > 0) {
+                _reports.push_back(CollectiveFailureReport{
+                    static_cast<int>(i),
+                    messages.substr(static_cast<std::size_t>(displacements[i]), static_cast<std::size_t>(lengths[i]))});
+            }
+        }
+    }
+
+    /// @brief Reports the error messages on rank 0 and stops the job. Called by all ranks after a failed agreement.
+    [[noreturn]] void abort_job() {
+        std::string message;
+        for (auto const& report: _reports) {
+            message += "[rank " + std::to_string(report.rank) + "] " + report.message;
+        }
+        if (!message.empty()) {
+            message =
+                "KASSERT_COLLECTIVE: checks failed on " + std::to_string(_reports.size()) + " rank(s)\n" + message;
+            internal::submit_report(internal::standard_error, message.data(), message.size(), ReportSeverity::fatal);
+        }
+        flush_reports();
+
+        // make sure that rank 0 has written the report before the job is killed
+        MPI_Barrier(_comm);
+        MPI_Abort(_comm, EXIT_FAILURE);
+        std::abort();
+    }
+
+    MPI_Comm                             _comm;               ///< @brief The communicator.
+    std::size_t                          _capacity;           ///< @brief Number of distinguished checks.
+    std::size_t                          _pending_checks = 0; ///< @brief Checks since the last agreement.
+    std::vector<std::uint64_t>           _local_failures;     ///< @brief Local failure bitmask.
+    std::vector<std::uint64_t>           _global_failures;    ///< @brief Failure bitmask of the last agreement.
+    std::string                          _local_report;       ///< @brief Local error messages.
+    std::vector<CollectiveFailureReport> _reports;            ///< @brief Reports of the last agreement (rank 0).
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Layout of the buffer of a reduction with a piggybacked failure bitmask, which is attached to the datatype
+/// of the reduction.
+struct PiggybackedReduction {
+    /// @brief Datatype of the application data.
+    MPI_Datatype datatype;
+    /// @brief Reduction operation of the application data.
+    MPI_Op op;
+    /// @brief Number of elements of the application data.
+    int count;
+    /// @brief Offset of the failure bitmask in the buffer.
+    std::size_t mask_offset;
+    /// @brief Number of words of the failure bitmask.
+    std::size_t mask_words;
+    /// @brief Total size of the buffer.
+    std::size_t size;
+};
+
+/// @brief Returns the attribute key that attaches the buffer layout to the datatype of a piggybacked reduction.
+/// @return The attribute key.
+inline int piggybacked_reduction_keyval() {
+    static int const keyval = [] {
+        int key = MPI_KEYVAL_INVALID;
+        MPI_Type_create_keyval(MPI_TYPE_NULL_COPY_FN, MPI_TYPE_NULL_DELETE_FN, &key, nullptr);
+        return key;
+    }();
+    return keyval;
+}
+
+/// @brief Reduction operation of a piggybacked reduction: reduces the application data with the application's
+/// operation and the failure bitmasks with bitwise or.
+/// @param in Input buffers.
+/// @param inout Input and output buffers.
+/// @param len Number of buffers.
+/// @param datatype Datatype of the buffers, which carries the buffer layout as attribute.
+inline void reduce_piggybacked(void* in, void* inout, int* len, MPI_Datatype* datatype) {
+    void* attribute = nullptr;
+    int   found     = 0;
+    MPI_Type_get_attr(*datatype, piggybacked_reduction_keyval(), &attribute, &found);
+    auto const& layout = *static_cast<PiggybackedReduction const*>(attribute);
+
+    for (int i = 0; i < *len; ++i) {
+        char* const lhs = static_cast<char*>(in) + static_cast<std::size_t>(i) * layout.size;
+        char* const rhs = static_cast<char*>(inout) + static_cast<std::size_t>(i) * layout.size;
+        MPI_Reduce_local(lhs, rhs, layout.count, layout.datatype, layout.op);
+        for (std::size_t word = 0; word < layout.mask_words; ++word) {
+            std::uint64_t lhs_word = 0;
+            std::uint64_t rhs_word = 0;
+            std::memcpy(&lhs_word, lhs + layout.mask_offset + word * sizeof(std::uint64_t), sizeof(std::uint64_t));
+            std::memcpy(&rhs_word, rhs + layout.mask_offset + word * sizeof(std::uint64_t), sizeof(std::uint64_t));
+            rhs_word |= lhs_word;
+            std::memcpy(rhs + layout.mask_offset + word * sizeof(std::uint64_t), &rhs_word, sizeof(std::uint64_t));
+        }
+    }
+}
+
+/// @brief Failure path of KASSERT_COLLECTIVE(): formats the error message and records it in the checker. This
+/// function is cold and never inlined to keep the code at the call site small.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c StringLogger.
+/// @param checker The checker that records the failure.
+/// @param check Index of the check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void fail_collective_assertion(
+    CollectiveChecker&   checker,
+    std::size_t const    check,
+    SourceLocation const where,
+    char const*          expr_str,
+    ExprT const          expr,
+    MessageT const       message
+) {
+    StringLogger logger;
+    print_failed_assertion(logger, "COLLECTIVE ASSERTION", expr, where, expr_str);
+    message(logger);
+    logger << "\n";
+    checker.record_failure(check, logger.str());
+}
+
+/// @brief Evaluates a collective assertion. If the assertion fails, calls the cold failure path
+/// \c fail_collective_assertion(). Since this function is always inlined, the inline part of a collective assertion
+/// is the comparison, a branch and the increment of the check counter.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c StringLogger.
+/// @param checker The checker that records failures.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr Assertion expression to be checked.
+/// @param message Callable that writes the user message. Only called if the assertion failed.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline void evaluate_collective_assertion(
+    CollectiveChecker&   checker,
+    SourceLocation const where,
+    char const*          expr_str,
+    ExprT const          expr,
+    MessageT const       message
+) {
+    std::size_t const check = checker.next_check();
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        fail_collective_assertion(checker, check, where, expr_str, expr, message);
+    }
+}
+} // namespace kassert::internal
+
+namespace kassert {
+inline bool
+CollectiveChecker::agree(void const* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op) {
+    int      type_size   = 0;
+    MPI_Aint lower_bound = 0;
+    MPI_Aint extent      = 0;
+    MPI_Type_size(datatype, &type_size);
+    MPI_Type_get_extent(datatype, &lower_bound, &extent);
+    if (lower_bound != 0 || extent != type_size) {
+        MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, _comm);
+        return agree();
+    }
+
+    // buffer layout: application data, followed by the (aligned) failure bitmask
+    constexpr std::size_t          word_size = sizeof(std::uint64_t);
+    std::size_t const              data_size = static_cast<std::size_t>(type_size) * static_cast<std::size_t>(count);
+    std::size_t const              mask_word = (data_size + word_size - 1) / word_size;
+    internal::PiggybackedReduction layout{};
+    layout.datatype    = datatype;
+    layout.op          = op;
+    layout.count       = count;
+    layout.mask_offset = mask_word * word_size;
+    layout.mask_words  = _local_failures.size();
+    layout.size        = layout.mask_offset + layout.mask_words * word_size;
+
+    std::vector<std::uint64_t> send_buffer(mask_word + layout.mask_words);
+    std::vector<std::uint64_t> recv_buffer(send_buffer.size());
+    std::memcpy(send_buffer.data(), sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf, data_size);
+    std::copy(
+        _local_failures.begin(),
+        _local_failures.end(),
+        send_buffer.begin() + static_cast<std::ptrdiff_t>(mask_word)
+    );
+
+    // a single element of a contiguous datatype, such that the buffer is never split by the MPI implementation
+    MPI_Datatype buffer_type = MPI_DATATYPE_NULL;
+    MPI_Type_contiguous(static_cast<int>(layout.size), MPI_BYTE, &buffer_type);
+    MPI_Type_commit(&buffer_type);
+    MPI_Type_set_attr(buffer_type, internal::piggybacked_reduction_keyval(), &layout);
+
+    int commute = 0;
+    MPI_Op_commutative(op, &commute);
+    MPI_Op buffer_op = MPI_OP_NULL;
+    MPI_Op_create(&internal::reduce_piggybacked, commute, &buffer_op);
+
+    MPI_Allreduce(send_buffer.data(), recv_buffer.data(), 1, buffer_type, buffer_op, _comm);
+
+    MPI_Op_free(&buffer_op);
+    MPI_Type_free(&buffer_type);
+
+    std::memcpy(recvbuf, recv_buffer.data(), data_size);
+    return finish_agreement(recv_buffer.data() + mask_word);
+}
+} // namespace kassert
@@ -0,0 +1,946 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Macros for asserting runtime checks without depending on iostreams.
+///
+/// This header provides all assertion macros, but does not include `<iostream>`, `<sstream>`, `<vector>` or `<string>`.
+/// Failed assertions format their error messages with \c kassert::internal::FdLogger, which handles built-in types and
+/// strings natively. Other operands of decomposed expressions are printed as `<?>` unless the \c << operator of
+/// \c kassert::Logger is overloaded for them.
+///
+/// Include \c kassert/exception.hpp to use THROWING_KASSERT() and THROWING_KASSERT_SPECIFIED(), and
+/// \c kassert/stream.hpp to stringify STL containers and types that can only be written to a \c std::ostream. The
+/// umbrella header \c kassert/kassert.hpp includes both.
+
+#pragma once
+
+#include <cstdlib>
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+    #include <atomic>
+    #include <charconv>
+    #include <cstring>
+#endif
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "kassert/internal/assertion_macros.hpp"
+#include "kassert/internal/assertion_site.hpp"
+#include "kassert/internal/category.hpp"
+#include "kassert/internal/cost_budget.hpp"
+#include "kassert/internal/expression_decomposition.hpp"
+#include "kassert/internal/failure_handler.hpp"
+#include "kassert/internal/logger.hpp"
+#include "kassert/internal/rate_limiting.hpp"
+#include "kassert/internal/runtime_library.hpp"
+#include "kassert/internal/sampling.hpp"
+#include "kassert/internal/source_location.hpp"
+#ifdef KASSERT_INSTRUMENTATION
+    #include "kassert/internal/instrumentation.hpp"
+#endif
+
+/// @brief Assertion levels
+namespace kassert::assert {
+/// @addtogroup assertion-levels Assertion levels
+/// @{
+
+/// @brief Assertion level for exceptions if exception mode is disabled.
+#define KASSERT_ASSERTION_LEVEL_KTHROW 10
+
+/// @brief Assertion level for exceptions if exception mode is disabled.
+constexpr int kthrow = KASSERT_ASSERTION_LEVEL_KTHROW;
+
+/// @brief Default assertion level. This level is used if no assertion level is specified.
+#define KASSERT_ASSERTION_LEVEL_NORMAL 30
+
+/// @brief Default assertion level. This level is used if no assertion level is specified.
+constexpr int normal = KASSERT_ASSERTION_LEVEL_NORMAL;
+
+/// @brief Runtime assertion level that does not disable any assertion, i.e., all assertions that are enabled at
+/// compile time are checked. This is the initial runtime assertion level (see \c kassert::set_assertion_level()).
+constexpr int unlimited = std::numeric_limits<int>::max();
+
+/// @}
+} // namespace kassert::assert
+
+#ifndef KASSERT_ASSERTION_LEVEL
+    #warning "Assertion level was not set explicitly; using default assertion level."
+  /// @brief Default assertion level to `kassert::assert::normal` if not set explicitly.
+    #define KASSERT_ASSERTION_LEVEL KASSERT_ASSERTION_LEVEL_NORMAL
+#endif
+
+/// @brief Assertion macro. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// Assertions are enabled or disabled by setting a compile-time assertion level (`-DKASSERT_ASSERTION_LEVEL=<int>`).
+/// For predefined assertion levels, see @ref assertion-levels.
+/// If an assertion is enabled and fails, the KASSERT() macro prints an expansion of the expression similar to Catch2.
+/// This process is described in @ref expression-expansion.
+///
+/// The macro accepts 1 to 3 parameters:
+/// 1. The assertion expression (mandatory).
+/// 2. Error message that is printed in addition to the decomposed expression (optional). The message is piped into
+/// a logger object. Thus, one can use the `<<` operator to build the error message similar to how one would use
+/// `std::cout`.
+/// 3. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+///
+/// KASSERT() can be used in \c constexpr and \c consteval functions. If an enabled assertion fails during constant
+/// evaluation, the evaluation calls the non-constexpr function
+/// \c kassert::internal::assertion_failed_during_constant_evaluation(), i.e., compilation fails with an error that
+/// points to the assertion and its expression. At runtime, such assertions behave as usual. Since C++17 does not allow
+/// static variables in constexpr functions, this is not supported with \c KASSERT_COMPACT_CALL_SITES or
+/// \c KASSERT_INSTRUMENTATION. The same applies to KASSERT_ASSUME(), KASSERT_IN_CATEGORY() and THROWING_KASSERT().
+#define KASSERT(...)                     \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_3(__VA_ARGS__),          \
+        KASSERT_2(__VA_ARGS__),          \
+        KASSERT_1(__VA_ARGS__),          \
+        ignore                           \
+    )
+
+/// @brief Assertion macro that turns into an optimizer hint if disabled. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// If the assertion is enabled, KASSERT_ASSUME() behaves exactly like KASSERT(). If its level is disabled at compile
+/// time, the compiler may instead assume that the expression evaluates to \c true, e.g., to drop redundant bounds
+/// checks or the scalar epilogue of a vectorized loop (`KASSERT_ASSUME(size % 8 == 0)`). The hint is lowered to
+/// `[[assume(expression)]]`, `__builtin_assume(expression)` or `__assume(expression)`, which do not evaluate the
+/// expression. On older GCC versions, it falls back to `if (!(expression)) __builtin_unreachable()`, which only
+/// optimizes away the evaluation of side-effect-free expressions that the compiler can see through.
+///
+/// Thus, the expression must not have side effects and should not call functions whose result the compiler cannot
+/// reason about. If a disabled assertion does not hold, the behavior of the program is undefined.
+///
+/// The parameters are the same as for KASSERT().
+#define KASSERT_ASSUME(...)              \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_ASSUME_3(__VA_ARGS__),   \
+        KASSERT_ASSUME_2(__VA_ARGS__),   \
+        KASSERT_ASSUME_1(__VA_ARGS__),   \
+        ignore                           \
+    )
+
+/// @brief Non-fatal assertion macro. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT(), but only prints a warning if the assertion fails and continues execution. To avoid flooding
+/// the standard error stream if the assertion fails in a hot loop, each thread reports the first
+/// \c KASSERT_WARNING_BURST (default: 8) failures of a call site, and afterwards only the failures whose number is a
+/// power of two. Each report after suppressed failures states the number of suppressed and of all failures so far.
+/// The rate limiter is a `thread_local` variable owned by the call site, which is only accessed if the assertion fails.
+///
+/// The parameters are the same as for KASSERT().
+#define KASSERT_WARN(...)                \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_WARN_3(__VA_ARGS__),     \
+        KASSERT_WARN_2(__VA_ARGS__),     \
+        KASSERT_WARN_1(__VA_ARGS__),     \
+        ignore                           \
+    )
+
+/// @brief Sampled assertion macro for expensive checks in hot code paths. Requires exactly four parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT(), but only evaluates the expression the first time and then every \c rate-th time the call
+/// site is reached by the calling thread. The counter is a `thread_local` variable owned by the call site, thus
+/// sampling requires neither atomic operations nor shared cache lines. If the assertion is enabled, checking whether
+/// the current evaluation is sampled costs one thread-local decrement and one branch.
+///
+/// The macro requires 4 parameters:
+/// 1. The assertion expression.
+/// 2. Error message that is printed in addition to the decomposed expression (use `""` for no message).
+/// 3. The level of the assertion (see @ref assertion-levels).
+/// 4. The sampling rate, an integer in `[1, 2^31]`; a rate of \c 1 evaluates the expression every time. Constant rates
+///    outside of this range do not compile, other rates are clamped to it.
+#define KASSERT_SAMPLED(expression, message, level, rate) \
+    KASSERT_KASSERT_HPP_KASSERT_SAMPLED_IMPL(kassert::internal::Sampler, "ASSERTION", expression, message, level, rate)
+
+/// @brief Randomized sampled assertion macro. Requires exactly four parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT_SAMPLED(), but samples the expression at random intervals of on average \c rate evaluations,
+/// which avoids aliasing between the sampling stride and periodic patterns in the checked data. Each thread uses its
+/// own pseudo random number generator, which is only advanced when a sample is taken.
+///
+/// The parameters are the same as for KASSERT_SAMPLED().
+#define KASSERT_SAMPLED_RANDOMIZED(expression, message, level, rate) \
+    KASSERT_KASSERT_HPP_KASSERT_SAMPLED_IMPL(                        \
+        kassert::internal::RandomizedSampler,                        \
+        "ASSERTION",                                                 \
+        expression,                                                  \
+        message,                                                     \
+        level,                                                       \
+        rate                                                         \
+    )
+
+/// @brief Assertion macro for checks whose cost grows with the problem size. Requires exactly five parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT(), but the assertion declares the complexity class of its expression and the size of the
+/// problem it checks. The expression is only evaluated if its estimated cost (see \c kassert::estimated_cost()) does
+/// not exceed the cost budget of its level, which can be changed at runtime using \c kassert::set_cost_budget(). The
+/// initial budget of all levels is \c KASSERT_COST_BUDGET (default: unlimited). For instance, with a budget of
+/// `1'000'000`, a linear check is evaluated for inputs of up to one million elements, but a quadratic check only for
+/// inputs of up to 1000 elements. If the assertion is enabled, the decision costs one relaxed load, the evaluation of
+/// the problem size and (depending on the complexity class) a multiplication. If \c KASSERT_INSTRUMENTATION is
+/// defined, skipped evaluations are counted per call site.
+///
+/// The macro requires 5 parameters:
+/// 1. The assertion expression.
+/// 2. Error message that is printed in addition to the decomposed expression (use `""` for no message).
+/// 3. The level of the assertion (see @ref assertion-levels).
+/// 4. The complexity class of the expression, a \c kassert::Complexity, e.g., \c kassert::Complexity::linear.
+/// 5. The problem size, a non-negative integer. Only evaluated if the assertion is enabled.
+#define KASSERT_WITH_COST(expression, message, level, complexity, size) \
+    KASSERT_KASSERT_HPP_KASSERT_WITH_COST_IMPL("ASSERTION", expression, message, level, complexity, size)
+
+/// @brief Assertion macro for assertions of a category. Accepts between two and four parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT(), but the assertion belongs to a named category, e.g., a component or namespace, whose
+/// compile-time assertion level can be set independently of \c KASSERT_ASSERTION_LEVEL using the CMake function
+/// `kassert_set_category_level(<target> <category> <level>)`. This allows to check a hot component only at a low level
+/// while checking new or untrusted components at a high level. Assertions of disabled categories do not generate any
+/// code. Categories without a level use \c KASSERT_ASSERTION_LEVEL. The runtime assertion level (see
+/// \c kassert::set_assertion_level()) applies to all assertions of the category, including levels that are only
+/// enabled by the category level.
+///
+/// The macro accepts 2 to 4 parameters:
+/// 1. The category, an identifier such as `comm` (mandatory). It is stringified, i.e., it need not be declared.
+/// 2. The assertion expression (mandatory).
+/// 3. Error message that is printed in addition to the decomposed expression (optional).
+/// 4. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_IN_CATEGORY(category, ...)            \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3(              \
+        ,                                             \
+        __VA_ARGS__,                                  \
+        KASSERT_IN_CATEGORY_3(category, __VA_ARGS__), \
+        KASSERT_IN_CATEGORY_2(category, __VA_ARGS__), \
+        KASSERT_IN_CATEGORY_1(category, __VA_ARGS__), \
+        ignore                                        \
+    )
+
+/// @brief Checks if an assertion of the given level and category is enabled at compile time. Unlike
+/// KASSERT_ENABLED(), this is a constant expression rather than a preprocessor condition, e.g., for use with
+/// `if constexpr`.
+/// @param category The category, an identifier as for KASSERT_IN_CATEGORY().
+/// @param level The level of the assertion.
+#define KASSERT_CATEGORY_ENABLED(category, level) kassert::internal::category_assertion_enabled(#category, level)
+
+/// @brief Macro for throwing exceptions. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// Exceptions are only used in exception mode, which is enabled by using the CMake option
+/// `-DKASSERT_EXCEPTION_MODE=On`. Otherwise, the macro generates a KASSERT() with assertion level
+/// `kassert::assert::kthrow` (lowest level). Requires \c kassert/exception.hpp.
+///
+/// The macro accepts 1 to 2 parameters:
+/// 1. Expression that causes the exception to be thrown if it evaluates to \c false (mandatory).
+/// 2. Error message that is printed in addition to the decomposed expression (optional). The message is piped into
+/// a logger object. Thus, one can use the `<<` operator to build the error message similar to how one would use
+/// `std::cout`.
+#define THROWING_KASSERT(...)            \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_2( \
+        ,                                \
+        __VA_ARGS__,                     \
+        THROWING_KASSERT_2(__VA_ARGS__), \
+        THROWING_KASSERT_1(__VA_ARGS__), \
+        ignore                           \
+    )
+
+/// @brief Macro for throwing custom exception. Requires \c kassert/exception.hpp.
+/// @ingroup assertion
+///
+/// The macro requires at least 2 parameters:
+/// 1. Expression that causes the exception to be thrown if it evaluates to \c false (mandatory).
+/// 2. Error message that is printed in addition to the decomposed expression (optional). The message is piped into
+/// a logger object. Thus, one can use the `<<` operator to build the error message similar to how one would use
+/// `std::cout`.
+/// 3. Type of the exception to be used. The exception type must have a ctor that takes a `std::string` as its
+/// first argument, followed by any additional parameters passed to this macro.
+/// 4, 5, 6, ... Parameters that are forwarded to the exception type's ctor.
+///
+/// Any other parameter is passed to the constructor of the exception class.
+#define THROWING_KASSERT_SPECIFIED(expression, message, exception_type, ...) \
+    KASSERT_KASSERT_HPP_THROWING_KASSERT_CUSTOM_IMPL(expression, exception_type, message, ##__VA_ARGS__)
+
+namespace kassert::internal {
+/// @brief Checks if a assertion of the given level is enabled. This is controlled by the CMake option
+/// \c KASSERT_ASSERTION_LEVEL.
+/// @param level The level of the assertion.
+/// @return Whether the assertion is enabled.
+constexpr bool assertion_enabled(int level) {
+    return level <= KASSERT_ASSERTION_LEVEL;
+}
+
+/// @brief Checks if a assertion of the given level is enabled. This is controlled by the CMake option
+/// \c KASSERT_ASSERTION_LEVEL. This is the macro version of assertion_enabled for use in the preprocessor.
+/// @param level The level of the assertion.
+/// @return Whether the assertion is enabled.
+#define KASSERT_ENABLED(level) level <= KASSERT_ASSERTION_LEVEL
+
+/// @brief Checks if an assertion of the given level and category is enabled. This is controlled by the CMake function
+/// \c kassert_set_category_level(), falling back to \c KASSERT_ASSERTION_LEVEL for categories without a level.
+/// @param category The name of the category.
+/// @param level The level of the assertion.
+/// @return Whether the assertion is enabled.
+constexpr bool category_assertion_enabled(char const* const category, int const level) {
+    return level <= category_level(category, KASSERT_CATEGORY_LEVELS, KASSERT_ASSERTION_LEVEL);
+}
+
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+/// @brief The runtime assertion level. An assertion that is enabled at compile time (see \c assertion_enabled()) is
+/// only checked if its level is also less than or equal to this value.
+///
+/// The level is constant-initialized to \c kassert::assert::unlimited, i.e., all assertions that are enabled at compile
+/// time are checked unless the level is lowered by \c kassert::set_assertion_level() or the environment variable
+/// \c KASSERT_LEVEL. The initializer must not depend on \c KASSERT_ASSERTION_LEVEL, since translation units (or
+/// categories) may be compiled with different levels but share this variable. Since the compile-time assertion level
+/// acts as a ceiling, raising the runtime level above \c KASSERT_ASSERTION_LEVEL has no effect.
+inline std::atomic<int> runtime_assertion_level{assert::unlimited};
+
+/// @brief Checks if an assertion of the given level is enabled at runtime. This is a single relaxed load followed by
+/// a comparison against a compile-time constant.
+/// @param level The level of the assertion.
+/// @return Whether the assertion is enabled at runtime.
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline bool runtime_assertion_enabled(int const level) {
+    return level <= runtime_assertion_level.load(std::memory_order_relaxed);
+}
+
+/// @brief Parses an assertion level given as a decimal integer.
+/// @param str The string to parse, e.g., the value of the \c KASSERT_LEVEL environment variable.
+/// @param level Set to the parsed assertion level on success, left unchanged otherwise.
+/// @return Whether \c str is a valid assertion level.
+inline bool parse_assertion_level(char const* str, int& level) {
+    if (str == nullptr) {
+        return false;
+    }
+    char const* const end    = str + std::strlen(str);
+    int               parsed = 0;
+    auto const        result = std::from_chars(str, end, parsed);
+    if (str == end || result.ec != std::errc{} || result.ptr != end) {
+        return false;
+    }
+    level = parsed;
+    return true;
+}
+
+/// @brief Initializes the runtime assertion level from the environment variable \c KASSERT_LEVEL, if set to a valid
+/// assertion level.
+/// @return Whether the runtime assertion level was set.
+inline bool init_runtime_assertion_level_from_environment() {
+    int level = assert::unlimited;
+    if (!parse_assertion_level(std::getenv("KASSERT_LEVEL"), level)) {
+        return false;
+    }
+    runtime_assertion_level.store(level, std::memory_order_relaxed);
+    return true;
+}
+
+/// @brief Reads \c KASSERT_LEVEL during static initialization. Assertions that are evaluated before this variable is
+/// initialized use \c kassert::assert::unlimited.
+[[maybe_unused]] inline bool const runtime_assertion_level_from_environment =
+    init_runtime_assertion_level_from_environment();
+#endif
+
+/// @brief Prints the error message of a failed assertion that could not be decomposed (i.e., expressions that use &&
+/// or ||).
+/// @tparam StreamT The underlying streaming object of the logger.
+/// @param logger The logger to write the error message to.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+template <typename StreamT>
+void print_failed_assertion(
+    Logger<StreamT>& logger, char const* type, bool, SourceLocation const& where, char const* expr_str
+) {
+    logger << where.file << ": In function '" << where.function << "':\n"
+           << where.file << ":" << where.row << ": FAILED " << type << "\n"
+           << "\t" << expr_str << "\n";
+}
+
+/// @brief Prints the error message of a failed assertion that could not be decomposed to the logger used by
+/// KASSERT(). This overload is compiled into the runtime library if \c KASSERT_RUNTIME_LIBRARY is defined.
+/// @param logger The logger to write the error message to.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param result Result of the assertion.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+KASSERT_KASSERT_HPP_INLINE void print_failed_assertion(
+    FdLogger& logger, char const* type, bool result, SourceLocation const& where, char const* expr_str
+);
+
+/// @brief Prints the error message of a failed assertion, including the expansion of the type-erased decomposed
+/// expression (see \c KASSERT_TYPE_ERASED_OPERANDS). This overload is compiled into the runtime library if
+/// \c KASSERT_RUNTIME_LIBRARY is defined.
+/// @param logger The logger to write the error message to.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param erased Type-erased formatting of the assertion expression.
+/// @param expr The assertion expression.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+KASSERT_KASSERT_HPP_INLINE void print_failed_assertion(
+    FdLogger&               logger,
+    char const*             type,
+    ErasedExpression const& erased,
+    void const*             expr,
+    SourceLocation const&   where,
+    char const*             expr_str
+);
+
+/// @brief Writes a string to a JSON record (see \c kassert::ReportFormat::json), including the quotes.
+/// @param logger The logger containing the record.
+/// @param value The null-terminated string.
+KASSERT_KASSERT_HPP_INLINE void print_record_string(FdLogger& logger, char const* value);
+
+/// @brief Starts the JSON record of a failed assertion with its severity, type, location and expression.
+/// @param logger The logger to write the record to.
+/// @param type Type of the check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+KASSERT_KASSERT_HPP_INLINE void
+print_record_header(FdLogger& logger, char const* type, SourceLocation const& where, char const* expr_str);
+
+/// @brief Starts the message of a JSON record. The following output is escaped until the message is closed.
+/// @param logger The logger containing the record.
+KASSERT_KASSERT_HPP_INLINE void open_record_message(FdLogger& logger);
+
+/// @brief Closes the message of a JSON record, if it is open.
+/// @param logger The logger containing the record.
+KASSERT_KASSERT_HPP_INLINE void close_record_message(FdLogger& logger);
+
+/// @brief Completes a JSON record with the assertion level (if known), the ID of the calling thread, the MPI rank (if
+/// known) and whether the record was truncated, and terminates it with a newline.
+/// @param logger The logger containing the record.
+KASSERT_KASSERT_HPP_INLINE void finish_record(FdLogger& logger);
+
+/// @brief Returns the ID of the calling thread that is reported by JSON records: the kernel thread ID on Linux, and a
+/// sequential number otherwise.
+/// @return The thread ID.
+KASSERT_KASSERT_HPP_INLINE unsigned long long current_thread_id();
+
+/// @brief Writes a stringified operand of a decomposed expression to a JSON record.
+/// @tparam ValueT Type of the operand.
+/// @param logger The logger containing the record.
+/// @param value The operand.
+template <typename ValueT>
+void print_record_operand(FdLogger& logger, ValueT const& value) {
+    logger << "\"";
+    logger.set_escaping(true);
+    stringify_value(logger, value);
+    logger.set_escaping(false);
+    logger << "\"";
+}
+
+/// @brief Writes the operand of a decomposed unary expression to a JSON record.
+/// @tparam LhsT Type of the operand.
+/// @param logger The logger containing the record.
+/// @param expr The expression.
+template <typename LhsT>
+void print_record_operands(FdLogger& logger, UnaryExpression<LhsT> const& expr) {
+    logger << ",\"operands\":[";
+    print_record_operand(logger, expr.operand());
+    logger << "]";
+}
+
+/// @brief Writes the relation and the operands of a decomposed binary expression to a JSON record.
+/// @tparam LhsT Type of the left hand side.
+/// @tparam RhsT Type of the right hand side.
+/// @tparam OpT Tag type of the operator or relation.
+/// @param logger The logger containing the record.
+/// @param expr The expression.
+template <typename LhsT, typename RhsT, typename OpT>
+void print_record_operands(FdLogger& logger, BinaryExpression<LhsT, RhsT, OpT> const& expr) {
+    logger << ",\"relation\":";
+    print_record_string(logger, OpT::symbol);
+    logger << ",\"operands\":[";
+    print_record_operand(logger, expr.lhs_operand());
+    logger << ",";
+    print_record_operand(logger, expr.rhs_operand());
+    logger << "]";
+}
+
+/// @brief Prints the error message of a failed assertion, including the expansion of the decomposed expression.
+/// @tparam StreamT The underlying streaming object of the logger.
+/// @tparam ExprT Type of the decomposed assertion expression.
+/// @param logger The logger to write the error message to.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param expr The decomposed assertion expression.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+template <typename StreamT, typename ExprT>
+void print_failed_assertion(
+    Logger<StreamT>&         logger,
+    char const*              type,
+    Expression<ExprT> const& expr,
+    SourceLocation const&    where,
+    char const*              expr_str
+) {
+    if constexpr (std::is_same_v<StreamT, FileDescriptor>) {
+        if (report_format() == ReportFormat::json) {
+            print_record_header(logger, type, where, expr_str);
+            print_record_operands(logger, static_cast<ExprT const&>(expr));
+            open_record_message(logger);
+            return;
+        }
+    }
+    print_failed_assertion(logger, type, false, where, expr_str);
+    logger << "with expansion:\n"
+           << "\t" << expr << "\n";
+}
+
+/// @brief Returns the result of an assertion that could not be decomposed.
+/// @param result Result of the assertion.
+/// @return Result of the assertion.
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr bool expression_result(bool const result) {
+    return result;
+}
+
+/// @brief Returns the result of a decomposed assertion expression.
+/// @tparam ExprT Type of the decomposed expression.
+/// @param expr The decomposed expression.
+/// @return Result of the assertion.
+template <typename ExprT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr bool expression_result(ExprT const& expr) {
+    return expr.result();
+}
+
+/// @brief Reached instead of the failure path if an assertion fails during constant evaluation. Since this function is
+/// not \c constexpr, the failed assertion becomes a compile-time error, which names this function and points to the
+/// assertion in the backtrace of the constant evaluation.
+/// @param expr_str Stringified assertion expression.
+inline void assertion_failed_during_constant_evaluation([[maybe_unused]] char const* expr_str) {}
+
+/// @brief Suspends a thread on the failure path of a fatal assertion for about a millisecond.
+KASSERT_KASSERT_HPP_INLINE void pause_failing_thread();
+
+/// @brief Enters the protocol of threads that fail fatal assertions concurrently (see \c fail_with_report()) before
+/// the report of this thread is written. If another thread failed first, waits for up to
+/// \c KASSERT_FAILURE_GRACE_PERIOD_MS milliseconds until it has written its report. Only uses atomics and
+/// \c pause_failing_thread(), i.e., it may be called from a failure handler that must be async-signal-safe.
+/// @return Whether this thread failed first.
+KASSERT_KASSERT_HPP_INLINE bool enter_failure_report();
+
+/// @brief Leaves the protocol entered by \c enter_failure_report() after the report of this thread was written and
+/// aborts the program. The first failing thread waits for the reports of the other failing threads, which are held
+/// until it aborts the program.
+/// @param first Whether this thread failed first, i.e., the result of \c enter_failure_report().
+[[noreturn]] KASSERT_KASSERT_HPP_INLINE void leave_failure_report(bool first);
+
+/// @brief Passes the report of a failed fatal assertion to the installed failure handler, if any. If there is no
+/// handler or the handler returns, submits the report to the report sink and aborts the program.
+///
+/// If several threads fail at once, the first one wins: it submits its report first and then waits for up to
+/// \c KASSERT_FAILURE_GRACE_PERIOD_MS milliseconds until the other failing threads, including threads that are still in
+/// the failure handler, have submitted their reports, before it aborts the program. The other threads are held
+/// afterwards, such that their reports are never cut off and the program terminates with the first failure. Since
+/// each report is submitted with a single call, reports never interleave. Only failing threads synchronize; there is
+/// no lock on any other path.
+/// @param report The formatted report, which is not null-terminated.
+/// @param size The length of the report.
+[[noreturn]] KASSERT_KASSERT_HPP_INLINE void fail_with_report(char const* report, std::size_t size);
+
+/// @brief Terminates the error message of a failed assertion and passes it to \c fail_with_report(), i.e., to the
+/// installed failure handler or the report sink, and aborts the program.
+/// @param logger The logger containing the error message.
+[[noreturn]] KASSERT_KASSERT_HPP_INLINE void finish_failed_assertion(FdLogger& logger);
+
+/// @brief Reports the description of an exception that would have been thrown by THROWING_KASSERT() like a failed
+/// assertion (see \c fail_with_report()).
+/// @param what The description of the exception.
+[[noreturn]] KASSERT_KASSERT_HPP_INLINE void fail_with_description(char const* what);
+
+/// @brief Type-erased formatting of a failed assertion, i.e., of its expression type and its message type.
+struct ErasedFailure {
+    /// @brief Formatting of the assertion expression.
+    ErasedExpression expression;
+    /// @brief Calls the callable passed as a pointer that writes the user message to a logger.
+    void (*write_message)(FdLogger& logger, void const* message);
+};
+
+/// @brief Calls a type-erased callable that writes the user message of a failed assertion. This function is cold and
+/// never inlined, i.e., the user message is optimized for size like the rest of the failure path.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param logger The logger to write the message to.
+/// @param message The callable.
+template <typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void write_erased_message(FdLogger& logger, void const* message) {
+    (*static_cast<MessageT const*>(message))(logger);
+}
+
+/// @brief Type-erased formatting of failed assertions with the given expression and message types. Since it is a
+/// constant, call sites only pass a pointer to it to the failure path.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+template <typename ExprT, typename MessageT>
+inline constexpr ErasedFailure erased_failure{ExpressionErasure<ExprT>::erased, &write_erased_message<MessageT>};
+
+/// @brief Failure path of KASSERT() if \c KASSERT_TYPE_ERASED_OPERANDS is defined, to which \c fail_assertion()
+/// forwards: prints an error describing the failed assertion, followed by the user message, and aborts the program.
+/// Since the expression and the message are type-erased, this function is compiled once instead of once per call site,
+/// and is compiled into the runtime library if \c KASSERT_RUNTIME_LIBRARY is defined.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param erased Type-erased formatting of the assertion, i.e., \c erased_failure for its expression and message.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+[[noreturn]] KASSERT_KASSERT_HPP_INLINE void fail_erased_assertion(
+    char const*           type,
+    SourceLocation const& where,
+    char const*           expr_str,
+    ErasedFailure const&  erased,
+    void const*           expr,
+    void const*           message
+);
+
+/// @brief Failure path of KASSERT(): prints an error describing the failed assertion, followed by the user message,
+/// and aborts the program. This function is cold and never inlined to keep the code at the call site small.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+template <typename ExprT, typename MessageT>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void fail_assertion(
+    char const* type, SourceLocation const where, char const* expr_str, ExprT const expr, MessageT const message
+) {
+#if defined(KASSERT_TYPE_ERASED_OPERANDS)
+    fail_erased_assertion(type, where, expr_str, erased_failure<ExprT, MessageT>, &expr, &message);
+#else
+    // format the whole report into a single stack buffer, which is written with a single call to write(2)
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, type, expr, where, expr_str);
+    message(logger);
+    finish_failed_assertion(logger);
+#endif
+}
+
+/// @brief Failure path of KASSERT() if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but the static
+/// metadata of the call site is passed as a single pointer to a constant record.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+template <typename ExprT, typename MessageT>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void
+fail_assertion(AssertionSite const* site, ExprT const expr, MessageT const message) {
+#if defined(KASSERT_TYPE_ERASED_OPERANDS)
+    fail_erased_assertion(
+        site->type, site->location, site->expression, erased_failure<ExprT, MessageT>, &expr, &message
+    );
+#else
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, site->type, expr, site->location, site->expression);
+    message(logger);
+    finish_failed_assertion(logger);
+#endif
+}
+
+/// @brief Evaluates an assertion expression. If the assertion fails, calls the cold failure path \c fail_assertion(),
+/// which prints an error describing the failed assertion and aborts the program. Since this function is always
+/// inlined, the inline part of an assertion is only the comparison plus a branch.
+///
+/// All parameters are passed by value: decomposed expressions only store their result and their (small or referenced)
+/// operands. This allows the compiler to keep them in registers on the success path instead of materializing them
+/// on the stack.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param type Actual type of this check. In exception mode, this parameter has always value \c ASSERTION, otherwise
+/// it names the type of the exception that would have been thrown.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr Assertion expression to be checked.
+/// @param message Callable that writes the user message. Only called if the assertion failed.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr void evaluate_assertion(
+    char const* type, SourceLocation const where, char const* expr_str, ExprT const expr, MessageT const message
+) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        if (KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED()) {
+            assertion_failed_during_constant_evaluation(expr_str);
+        }
+        fail_assertion(type, where, expr_str, expr, message);
+    }
+}
+
+/// @brief Evaluates an assertion expression if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but the
+/// static metadata of the call site is passed as a single pointer to a constant record, which reduces the number of
+/// values that have to be materialized at the call site.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site.
+/// @param expr Assertion expression to be checked.
+/// @param message Callable that writes the user message. Only called if the assertion failed.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr void
+evaluate_assertion(AssertionSite const* site, ExprT const expr, MessageT const message) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        if (KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED()) {
+            assertion_failed_during_constant_evaluation(site->expression);
+        }
+        fail_assertion(site, expr, message);
+    }
+}
+
+/// @brief Terminates the report of a failed non-fatal assertion and writes it to the file descriptor.
+/// @param logger The logger containing the report.
+/// @param suppressed Number of failures of the call site that were suppressed since the last report.
+/// @param failures Number of failures of the call site so far.
+KASSERT_KASSERT_HPP_INLINE void finish_warning(FdLogger& logger, std::uint64_t suppressed, std::uint64_t failures);
+
+/// @brief Failure path of KASSERT_WARN() if \c KASSERT_TYPE_ERASED_OPERANDS is defined, to which \c fail_warning()
+/// forwards: if the rate limiter of the call site lets the failure pass, prints an error describing the failed
+/// assertion, followed by the user message. Since the expression and the message are type-erased, this function is
+/// compiled once instead of once per call site.
+/// @param limiter Rate limiter of the call site.
+/// @param burst Number of failures of the call site that are always reported, i.e., \c KASSERT_WARNING_BURST.
+/// @param type Type of this check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param erased Type-erased formatting of the assertion, i.e., \c erased_failure for its expression and message.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+KASSERT_KASSERT_HPP_INLINE void fail_erased_warning(
+    WarningLimiter&       limiter,
+    std::uint64_t         burst,
+    char const*           type,
+    SourceLocation const& where,
+    char const*           expr_str,
+    ErasedFailure const&  erased,
+    void const*           expr,
+    void const*           message
+);
+
+/// @brief Failure path of KASSERT_WARN(): if the rate limiter of the call site lets the failure pass, prints an error
+/// describing the failed assertion, followed by the user message. This function is cold and never inlined to keep the
+/// code at the call site small.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param limiter Rate limiter of the call site.
+/// @param type Type of this check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void fail_warning(
+    WarningLimiter&      limiter,
+    char const*          type,
+    SourceLocation const where,
+    char const*          expr_str,
+    ExprT const          expr,
+    MessageT const       message
+) {
+#if defined(KASSERT_TYPE_ERASED_OPERANDS)
+    fail_erased_warning(
+        limiter, KASSERT_WARNING_BURST, type, where, expr_str, erased_failure<ExprT, MessageT>, &expr, &message
+    );
+#else
+    if (!limiter.report(KASSERT_WARNING_BURST)) {
+        return;
+    }
+    FdLogger logger(standard_error, ReportSeverity::warning);
+    print_failed_assertion(logger, type, expr, where, expr_str);
+    message(logger);
+    finish_warning(logger, limiter.take_suppressed(), limiter.failures);
+#endif
+}
+
+/// @brief Failure path of KASSERT_WARN() if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but the static
+/// metadata of the call site is passed as a single pointer to a constant record.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param limiter Rate limiter of the call site.
+/// @param site Static metadata of the assertion call site.
+/// @param expr The failed assertion expression.
+/// @param message Callable that writes the user message.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void
+fail_warning(WarningLimiter& limiter, AssertionSite const* site, ExprT const expr, MessageT const message) {
+#if defined(KASSERT_TYPE_ERASED_OPERANDS)
+    fail_erased_warning(
+        limiter,
+        KASSERT_WARNING_BURST,
+        site->type,
+        site->location,
+        site->expression,
+        erased_failure<ExprT, MessageT>,
+        &expr,
+        &message
+    );
+#else
+    if (!limiter.report(KASSERT_WARNING_BURST)) {
+        return;
+    }
+    FdLogger logger(standard_error, ReportSeverity::warning);
+    print_failed_assertion(logger, site->type, expr, site->location, site->expression);
+    message(logger);
+    finish_warning(logger, limiter.take_suppressed(), limiter.failures);
+#endif
+}
+
+/// @brief Evaluates a non-fatal assertion expression. If the assertion fails, calls the cold failure path
+/// \c fail_warning(), which consults the rate limiter of the call site. Since this function is always inlined, the
+/// inline part of a non-fatal assertion is only the comparison plus a branch.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param limiter Rate limiter of the call site.
+/// @param type Type of this check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion expression.
+/// @param expr Assertion expression to be checked.
+/// @param message Callable that writes the user message. Only called if the assertion failed and is reported.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline void evaluate_warning(
+    WarningLimiter&      limiter,
+    char const*          type,
+    SourceLocation const where,
+    char const*          expr_str,
+    ExprT const          expr,
+    MessageT const       message
+) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        fail_warning(limiter, type, where, expr_str, expr, message);
+    }
+}
+
+/// @brief Evaluates a non-fatal assertion expression if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but
+/// the static metadata of the call site is passed as a single pointer to a constant record.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param limiter Rate limiter of the call site.
+/// @param site Static metadata of the assertion call site.
+/// @param expr Assertion expression to be checked.
+/// @param message Callable that writes the user message. Only called if the assertion failed and is reported.
+template <typename ExprT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline void
+evaluate_warning(WarningLimiter& limiter, AssertionSite const* site, ExprT const expr, MessageT const message) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        fail_warning(limiter, site, expr, message);
+    }
+}
+
+/// @brief Failure path of THROWING_KASSERT() in exception mode: constructs the exception and throws it. This function
+/// is cold and never inlined to keep the code at the call site small.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam ExceptionFactoryT Callable that constructs the exception object from the call site and the failed
+/// expression.
+/// @tparam SiteArgs Types of the call site metadata, see \c make_assertion_site().
+/// @param expr The failed assertion expression.
+/// @param make_exception Callable that constructs the exception object.
+/// @param site Static metadata of the assertion call site.
+template <typename ExprT, typename ExceptionFactoryT, typename... SiteArgs>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void
+throw_exception(ExprT const expr, ExceptionFactoryT const make_exception, SiteArgs const... site) {
+    throw make_exception(make_assertion_site(site...), expr);
+}
+
+/// @brief Evaluates the expression of a THROWING_KASSERT() in exception mode. If the assertion fails, calls the cold
+/// failure path \c throw_exception(). Since this function is always inlined, the inline part of the assertion is only
+/// the comparison plus a branch.
+///
+/// As for \c evaluate_assertion(), the call site metadata is passed as separate arguments (or a single pointer if
+/// \c KASSERT_COMPACT_CALL_SITES is defined) rather than captured by the exception factory, such that it is not
+/// materialized on the success path.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam ExceptionFactoryT Callable that constructs the exception object from the call site and the failed
+/// expression.
+/// @tparam SiteArgs Types of the call site metadata, see \c make_assertion_site().
+/// @param expr Assertion expression to be checked.
+/// @param make_exception Callable that constructs the exception object. Only called if the assertion failed.
+/// @param site Static metadata of the assertion call site.
+template <typename ExprT, typename ExceptionFactoryT, typename... SiteArgs>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr void
+evaluate_throwing_assertion(ExprT const expr, ExceptionFactoryT const make_exception, SiteArgs const... site) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        if (KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED()) {
+            assertion_failed_during_constant_evaluation(make_assertion_site(site...).expression);
+        }
+        throw_exception(expr, make_exception, site...);
+    }
+}
+
+/// @brief Failure path of THROWING_KASSERT() if exception mode is disabled: constructs the exception, prints its
+/// description and aborts the program. This function is cold and never inlined to keep the code at the call site
+/// small.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam ExceptionFactoryT Callable that constructs the exception object from the call site and the failed
+/// expression.
+/// @tparam SiteArgs Types of the call site metadata, see \c make_assertion_site().
+/// @param expr The failed assertion expression.
+/// @param make_exception Callable that constructs the exception object.
+/// @param site Static metadata of the assertion call site.
+template <typename ExprT, typename ExceptionFactoryT, typename... SiteArgs>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void
+fail_throwing_assertion(ExprT const expr, ExceptionFactoryT const make_exception, SiteArgs const... site) {
+    fail_with_description(make_exception(make_assertion_site(site...), expr).what());
+}
+
+/// @brief Evaluates the expression of a THROWING_KASSERT() if exception mode is disabled. If the assertion fails, calls
+/// the cold failure path \c fail_throwing_assertion(). This function has a different name than its counterpart in
+/// exception mode, such that translation units compiled with and without exception mode can be linked together.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @tparam ExceptionFactoryT Callable that constructs the exception object from the call site and the failed
+/// expression.
+/// @tparam SiteArgs Types of the call site metadata, see \c make_assertion_site().
+/// @param expr Assertion expression to be checked.
+/// @param make_exception Callable that constructs the exception object. Only called if the assertion failed.
+/// @param site Static metadata of the assertion call site.
+template <typename ExprT, typename ExceptionFactoryT, typename... SiteArgs>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr void
+evaluate_fatal_throwing_assertion(ExprT const expr, ExceptionFactoryT const make_exception, SiteArgs const... site) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        if (KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED()) {
+            assertion_failed_during_constant_evaluation(make_assertion_site(site...).expression);
+        }
+        fail_throwing_assertion(expr, make_exception, site...);
+    }
+}
+} // namespace kassert::internal
+
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+namespace kassert {
+/// @brief Sets the runtime assertion level. Only available if \c KASSERT_RUNTIME_ASSERTION_LEVEL is defined.
+///
+/// Assertions that are enabled at compile time (i.e., assertions with a level less than or equal to
+/// \c KASSERT_ASSERTION_LEVEL) are only checked if their level is also less than or equal to the runtime assertion
+/// level. Assertions that are disabled at compile time cannot be enabled at runtime. At startup, the runtime assertion
+/// level is read from the environment variable \c KASSERT_LEVEL, if set, and defaults to \c kassert::assert::unlimited
+/// otherwise.
+///
+/// Changes are not synchronized with assertions that are concurrently evaluated by other threads, i.e., other threads
+/// may observe the new level with some delay.
+/// @param level The new runtime assertion level.
+inline void set_assertion_level(int const level) {
+    internal::runtime_assertion_level.store(level, std::memory_order_relaxed);
+}
+
+/// @brief Returns the runtime assertion level. Only available if \c KASSERT_RUNTIME_ASSERTION_LEVEL is defined.
+/// @return The runtime assertion level.
+inline int assertion_level() {
+    return internal::runtime_assertion_level.load(std::memory_order_relaxed);
+}
+} // namespace kassert
+#endif
+
+#ifndef KASSERT_RUNTIME_LIBRARY
+    #include "kassert/internal/core_impl.hpp"
+#endif
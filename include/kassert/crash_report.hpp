@@ -0,0 +1,313 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Async-signal-safe crash reports of failed assertions, including the thread, the MPI rank and a raw
+/// backtrace.
+///
+/// \c kassert::install_crash_reporter() installs a failure handler (see \c kassert::set_failure_handler()) that
+/// writes the report of a failed fatal assertion, followed by the ID of the failing thread, the MPI rank (if known),
+/// the unsymbolized return addresses of the current call stack and the executable mappings of the process, and aborts
+/// the program. The output is formatted into stack buffers and written with `write(2)`, i.e., it neither allocates nor
+/// depends on iostreams or the report sink. The return addresses can be symbolized offline, e.g.,
+///
+/// \code
+/// addr2line -f -C -e <path of the mapping> <address - start of the mapping + offset of the mapping>
+/// \endcode
+///
+/// Optionally, core dumps are skipped, which may take minutes to write for processes with a large heap.
+///
+/// Crash reports require POSIX. On Linux with glibc, all parts of the report are available; on other platforms, the
+/// parts that cannot be obtained are omitted.
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if __has_include(<unistd.h>)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+#if __has_include(<execinfo.h>)
+    #include <execinfo.h>
+    /// @brief Whether `backtrace(3)` is available.
+    #define KASSERT_KASSERT_HPP_HAS_BACKTRACE 1
+#else
+    /// @brief Whether `backtrace(3)` is available.
+    #define KASSERT_KASSERT_HPP_HAS_BACKTRACE 0
+#endif
+#if __has_include(<sys/resource.h>)
+    #include <sys/resource.h>
+#endif
+#if defined(__linux__)
+    #include <sys/prctl.h>
+    #include <sys/syscall.h>
+#endif
+
+#include "kassert/core.hpp"
+
+namespace kassert {
+/// @brief Options of the crash reports written by \c kassert::install_crash_reporter().
+struct CrashReportOptions {
+    /// @brief File descriptor the crash reports are written to.
+    int fd = 2;
+    /// @brief Whether the unsymbolized return addresses of the call stack are reported.
+    bool backtrace = true;
+    /// @brief Whether the executable mappings of the process (from `/proc/self/maps`) are reported, which are required
+    /// to symbolize the return addresses of position-independent code and shared libraries.
+    bool memory_map = true;
+    /// @brief Whether the program dumps core after the report was written.
+    bool core_dump = true;
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Maximum number of return addresses in the backtrace of a crash report.
+constexpr int crash_report_max_frames = 64;
+
+/// @brief Size of the stack buffer a crash report is formatted into before it is written.
+constexpr std::size_t crash_report_buffer_size = 4096;
+
+/// @brief Maximum length of a line of the memory map that is reported; longer lines are truncated.
+constexpr std::size_t crash_report_max_line_length = 512;
+
+/// @brief Options of the installed crash reporter. Written before the handler is installed, read by the handler.
+inline CrashReportOptions crash_report_options;
+
+/// @brief Whether a thread is writing its crash report. Since a crash report is written in several chunks, the reports
+/// of threads that fail concurrently are written one after another.
+inline std::atomic<bool> crash_report_writing{false};
+
+/// @brief Formats a crash report into a fixed-size stack buffer and writes it to a file descriptor whenever the buffer
+/// is full. Only uses async-signal-safe functions.
+class CrashReportWriter {
+public:
+    /// @brief Constructs the writer.
+    /// @param out The file descriptor to write to.
+    explicit CrashReportWriter(FileDescriptor const out) : _out(out) {}
+
+    CrashReportWriter(CrashReportWriter const&)            = delete;
+    CrashReportWriter& operator=(CrashReportWriter const&) = delete;
+
+    /// @brief Writes the remaining buffered output.
+    ~CrashReportWriter() {
+        flush();
+    }
+
+    /// @brief Appends a string.
+    /// @param data The string.
+    /// @param size The length of the string.
+    /// @return This writer.
+    CrashReportWriter& append(char const* data, std::size_t size) {
+        while (size > 0) {
+            if (_size == crash_report_buffer_size) {
+                flush();
+            }
+            std::size_t const available = crash_report_buffer_size - _size;
+            std::size_t const length    = size < available ? size : available;
+            std::memcpy(_buffer + _size, data, length);
+            _size += length;
+            data += length;
+            size -= length;
+        }
+        return *this;
+    }
+
+    /// @brief Appends a null-terminated string.
+    /// @param str The string.
+    /// @return This writer.
+    CrashReportWriter& append(char const* str) {
+        return append(str, std::strlen(str));
+    }
+
+    /// @brief Appends a number.
+    /// @param value The number.
+    /// @param base The base of the number, e.g., \c 16 for hexadecimal output.
+    /// @return This writer.
+    CrashReportWriter& append_number(unsigned long long const value, int const base = 10) {
+        char digits[number_buffer_size];
+        return append(digits, format_number(digits, value, base));
+    }
+
+    /// @brief Writes the buffered output to the file descriptor.
+    void flush() {
+        if (_size > 0) {
+            write_to(_out, _buffer, _size);
+            _size = 0;
+        }
+    }
+
+private:
+    char           _buffer[crash_report_buffer_size]; ///< @brief The output buffer.
+    std::size_t    _size = 0;                         ///< @brief Number of bytes in the buffer.
+    FileDescriptor _out;                              ///< @brief The file descriptor to write to.
+};
+
+/// @brief Appends the unsymbolized return addresses of the current call stack to a crash report.
+/// @param writer The crash report.
+inline void append_backtrace(CrashReportWriter& writer) {
+#if KASSERT_KASSERT_HPP_HAS_BACKTRACE
+    void*     frames[crash_report_max_frames];
+    int const depth = ::backtrace(frames, crash_report_max_frames);
+    writer.append("backtrace:\n");
+    for (int frame = 0; frame < depth; ++frame) {
+        writer.append("\t#").append_number(static_cast<unsigned long long>(frame)).append(" 0x");
+        writer.append_number(static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(frames[frame])), 16);
+        writer.append("\n");
+    }
+#else
+    static_cast<void>(writer);
+#endif
+}
+
+/// @brief Checks if a line of `/proc/self/maps` describes an executable mapping, i.e., if the permissions (the second
+/// field) contain \c x.
+/// @param line The line.
+/// @param length The length of the line.
+/// @return Whether the mapping is executable.
+inline bool is_executable_mapping(char const* line, std::size_t const length) {
+    char const* const permissions = static_cast<char const*>(std::memchr(line, ' ', length));
+    return permissions != nullptr && permissions + 3 < line + length && permissions[3] == 'x';
+}
+
+/// @brief Appends the executable mappings of the process to a crash report, i.e., the lines of `/proc/self/maps` that
+/// describe executable mappings.
+/// @param writer The crash report.
+inline void append_memory_map(CrashReportWriter& writer) {
+#if __has_include(<unistd.h>)
+    int const maps = ::open("/proc/self/maps", O_RDONLY);
+    if (maps < 0) {
+        return;
+    }
+    writer.append("memory map:\n");
+    char        chunk[crash_report_buffer_size];
+    char        line[crash_report_max_line_length];
+    std::size_t length = 0;
+    for (;;) {
+        auto const bytes = ::read(maps, chunk, sizeof(chunk));
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            break;
+        }
+        for (char const* c = chunk; c != chunk + bytes; ++c) {
+            if (*c != '\n') {
+                // truncate long lines, i.e., long paths
+                if (length < crash_report_max_line_length) {
+                    line[length++] = *c;
+                }
+                continue;
+            }
+            if (is_executable_mapping(line, length)) {
+                writer.append("\t").append(line, length).append("\n");
+            }
+            length = 0;
+        }
+    }
+    ::close(maps);
+#else
+    static_cast<void>(writer);
+#endif
+}
+
+/// @brief Writes a crash report. Only uses async-signal-safe functions.
+/// @param out The file descriptor to write to.
+/// @param report The report of the failed assertion.
+/// @param size The length of the report.
+/// @param options Selects the parts of the crash report.
+inline void write_crash_report(
+    FileDescriptor const out, char const* report, std::size_t const size, CrashReportOptions const& options
+) {
+    CrashReportWriter writer(out);
+    writer.append(report, size);
+#if defined(__linux__)
+    writer.append("thread: ").append_number(static_cast<unsigned long long>(::syscall(SYS_gettid))).append("\n");
+#endif
+    if (int const rank = report_rank.load(std::memory_order_relaxed); rank >= 0) {
+        writer.append("rank: ").append_number(static_cast<unsigned long long>(rank)).append("\n");
+    }
+    if (options.backtrace) {
+        append_backtrace(writer);
+    }
+    if (options.memory_map) {
+        append_memory_map(writer);
+    }
+}
+
+/// @brief Prevents the program from dumping core, also if core dumps are piped to a handler such as
+/// `systemd-coredump`.
+inline void disable_core_dumps() {
+#if __has_include(<sys/resource.h>)
+    struct rlimit const no_core_dump = {0, 0};
+    ::setrlimit(RLIMIT_CORE, &no_core_dump);
+#endif
+#if defined(__linux__)
+    ::prctl(PR_SET_DUMPABLE, 0, 0, 0, 0);
+#endif
+}
+
+/// @brief Failure handler installed by \c kassert::install_crash_reporter(): writes the crash report and aborts the
+/// program.
+///
+/// Takes part in the protocol of concurrently failing threads (see \c fail_with_report()), i.e., the program
+/// terminates with the first failure and the reports of other failing threads follow it. The reports are written one
+/// after another; a thread that waits longer than \c KASSERT_FAILURE_GRACE_PERIOD_MS milliseconds for its turn, e.g.,
+/// behind a thread that is stuck, writes its report anyway, but leaves the turn to the thread that holds it.
+/// @param report The report of the failed assertion.
+/// @param size The length of the report.
+[[noreturn]] inline void report_crash(char const* report, std::size_t const size) {
+    CrashReportOptions const& options = crash_report_options;
+    bool const                first   = enter_failure_report();
+    bool                      writing = false;
+    for (int waited = 0; waited < KASSERT_FAILURE_GRACE_PERIOD_MS; ++waited) {
+        writing = !crash_report_writing.exchange(true, std::memory_order_acquire);
+        if (writing) {
+            break;
+        }
+        pause_failing_thread();
+    }
+    write_crash_report(FileDescriptor{options.fd}, report, size, options);
+    // a thread that gave up waiting must not release the turn of the thread that is still writing
+    if (writing) {
+        crash_report_writing.store(false, std::memory_order_release);
+    }
+    if (!options.core_dump) {
+        disable_core_dumps();
+    }
+    leave_failure_report(first);
+}
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Sets the MPI rank reported by crash reports, same as \c kassert::set_report_rank(). By default, the rank is
+/// read from the environment variables of common MPI launchers.
+/// @param rank The rank, or a negative number if it is unknown.
+inline void set_crash_report_rank(int const rank) {
+    set_report_rank(rank);
+}
+
+/// @brief Installs the crash reporter as failure handler (see \c kassert::set_failure_handler()). Must not be called
+/// while assertions may fail concurrently.
+/// @param options Selects the parts of the crash reports and whether the program dumps core.
+/// @return The previously installed failure handler.
+inline FailureHandler install_crash_reporter(CrashReportOptions const& options = {}) {
+    internal::crash_report_options = options;
+    if (internal::report_rank.load(std::memory_order_relaxed) < 0) {
+        set_report_rank(internal::mpi_rank_from_environment());
+    }
+#if KASSERT_KASSERT_HPP_HAS_BACKTRACE
+    // the first call of backtrace(3) may load libgcc, which allocates memory
+    void* frame = nullptr;
+    ::backtrace(&frame, 1);
+#endif
+    return set_failure_handler(&internal::report_crash);
+}
+} // namespace kassert
@@ -0,0 +1,621 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Assertions in CUDA and HIP device code.
+///
+/// KASSERT_DEVICE() can be used in `__device__` and `__host__ __device__` functions. In device code, the failure
+/// path neither uses iostreams nor allocates: the expression is decomposed and evaluated as by KASSERT(), and if it
+/// fails, one lane of each warp (or wavefront) copies the location, the expression, the operands and the number of
+/// failing lanes into a record of a ring buffer in mapped, page-locked host memory, and the kernel is stopped with a
+/// trap. After the kernel failed, the host drains the buffer using \c kassert::report_device_failures(), which also
+/// works if the device context is no longer usable:
+///
+/// \code
+/// kassert::DeviceFailureBuffer* const failures = kassert::install_device_failure_buffer();
+/// kernel<<<blocks, threads>>>(...);
+/// if (cudaDeviceSynchronize() != cudaSuccess) {
+///     kassert::report_device_failures(*failures); // prints the failed device assertions
+/// }
+/// \endcode
+///
+/// Assertion levels are evaluated at compile time as on the host, i.e., disabled device assertions do not generate any
+/// code. The runtime assertion level is not available in device code. In host code, KASSERT_DEVICE() behaves exactly
+/// like KASSERT().
+///
+/// The decomposed expressions are \c constexpr: CUDA requires `--expt-relaxed-constexpr` to call them from device
+/// code, HIP does not require any flags. Without relocatable device code (`-rdc=true` or `-fgpu-rdc`), each translation
+/// unit that launches kernels with device assertions must call \c kassert::install_device_failure_buffer() itself.
+///
+/// When compiled without CUDA or HIP, only the records and the host side of the buffer are available, e.g., for
+/// testing.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__HIPCC__)
+    #include <hip/hip_runtime.h>
+#elif defined(__CUDACC__)
+    #include <cuda_runtime.h>
+#endif
+
+#include "kassert/core.hpp"
+#include "kassert/exception.hpp"
+
+#ifndef KASSERT_DEVICE_FAILURE_CAPACITY
+    /// @brief Number of records of the device failure buffer. Failures of further warps are counted, but dropped.
+    #define KASSERT_DEVICE_FAILURE_CAPACITY 32
+#endif
+
+/// @cond IMPLEMENTATION
+
+// Execution space specifiers of the functions shared by host and device code, and whether this is the device pass.
+#if defined(__CUDACC__) || defined(__HIPCC__)
+    #define KASSERT_KASSERT_HPP_HOST_DEVICE     __host__ __device__
+    #define KASSERT_KASSERT_HPP_DEVICE_NOINLINE __noinline__
+#else
+    #define KASSERT_KASSERT_HPP_HOST_DEVICE
+    #define KASSERT_KASSERT_HPP_DEVICE_NOINLINE
+#endif
+#if defined(__CUDA_ARCH__) || defined(__HIP_DEVICE_COMPILE__)
+    #define KASSERT_KASSERT_HPP_DEVICE_COMPILATION 1
+#else
+    #define KASSERT_KASSERT_HPP_DEVICE_COMPILATION 0
+#endif
+
+// Linkage of the device variable holding the failure buffer and of the functions accessing it: with relocatable device
+// code, there is a single variable per program. Otherwise, device variables of different translation units cannot be
+// merged, thus each translation unit has its own variable.
+#if (defined(__CUDACC__) || defined(__HIPCC__)) && !defined(__CUDACC_RDC__) && !defined(__CLANG_RDC__)
+    #define KASSERT_KASSERT_HPP_DEVICE_LINKAGE static
+#else
+    #define KASSERT_KASSERT_HPP_DEVICE_LINKAGE inline
+#endif
+
+/// @endcond
+
+namespace kassert::internal {
+/// @brief Capacity of the text fields of a \c DeviceFailure, including the terminating null character. Longer texts
+/// are truncated.
+constexpr std::size_t device_failure_text_length = 128;
+
+/// @brief Type of a stringified operand of a failed device assertion.
+enum class DeviceOperandKind : std::uint32_t {
+    /// @brief The operand cannot be stringified, i.e., is printed as \c <?>.
+    unprintable,
+    /// @brief A \c bool or a nested decomposed expression, printed as its result.
+    boolean,
+    /// @brief A \c char.
+    character,
+    /// @brief A signed integer or enumeration.
+    signed_integer,
+    /// @brief An unsigned integer or enumeration.
+    unsigned_integer,
+    /// @brief A floating point number.
+    floating_point,
+    /// @brief A pointer, printed as its address.
+    pointer
+};
+
+/// @brief Operand of a failed device assertion, stored by value such that the host can print it.
+struct DeviceOperand {
+    /// @brief Type of the operand, selects the member of \c value.
+    DeviceOperandKind kind;
+    /// @brief Value of the operand.
+    union {
+        bool               boolean;
+        char               character;
+        long long          signed_integer;
+        unsigned long long unsigned_integer;
+        double             floating_point;
+        std::uintptr_t     pointer;
+    } value;
+};
+
+/// @brief Record of a failed device assertion, written by the device and read by the host.
+struct DeviceFailure {
+    /// @brief Set to the position of the record in the sequence of failures plus one after the record is complete.
+    unsigned long long sequence;
+    /// @brief Stringified assertion expression.
+    char expression[device_failure_text_length];
+    /// @brief User message.
+    char message[device_failure_text_length];
+    /// @brief Filename.
+    char file[device_failure_text_length];
+    /// @brief Function name.
+    char function[device_failure_text_length];
+    /// @brief Line number.
+    std::uint32_t line;
+    /// @brief Index of the block of the reporting lane.
+    std::uint32_t block[3];
+    /// @brief Index of the reporting lane in its block.
+    std::uint32_t thread[3];
+    /// @brief Number of lanes of the warp that failed the assertion at the same time.
+    std::uint32_t failing_lanes;
+    /// @brief Number of decomposed operands, i.e., \c 0 if the expression could not be decomposed, \c 1 for unary and
+    /// \c 2 for binary expressions.
+    std::uint32_t operands;
+    /// @brief Operator or relation of a binary expression.
+    char relation[4];
+    /// @brief Left hand side or operand of the expression.
+    DeviceOperand lhs;
+    /// @brief Right hand side of a binary expression.
+    DeviceOperand rhs;
+};
+
+/// @brief Static metadata of a device assertion call site.
+struct DeviceAssertionSite {
+    /// @brief Source code location of the assertion.
+    SourceLocation location;
+    /// @brief Stringified assertion expression.
+    char const* expression;
+    /// @brief User message.
+    char const* message;
+};
+
+/// @brief Index of the reporting lane in the launch grid.
+struct DeviceThreadIndex {
+    /// @brief Index of the block.
+    std::uint32_t block[3];
+    /// @brief Index of the lane in its block.
+    std::uint32_t thread[3];
+};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Ring buffer of the failed device assertions. Allocated in mapped, page-locked host memory by
+/// \c kassert::install_device_failure_buffer(), such that the host can read it after a kernel trapped.
+///
+/// The device reserves records by atomically incrementing \c head. Records are only written if they do not overwrite
+/// records that were not drained yet, i.e., if the buffer is full, further failures are only counted.
+struct DeviceFailureBuffer {
+    /// @brief Number of records reserved by the device.
+    unsigned long long head;
+    /// @brief Number of records drained by the host.
+    unsigned long long tail;
+    /// @brief The records, indexed by their position in the sequence of failures modulo the capacity.
+    internal::DeviceFailure records[KASSERT_DEVICE_FAILURE_CAPACITY];
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Copies a null-terminated string into a text field of a \c DeviceFailure, truncating it if necessary.
+/// @param destination The text field.
+/// @param source The string, may be \c nullptr.
+KASSERT_KASSERT_HPP_HOST_DEVICE inline void
+copy_device_text(char (&destination)[device_failure_text_length], char const* source) {
+    std::size_t length = 0;
+    for (; source != nullptr && source[length] != '\0' && length + 1 < device_failure_text_length; ++length) {
+        destination[length] = source[length];
+    }
+    destination[length] = '\0';
+}
+
+/// @brief Stores an operand of a failed device assertion by value.
+/// @tparam T Type of the operand.
+/// @param value The operand.
+/// @return The stored operand.
+template <typename T>
+KASSERT_KASSERT_HPP_HOST_DEVICE DeviceOperand make_device_operand(T const& value) {
+    DeviceOperand operand{};
+    if constexpr (is_expression<T>) {
+        operand.kind          = DeviceOperandKind::boolean;
+        operand.value.boolean = value.result();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        operand.kind          = DeviceOperandKind::boolean;
+        operand.value.boolean = value;
+    } else if constexpr (std::is_same_v<T, char>) {
+        operand.kind            = DeviceOperandKind::character;
+        operand.value.character = value;
+    } else if constexpr (std::is_enum_v<T>) {
+        return make_device_operand(static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        operand.kind                 = DeviceOperandKind::signed_integer;
+        operand.value.signed_integer = static_cast<long long>(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        operand.kind                   = DeviceOperandKind::unsigned_integer;
+        operand.value.unsigned_integer = static_cast<unsigned long long>(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        operand.kind                 = DeviceOperandKind::floating_point;
+        operand.value.floating_point = static_cast<double>(value);
+    } else if constexpr (std::is_pointer_v<T>) {
+        operand.kind          = DeviceOperandKind::pointer;
+        operand.value.pointer = reinterpret_cast<std::uintptr_t>(value);
+    } else if constexpr (std::is_null_pointer_v<T>) {
+        operand.kind          = DeviceOperandKind::pointer;
+        operand.value.pointer = 0;
+    } else {
+        operand.kind = DeviceOperandKind::unprintable;
+    }
+    return operand;
+}
+
+/// @brief Stores the operands of an expression that could not be decomposed, i.e., none.
+/// @param failure The record.
+KASSERT_KASSERT_HPP_HOST_DEVICE inline void store_device_operands(DeviceFailure& failure, bool) {
+    failure.operands = 0;
+}
+
+/// @brief Stores the operand of a decomposed unary expression.
+/// @tparam LhsT Type of the operand.
+/// @param failure The record.
+/// @param expr The expression.
+template <typename LhsT>
+KASSERT_KASSERT_HPP_HOST_DEVICE void store_device_operands(DeviceFailure& failure, UnaryExpression<LhsT> const& expr) {
+    failure.operands = 1;
+    failure.lhs      = make_device_operand(expr.operand());
+}
+
+/// @brief Stores the operands and the relation of a decomposed binary expression.
+/// @tparam LhsT Type of the left hand side.
+/// @tparam RhsT Type of the right hand side.
+/// @tparam OpT Tag type of the operator or relation.
+/// @param failure The record.
+/// @param expr The expression.
+template <typename LhsT, typename RhsT, typename OpT>
+KASSERT_KASSERT_HPP_HOST_DEVICE void
+store_device_operands(DeviceFailure& failure, BinaryExpression<LhsT, RhsT, OpT> const& expr) {
+    failure.operands   = 2;
+    failure.lhs        = make_device_operand(expr.lhs_operand());
+    failure.rhs        = make_device_operand(expr.rhs_operand());
+    std::size_t length = 0;
+    for (; OpT::symbol[length] != '\0' && length + 1 < sizeof(failure.relation); ++length) {
+        failure.relation[length] = OpT::symbol[length];
+    }
+    failure.relation[length] = '\0';
+}
+
+/// @brief Atomically increments a counter shared by host and device.
+/// @param counter The counter.
+/// @return The previous value of the counter.
+KASSERT_KASSERT_HPP_HOST_DEVICE inline unsigned long long device_fetch_increment(unsigned long long* counter) {
+#if KASSERT_KASSERT_HPP_DEVICE_COMPILATION
+    return atomicAdd(counter, 1ull);
+#else
+    return __atomic_fetch_add(counter, 1ull, __ATOMIC_RELAXED);
+#endif
+}
+
+/// @brief Reads a counter that is written by the other side of the buffer.
+/// @param counter The counter.
+/// @return The value of the counter.
+KASSERT_KASSERT_HPP_HOST_DEVICE inline unsigned long long device_load(unsigned long long const* counter) {
+#if KASSERT_KASSERT_HPP_DEVICE_COMPILATION
+    return *static_cast<unsigned long long const volatile*>(counter);
+#else
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/// @brief Makes a record visible to the host: waits until the preceding writes are visible system-wide and publishes
+/// its sequence number.
+/// @param sequence The sequence number of the record.
+/// @param value The position of the record in the sequence of failures plus one.
+KASSERT_KASSERT_HPP_HOST_DEVICE inline void device_publish(unsigned long long* sequence, unsigned long long value) {
+#if KASSERT_KASSERT_HPP_DEVICE_COMPILATION
+    __threadfence_system();
+    *static_cast<unsigned long long volatile*>(sequence) = value;
+    __threadfence_system();
+#else
+    __atomic_store_n(sequence, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/// @brief Writes the record of a failed device assertion into the failure buffer, unless it is full.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @param buffer The failure buffer, may be \c nullptr.
+/// @param site Static metadata of the assertion call site.
+/// @param expr The failed assertion expression.
+/// @param failing_lanes Number of lanes of the warp that failed the assertion at the same time.
+/// @param index Index of the reporting lane.
+/// @return Whether the record was written.
+template <typename ExprT>
+KASSERT_KASSERT_HPP_HOST_DEVICE bool record_device_failure(
+    DeviceFailureBuffer*       buffer,
+    DeviceAssertionSite const& site,
+    ExprT const&               expr,
+    std::uint32_t const        failing_lanes,
+    DeviceThreadIndex const&   index
+) {
+    if (buffer == nullptr) {
+        return false;
+    }
+    unsigned long long const position = device_fetch_increment(&buffer->head);
+    if (position - device_load(&buffer->tail) >= KASSERT_DEVICE_FAILURE_CAPACITY) {
+        return false;
+    }
+    DeviceFailure& failure = buffer->records[position % KASSERT_DEVICE_FAILURE_CAPACITY];
+    copy_device_text(failure.expression, site.expression);
+    copy_device_text(failure.message, site.message);
+    copy_device_text(failure.file, site.location.file);
+    copy_device_text(failure.function, site.location.function);
+    failure.line = site.location.row;
+    for (int dimension = 0; dimension < 3; ++dimension) {
+        failure.block[dimension]  = index.block[dimension];
+        failure.thread[dimension] = index.thread[dimension];
+    }
+    failure.failing_lanes = failing_lanes;
+    store_device_operands(failure, expr);
+    device_publish(&failure.sequence, position + 1);
+    return true;
+}
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+/// @brief Failure buffer of the device assertions, set by \c kassert::install_device_failure_buffer().
+KASSERT_KASSERT_HPP_DEVICE_LINKAGE __device__ DeviceFailureBuffer* device_failure_buffer = nullptr;
+#endif
+
+#if KASSERT_KASSERT_HPP_DEVICE_COMPILATION
+/// @brief The lanes of the current warp that failed an assertion at the same time.
+struct DeviceFailingLanes {
+    /// @brief Mask of the failing lanes.
+    unsigned long long mask;
+    /// @brief Number of failing lanes.
+    std::uint32_t count;
+    /// @brief Whether the current lane reports the failure, i.e., is the first failing lane.
+    bool leader;
+};
+
+/// @brief Determines the lanes of the current warp that are on the failure path of the same assertion. This is only
+/// called on the failure path, thus the active lanes are the failing lanes.
+/// @return The failing lanes.
+__device__ inline DeviceFailingLanes device_failing_lanes() {
+    #if defined(__HIP_DEVICE_COMPILE__)
+    unsigned long long const mask = __ballot(1);
+    auto const               lane = static_cast<int>(__lane_id());
+    return {mask, static_cast<std::uint32_t>(__popcll(mask)), lane == __ffsll(static_cast<long long>(mask)) - 1};
+    #else
+    unsigned const mask = __activemask();
+    unsigned       lane = 0;
+    asm("mov.u32 %0, %%laneid;" : "=r"(lane));
+    return {mask, static_cast<std::uint32_t>(__popc(mask)), static_cast<int>(lane) == __ffs(mask) - 1};
+    #endif
+}
+
+/// @brief Failure path of KASSERT_DEVICE(): the first failing lane of each warp writes the record, then all failing
+/// lanes stop the kernel.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @param site Static metadata of the assertion call site.
+/// @param expr The failed assertion expression.
+template <typename ExprT>
+[[noreturn]] __device__ KASSERT_KASSERT_HPP_DEVICE_NOINLINE void
+fail_device_assertion(DeviceAssertionSite const& site, ExprT const expr) {
+    DeviceFailingLanes const lanes = device_failing_lanes();
+    if (lanes.leader) {
+        DeviceThreadIndex const index{{blockIdx.x, blockIdx.y, blockIdx.z}, {threadIdx.x, threadIdx.y, threadIdx.z}};
+        record_device_failure(device_failure_buffer, site, expr, lanes.count, index);
+    }
+    #if defined(__HIP_DEVICE_COMPILE__)
+    // the lanes of a wavefront execute in lockstep
+    __threadfence_system();
+    __builtin_trap();
+    #else
+    __syncwarp(static_cast<unsigned>(lanes.mask));
+    __threadfence_system();
+    __trap();
+    #endif
+}
+
+/// @brief Evaluates a device assertion expression. If the assertion fails, calls the failure path
+/// \c fail_device_assertion(). Since this function is always inlined, the inline part of a device assertion is only
+/// the comparison plus a branch.
+/// @tparam ExprT Type of the assertion expression, either \c bool or some \c Expression.
+/// @param site Static metadata of the assertion call site.
+/// @param expr Assertion expression to be checked.
+template <typename ExprT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE __device__ inline void
+evaluate_device_assertion(DeviceAssertionSite const& site, ExprT const expr) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!expression_result(expr))) {
+        fail_device_assertion(site, expr);
+    }
+}
+#endif
+
+/// @brief Writes an operand of a failed device assertion to a logger.
+/// @param out The logger.
+/// @param operand The operand.
+inline void stringify_device_operand(StringLogger& out, DeviceOperand const& operand) {
+    switch (operand.kind) {
+        case DeviceOperandKind::boolean:
+            stringify_value(out, operand.value.boolean);
+            break;
+        case DeviceOperandKind::character:
+            stringify_value(out, operand.value.character);
+            break;
+        case DeviceOperandKind::signed_integer:
+            stringify_value(out, operand.value.signed_integer);
+            break;
+        case DeviceOperandKind::unsigned_integer:
+            stringify_value(out, operand.value.unsigned_integer);
+            break;
+        case DeviceOperandKind::floating_point:
+            stringify_value(out, operand.value.floating_point);
+            break;
+        case DeviceOperandKind::pointer:
+            stringify_value(out, reinterpret_cast<void const*>(operand.value.pointer));
+            break;
+        default:
+            out << "<?>";
+            break;
+    }
+}
+
+/// @brief Formats the report of a failed device assertion, similar to the report of a failed KASSERT().
+/// @param failure The record.
+/// @return The report.
+inline std::string format_device_failure(DeviceFailure const& failure) {
+    StringLogger out;
+    out << failure.file << ": In function '" << failure.function << "':\n"
+        << failure.file << ":" << failure.line << ": FAILED DEVICE ASSERTION\n"
+        << "\t" << failure.expression << "\n";
+    if (failure.operands > 0) {
+        out << "with expansion:\n\t";
+        stringify_device_operand(out, failure.lhs);
+        if (failure.operands > 1) {
+            out << " " << failure.relation << " ";
+            stringify_device_operand(out, failure.rhs);
+        }
+        out << "\n";
+    }
+    if (failure.message[0] != '\0') {
+        out << failure.message << "\n";
+    }
+    out << "in block (" << failure.block[0] << ", " << failure.block[1] << ", " << failure.block[2] << "), thread ("
+        << failure.thread[0] << ", " << failure.thread[1] << ", " << failure.thread[2] << ")";
+    if (failure.failing_lanes > 1) {
+        out << " and " << failure.failing_lanes - 1 << " other lane(s) of its warp";
+    }
+    out << "\n";
+    return std::move(out.str());
+}
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Removes the failed device assertions from the buffer and formats their reports. Must not be called while
+/// kernels may write to the buffer, e.g., after a kernel failed or was synchronized.
+/// @param buffer The failure buffer.
+/// @return The reports of the failed device assertions in the order in which they reserved their records, followed by
+/// a note if failures were dropped because the buffer was full or a record was not completed before the kernel
+/// stopped.
+inline std::vector<std::string> drain_device_failures(DeviceFailureBuffer& buffer) {
+    std::vector<std::string> reports;
+    unsigned long long const tail    = buffer.tail;
+    unsigned long long const head    = internal::device_load(&buffer.head);
+    unsigned long long       dropped = 0;
+    for (unsigned long long position = tail; position != head; ++position) {
+        internal::DeviceFailure const& failure = buffer.records[position % KASSERT_DEVICE_FAILURE_CAPACITY];
+        if (position - tail >= KASSERT_DEVICE_FAILURE_CAPACITY
+            || internal::device_load(&failure.sequence) != position + 1) {
+            ++dropped;
+            continue;
+        }
+        reports.push_back(internal::format_device_failure(failure));
+    }
+    if (dropped > 0) {
+        reports.push_back(
+            std::to_string(dropped) + " failed device assertion(s) were not recorded because the buffer was full\n"
+        );
+    }
+    __atomic_store_n(&buffer.tail, head, __ATOMIC_RELEASE);
+    return reports;
+}
+
+/// @brief Removes the failed device assertions from the buffer and submits their reports to the report sink (see
+/// \c kassert::set_report_sink()), or writes them to the standard error stream.
+/// @param buffer The failure buffer.
+/// @return The number of failed device assertions.
+inline std::size_t report_device_failures(DeviceFailureBuffer& buffer) {
+    unsigned long long const failures = internal::device_load(&buffer.head) - buffer.tail;
+    for (std::string const& report: drain_device_failures(buffer)) {
+        internal::submit_report(internal::standard_error, report.data(), report.size(), ReportSeverity::fatal);
+    }
+    return static_cast<std::size_t>(failures);
+}
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+/// @brief Allocates the failure buffer of the device assertions in mapped, page-locked host memory and installs it for
+/// the device assertions of this program (with relocatable device code) or translation unit (otherwise). Must be
+/// called before launching kernels with device assertions; without a buffer, failed device assertions stop the kernel
+/// without a report.
+/// @return The failure buffer, or \c nullptr if it could not be allocated or installed. Freed by
+/// \c kassert::free_device_failure_buffer().
+KASSERT_KASSERT_HPP_DEVICE_LINKAGE DeviceFailureBuffer* install_device_failure_buffer() {
+    void* host   = nullptr;
+    void* device = nullptr;
+    #if defined(__HIPCC__)
+    if (hipHostMalloc(&host, sizeof(DeviceFailureBuffer), hipHostMallocMapped) != hipSuccess) {
+        return nullptr;
+    }
+    DeviceFailureBuffer* const buffer = new (host) DeviceFailureBuffer{};
+    if (hipHostGetDevicePointer(&device, host, 0) != hipSuccess
+        || hipMemcpyToSymbol(HIP_SYMBOL(internal::device_failure_buffer), &device, sizeof(device)) != hipSuccess) {
+        hipHostFree(host);
+        return nullptr;
+    }
+    #else
+    if (cudaHostAlloc(&host, sizeof(DeviceFailureBuffer), cudaHostAllocMapped) != cudaSuccess) {
+        return nullptr;
+    }
+    DeviceFailureBuffer* const buffer = new (host) DeviceFailureBuffer{};
+    if (cudaHostGetDevicePointer(&device, host, 0) != cudaSuccess
+        || cudaMemcpyToSymbol(internal::device_failure_buffer, &device, sizeof(device)) != cudaSuccess) {
+        cudaFreeHost(host);
+        return nullptr;
+    }
+    #endif
+    return buffer;
+}
+
+/// @brief Frees a failure buffer allocated by \c kassert::install_device_failure_buffer(). No kernel with device
+/// assertions of the same program or translation unit may be launched afterwards.
+/// @param buffer The failure buffer.
+inline void free_device_failure_buffer(DeviceFailureBuffer* buffer) {
+    #if defined(__HIPCC__)
+    hipHostFree(buffer);
+    #else
+    cudaFreeHost(buffer);
+    #endif
+}
+#endif
+} // namespace kassert
+
+/// @brief Assertion macro for CUDA and HIP device code. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT() in host code. In device code, a failed assertion is reported by the first failing lane of
+/// each warp into the failure buffer (see \c kassert::install_device_failure_buffer()), and the kernel is stopped with
+/// a trap. See \c kassert/device.hpp.
+///
+/// The macro accepts 1 to 3 parameters:
+/// 1. The assertion expression (mandatory).
+/// 2. Error message, a string literal (optional). Unlike KASSERT(), the message cannot be built with `<<`.
+/// 3. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_DEVICE(...)              \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_DEVICE_3(__VA_ARGS__),   \
+        KASSERT_DEVICE_2(__VA_ARGS__),   \
+        KASSERT_DEVICE_1(__VA_ARGS__),   \
+        ignore                           \
+    )
+
+/// @cond IMPLEMENTATION
+
+// KASSERT_DEVICE() chooses the right implementation depending on its number of arguments.
+#define KASSERT_DEVICE_3(expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_DEVICE_IMPL("ASSERTION", expression, message, level)
+#define KASSERT_DEVICE_2(expression, message) KASSERT_DEVICE_3(expression, message, kassert::assert::normal)
+#define KASSERT_DEVICE_1(expression)          KASSERT_DEVICE_2(expression, "")
+
+// Implementation of KASSERT_DEVICE(). In device code, the assertion is only enabled by its compile-time level, i.e.,
+// disabled assertions do not generate any code. The call site metadata is only materialized on the failure path.
+#if KASSERT_KASSERT_HPP_DEVICE_COMPILATION
+    #define KASSERT_KASSERT_HPP_KASSERT_DEVICE_IMPL(type, expression, message, level)               \
+        do {                                                                                        \
+            if constexpr (kassert::internal::assertion_enabled(level)) {                            \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                 \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                   \
+                kassert::internal::evaluate_device_assertion(                                       \
+                    kassert::internal::DeviceAssertionSite{                                         \
+                        KASSERT_KASSERT_HPP_SOURCE_LOCATION,                                        \
+                        #expression,                                                                \
+                        message},                                                                   \
+                    kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression) \
+                );                                                                                  \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                  \
+            }                                                                                       \
+        } while (false)
+#else
+    #define KASSERT_KASSERT_HPP_KASSERT_DEVICE_IMPL(type, expression, message, level) \
+        KASSERT_KASSERT_HPP_KASSERT_IMPL(type, expression, message, level)
+#endif
+
+/// @endcond
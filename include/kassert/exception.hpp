@@ -0,0 +1,242 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Exception type and message formatting used by THROWING_KASSERT() and THROWING_KASSERT_SPECIFIED().
+///
+/// Since this header depends on \c std::string, it is not included by \c kassert/core.hpp. Translation units that
+/// only include \c kassert/core.hpp must include this header to use THROWING_KASSERT() or
+/// THROWING_KASSERT_SPECIFIED(); \c kassert/kassert.hpp includes it.
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "kassert/core.hpp"
+
+namespace kassert::internal {
+/// @brief Builds the description for an exception.
+/// @param expression Expression that caused this exception to be thrown.
+/// @param where Source code location where the exception was thrown.
+/// @param message User message describing this exception.
+/// @param expansion The expression with stringified operands, or an empty string if it could not be decomposed.
+/// @return The description of this exception.
+[[maybe_unused]] KASSERT_KASSERT_HPP_INLINE std::string build_what(
+    std::string_view expression, SourceLocation where, std::string_view message, std::string_view expansion = {}
+);
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief The default exception type used together with \c THROWING_KASSERT. Reports the erroneous expression together
+/// with a custom error message.
+///
+/// Exceptions thrown by THROWING_KASSERT() only store the static source code location and expression of the assertion
+/// as well as the formatted user message and operands. The description returned by \c what() is only built on its
+/// first call, i.e., programs that catch these exceptions without printing them do not pay for formatting it.
+class KassertException : public std::exception {
+public:
+    /// @brief Constructs the exception with a complete description.
+    /// @param message The description returned by \c what() and \c message().
+    explicit KassertException(std::string message) : _where{"", 0, ""}, _expression(""), _message(std::move(message)) {}
+
+    /// @brief Constructs the exception of a failed THROWING_KASSERT().
+    /// @param where Source code location of the assertion, must have static storage duration.
+    /// @param expression Stringified assertion expression, must have static storage duration.
+    /// @param message The formatted user message.
+    /// @param expansion The expression with stringified operands, or an empty string if it could not be decomposed.
+    KassertException(
+        internal::SourceLocation const where, char const* expression, std::string message, std::string expansion
+    )
+        : _where(where),
+          _expression(expression),
+          _message(std::move(message)),
+          _expansion(std::move(expansion)),
+          _structured(true) {}
+
+    /// @brief Copies the exception. The description is rebuilt by the copy if needed.
+    /// @param other The exception to copy.
+    KassertException(KassertException const& other)
+        : std::exception(other),
+          _where(other._where),
+          _expression(other._expression),
+          _message(other._message),
+          _expansion(other._expansion),
+          _structured(other._structured) {}
+
+    /// @brief Copies the exception. The description is rebuilt by the copy if needed.
+    /// @param other The exception to copy.
+    /// @return This exception.
+    KassertException& operator=(KassertException const& other) {
+        if (this != &other) {
+            std::exception::operator=(other);
+            _where      = other._where;
+            _expression = other._expression;
+            _message    = other._message;
+            _expansion  = other._expansion;
+            _structured = other._structured;
+            _what.reset(nullptr);
+        }
+        return *this;
+    }
+
+    /// @brief Destroys the exception. This is the key function of the class, i.e., if \c KASSERT_RUNTIME_LIBRARY is
+    /// defined, the vtable and type information are only emitted by the runtime library.
+    KASSERT_KASSERT_HPP_INLINE ~KassertException() override;
+
+    /// @brief Gets a description of this exception. The description is built on the first call, which may be
+    /// executed concurrently by multiple threads.
+    /// @return A description of this exception.
+    [[nodiscard]] KASSERT_KASSERT_HPP_INLINE char const* what() const noexcept final;
+
+    /// @brief Returns the file containing the failed assertion.
+    /// @return The file name, or an empty string if the exception was constructed from a description.
+    [[nodiscard]] char const* file() const noexcept {
+        return _where.file;
+    }
+
+    /// @brief Returns the line of the failed assertion.
+    /// @return The line number, or \c 0 if the exception was constructed from a description.
+    [[nodiscard]] unsigned line() const noexcept {
+        return _where.row;
+    }
+
+    /// @brief Returns the function containing the failed assertion.
+    /// @return The function name, or an empty string if the exception was constructed from a description.
+    [[nodiscard]] char const* function() const noexcept {
+        return _where.function;
+    }
+
+    /// @brief Returns the stringified expression of the failed assertion.
+    /// @return The expression, or an empty string if the exception was constructed from a description.
+    [[nodiscard]] char const* expression() const noexcept {
+        return _expression;
+    }
+
+    /// @brief Returns the user message of the failed assertion.
+    /// @return The user message, or the description if the exception was constructed from a description.
+    [[nodiscard]] std::string const& message() const noexcept {
+        return _message;
+    }
+
+    /// @brief Returns the expression of the failed assertion with stringified operands, e.g., `2 == 3` for the
+    /// expression `1 + 1 == 3`.
+    /// @return The expansion, or an empty string if the expression could not be decomposed.
+    [[nodiscard]] std::string const& expansion() const noexcept {
+        return _expansion;
+    }
+
+private:
+    /// @brief Owning pointer to a lazily built description, which is set at most once.
+    class LazyDescription {
+    public:
+        LazyDescription() = default;
+        LazyDescription(LazyDescription const&)            = delete;
+        LazyDescription& operator=(LazyDescription const&) = delete;
+
+        ~LazyDescription() {
+            reset(nullptr);
+        }
+
+        /// @brief Returns the description.
+        /// @return The description, or \c nullptr if it was not built yet.
+        [[nodiscard]] std::string const* get() const {
+            return _description.load(std::memory_order_acquire);
+        }
+
+        /// @brief Publishes a description unless another thread was faster.
+        /// @param description The description.
+        /// @return The published description.
+        std::string const* publish(std::unique_ptr<std::string const> description) {
+            std::string const* expected = nullptr;
+            if (_description.compare_exchange_strong(expected, description.get(), std::memory_order_acq_rel)) {
+                return description.release();
+            }
+            return expected;
+        }
+
+        /// @brief Replaces the description.
+        /// @param description The new description, or \c nullptr.
+        void reset(std::string const* description) {
+            delete _description.exchange(description, std::memory_order_acq_rel);
+        }
+
+    private:
+        std::atomic<std::string const*> _description{nullptr}; ///< @brief The description, or \c nullptr.
+    };
+
+    internal::SourceLocation _where;              ///< @brief Source code location of the assertion.
+    char const*              _expression;         ///< @brief Stringified assertion expression.
+    std::string              _message;            ///< @brief The user message, or the complete description.
+    std::string              _expansion;          ///< @brief The expression with stringified operands.
+    bool                     _structured = false; ///< @brief Whether \c what() has to be built from the members.
+    mutable LazyDescription  _what;               ///< @brief The description, built by the first call of \c what().
+};
+} // namespace kassert
+
+namespace kassert {
+/// @brief Logger that formats all values into a \c std::string. This logger is used to build the error messages of
+/// exceptions.
+///
+/// Values are formatted in the same way as by \c Logger<internal::FileDescriptor>, but the output is not truncated.
+template <>
+class Logger<std::string> : public internal::NativeFormatter<Logger<std::string>> {
+public:
+    /// @brief Construct an empty logger.
+    Logger() = default;
+
+    /// @brief Returns the formatted output.
+    /// @return The formatted output.
+    std::string& str() {
+        return _out;
+    }
+
+    /// @brief Returns the length of the formatted output.
+    /// @return The number of bytes that were logged.
+    [[nodiscard]] std::size_t size() const {
+        return _out.size();
+    }
+
+private:
+    friend class internal::NativeFormatter<Logger>;
+
+    /// @brief Appends a string to the output.
+    /// @param data The string.
+    /// @param size The length of the string.
+    KASSERT_KASSERT_HPP_INLINE void append(char const* data, std::size_t size);
+
+    std::string _out; ///< @brief The formatted output.
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Logger formatting all output into a \c std::string. This specialization is used to generate the custom
+/// error message for THROWING_KASSERT exceptions.
+using StringLogger = Logger<std::string>;
+
+/// @brief Stringifies the operands of a failed THROWING_KASSERT() expression, e.g., `2 == 3` for the expression
+/// `1 + 1 == 3`. This function is only called on the failure path.
+/// @tparam ExprT Type of the decomposed expression, either \c bool or some \c Expression.
+/// @param expr The failed expression.
+/// @return The expansion of the expression, or an empty string if it could not be decomposed.
+template <typename ExprT>
+std::string stringify_expansion(ExprT const& expr) {
+    if constexpr (std::is_same_v<ExprT, bool>) {
+        return {};
+    } else {
+        StringLogger logger;
+        logger << expr;
+        return std::move(logger.str());
+    }
+}
+} // namespace kassert::internal
+
+#ifndef KASSERT_RUNTIME_LIBRARY
+    #include "kassert/internal/exception_impl.hpp"
+#endif
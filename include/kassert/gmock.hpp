@@ -0,0 +1,49 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief GoogleMock matchers that check failed assertions in-process instead of using death tests.
+///
+/// \code
+/// EXPECT_THAT([&] { KASSERT(lhs == rhs); }, kassert::testing::FailsAssertion(HasSubstr("2 == 3")));
+/// EXPECT_THAT([&] { KASSERT(lhs != rhs); }, Not(kassert::testing::FailsAssertion()));
+/// \endcode
+///
+/// The matchers install \c kassert::testing::ThrowOnFailure while calling the function, see \c kassert/testing.hpp.
+/// The including project must provide GoogleMock.
+
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include "kassert/testing.hpp"
+
+namespace kassert::testing {
+/// @brief Matches a function that fails a fatal assertion when called without arguments, and whose report matches
+/// \c report_matcher. The report contains the location, the expression, its expansion and the user message of the
+/// failed assertion.
+MATCHER_P(
+    FailsAssertion,
+    report_matcher,
+    std::string(negation ? "does not fail an assertion whose report " : "fails an assertion whose report ")
+        + ::testing::DescribeMatcher<std::string const&>(report_matcher)
+) {
+    std::optional<std::string> const report = failure_report(arg);
+    if (!report) {
+        *result_listener << "which does not fail an assertion";
+        return false;
+    }
+    *result_listener << "which fails an assertion with report\n" << *report;
+    return ::testing::ExplainMatchResult(report_matcher, *report, result_listener);
+}
+
+/// @brief Matches a function that fails a fatal assertion when called without arguments.
+/// @return The matcher.
+inline auto FailsAssertion() {
+    return FailsAssertion(::testing::A<std::string const&>());
+}
+} // namespace kassert::testing
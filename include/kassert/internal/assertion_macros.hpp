@@ -36,33 +36,291 @@
     #define KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES
 #endif
 
+// Compiler hints used to keep the inline part of an assertion as small as possible: the failure path is moved into
+// functions marked as cold and non-inlinable, whereas the helper that evaluates the assertion is always inlined (even
+// at -O0). On compilers that do not support these hints, the macros expand to nothing.
+#if defined(__GNUC__) || defined(__clang__) // GCC or Clang
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_COLD          [[gnu::cold]] [[gnu::noinline]]
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE [[gnu::always_inline]]
+    #define KASSERT_KASSERT_HPP_UNLIKELY(expression)    __builtin_expect(!!(expression), 0)
+#else // Other compilers -> no hints supported
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_COLD
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE
+    #define KASSERT_KASSERT_HPP_UNLIKELY(expression) (expression)
+#endif
+
+// Detects constant evaluation, such that assertions in constexpr functions skip the parts that can only be evaluated
+// at runtime, and that failed assertions are reported as compile-time errors. Requires GCC >= 9, Clang >= 9 or MSVC
+// >= 19.25; otherwise, this is always false, i.e., such assertions cannot be combined with the runtime assertion level.
+#if defined(__has_builtin)
+    #if __has_builtin(__builtin_is_constant_evaluated)
+        #define KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+    #endif
+#endif
+#if !defined(KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED) \
+    && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+    #define KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#elif !defined(KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED)
+    #define KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED() false
+#endif
+
+// If KASSERT_RUNTIME_ASSERTION_LEVEL is defined, assertions that are enabled at compile time are additionally gated by
+// the runtime assertion level (see kassert::set_assertion_level()). This costs one relaxed load and one comparison per
+// assertion. Otherwise, the runtime check is a constant and optimized away. During constant evaluation, the runtime
+// assertion level is not available, thus all assertions that are enabled at compile time are checked.
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+    #define KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level) \
+        (KASSERT_KASSERT_HPP_IS_CONSTANT_EVALUATED() || kassert::internal::runtime_assertion_enabled(level))
+#else
+    #define KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level) true
+#endif
+
 // This is the actual implementation of the KASSERT() macro.
 //
 // - Note that expanding the macro into a `do { ... } while(false)` pseudo-loop is a common trick to make a macro
 //   "act like a statement". Otherwise, it would have surprising effects if the macro is used inside a `if` branch
 //   without braces.
-// - If the assertion level is disabled, this should not generate any code (assuming that the compiler removes the
-//   dead loop).
-// - `evaluate_and_print_assertion` evaluates the assertion and prints an error message if it failed.
-// - The call to `std::abort()` is not wrapped in a function to keep the stack trace clean.
-#define KASSERT_KASSERT_HPP_KASSERT_IMPL(type, expression, message, level)                           \
+// - If the assertion level is disabled, this does not generate any code (assuming that the compiler removes the dead
+//   loop; this is checked by the codegen regression test in tests/codegen). Otherwise, the assertion is only
+//   evaluated if it is also enabled at runtime (see above).
+// - `evaluate_assertion` is always inlined and only checks the result of the expression. If the assertion failed, it
+//   calls the cold (and non-inlined) `fail_assertion`, which prints the error message and calls `std::abort()`. Thus,
+//   the inline part of each assertion is only a comparison plus a branch.
+// - The message is wrapped in a lambda such that it is only formatted if the assertion failed.
+#define KASSERT_KASSERT_HPP_KASSERT_IMPL(type, expression, message, level)                    \
+    do {                                                                                      \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                          \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                       \
+                KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level) \
+            }                                                                                 \
+        }                                                                                     \
+    } while (false)
+
+// Callable that writes the user message of an assertion of level `level` to a FdLogger on the failure path. The level
+// is recorded such that JSON records (see kassert::ReportFormat::json) can report it.
+#define KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level) \
+    [&](kassert::internal::FdLogger& kassert_logger) {     \
+        kassert_logger.set_level(level);                   \
+        kassert_logger << message;                         \
+    }
+
+// Decomposes, evaluates and (if it fails) reports the assertion. Shared by all variants of the KASSERT() macro. Expands
+// to a complete statement.
+#define KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level)        \
+    {                                                                                        \
+        KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_site, type, #expression)           \
+        KASSERT_KASSERT_HPP_INSTRUMENT_ASSERTION(kassert_site, level)                        \
+        KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                  \
+        KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                    \
+        kassert::internal::evaluate_assertion(                                               \
+            KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_site, type, #expression),   \
+            kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression), \
+            KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level)                               \
+        );                                                                                   \
+        KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                   \
+    }
+
+// Defines the static metadata of an assertion call site as a variable `name` of type AssertionSite and selects how it
+// is passed to the failure path.
+//
+// - If KASSERT_COMPACT_CALL_SITES is defined, the metadata is a `static constexpr` record, i.e., it is emitted once
+//   into read-only data and the call site only passes its address to the failure path. Since C++17 does not allow
+//   static variables in constexpr functions, such assertions cannot be used in constexpr functions.
+// - If KASSERT_STRIP_FUNCTION_NAMES is additionally defined, the template arguments are stripped from the function
+//   name during constant evaluation, i.e., only the stripped name is emitted into the binary.
+// - Otherwise, the metadata is a local constant that is only used by THROWING_KASSERT() and the instrumentation, and
+//   KASSERT() passes the type, location and expression as separate arguments, which the compiler propagates into the
+//   (single) caller of the failure path.
+//
+// The initializers are parenthesized such that assertions can be passed to other macros.
+#if defined(KASSERT_COMPACT_CALL_SITES)
+    #define KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(name, type, expr_str) &name
+#else
+    #define KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(name, type, expr_str) \
+        type, KASSERT_KASSERT_HPP_SOURCE_LOCATION, expr_str
+#endif
+
+#if defined(KASSERT_COMPACT_CALL_SITES) && defined(KASSERT_STRIP_FUNCTION_NAMES) \
+    && (defined(__GNUC__) || defined(__clang__))
+    #define KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(name, type, expr_str)                                    \
+        static constexpr std::size_t name##_function_length =                                                  \
+            kassert::internal::function_name_length(KASSERT_KASSERT_HPP_FUNCTION_NAME);                        \
+        static constexpr kassert::internal::FunctionName<name##_function_length> name##_function =             \
+            kassert::internal::strip_function_name<name##_function_length>(KASSERT_KASSERT_HPP_FUNCTION_NAME); \
+        [[maybe_unused]] static constexpr kassert::internal::AssertionSite name =                              \
+            (kassert::internal::AssertionSite{type, expr_str, {__FILE__, __LINE__, name##_function.data}});
+#elif defined(KASSERT_COMPACT_CALL_SITES)
+    #define KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(name, type, expr_str)       \
+        [[maybe_unused]] static constexpr kassert::internal::AssertionSite name = \
+            (kassert::internal::AssertionSite{type, expr_str, KASSERT_KASSERT_HPP_SOURCE_LOCATION});
+#else
+    #define KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(name, type, expr_str) \
+        [[maybe_unused]] kassert::internal::AssertionSite const name =      \
+            (kassert::internal::AssertionSite{type, expr_str, KASSERT_KASSERT_HPP_SOURCE_LOCATION});
+#endif
+
+// If KASSERT_INSTRUMENTATION is defined, each call site registers itself in the instrumentation registry the first time
+// it is evaluated (guarded function-local static) and counts its evaluations in thread-local counters. The scope object
+// optionally times the evaluation. Otherwise, this expands to nothing.
+//
+// KASSERT_WITH_COST() registers the call site before its cost budget is checked, such that skipped evaluations can be
+// counted. Thus, registering the call site (KASSERT_KASSERT_HPP_REGISTER_ASSERTION_SITE), counting an evaluation
+// (KASSERT_KASSERT_HPP_INSTRUMENTATION_SCOPE) and counting a skipped evaluation
+// (KASSERT_KASSERT_HPP_COUNT_SKIPPED_EVALUATION) are also available separately.
+#ifdef KASSERT_INSTRUMENTATION
+    #define KASSERT_KASSERT_HPP_REGISTER_ASSERTION_SITE(site, level) \
+        static std::size_t const kassert_site_id =                   \
+            kassert::internal::instrumentation_registry().register_site(site.location, site.expression, level);
+    #define KASSERT_KASSERT_HPP_INSTRUMENTATION_SCOPE() \
+        kassert::internal::InstrumentationScope const kassert_instrumentation_scope(kassert_site_id);
+    #define KASSERT_KASSERT_HPP_COUNT_SKIPPED_EVALUATION() kassert::internal::count_skipped_evaluation(kassert_site_id);
+#else
+    #define KASSERT_KASSERT_HPP_REGISTER_ASSERTION_SITE(site, level)
+    #define KASSERT_KASSERT_HPP_INSTRUMENTATION_SCOPE()
+    #define KASSERT_KASSERT_HPP_COUNT_SKIPPED_EVALUATION()
+#endif
+#define KASSERT_KASSERT_HPP_INSTRUMENT_ASSERTION(site, level) \
+    KASSERT_KASSERT_HPP_REGISTER_ASSERTION_SITE(site, level) KASSERT_KASSERT_HPP_INSTRUMENTATION_SCOPE()
+
+// Implementation of KASSERT_WARN(). Same as KASSERT(), but the failure path does not abort. The `static thread_local`
+// rate limiter is local to the call site (see KASSERT_SAMPLED() below) and only accessed on the failure path.
+#define KASSERT_KASSERT_HPP_KASSERT_WARN_IMPL(type, expression, message, level)                      \
     do {                                                                                             \
         if constexpr (kassert::internal::assertion_enabled(level)) {                                 \
-            KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                      \
-            KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                        \
-            if (!kassert::internal::evaluate_and_print_assertion(                                    \
-                    type,                                                                            \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                              \
+                KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_site, type, #expression)           \
+                KASSERT_KASSERT_HPP_INSTRUMENT_ASSERTION(kassert_site, level)                        \
+                static thread_local kassert::internal::WarningLimiter kassert_limiter;               \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                  \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                    \
+                kassert::internal::evaluate_warning(                                                 \
+                    kassert_limiter,                                                                 \
+                    KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_site, type, #expression),   \
                     kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression), \
-                    KASSERT_KASSERT_HPP_SOURCE_LOCATION,                                             \
-                    #expression                                                                      \
-                )) {                                                                                 \
-                kassert::Logger<std::ostream&>(std::cerr) << message << "\n";                        \
-                std::abort();                                                                        \
+                    KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level)                               \
+                );                                                                                   \
+                KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                   \
             }                                                                                        \
-            KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                       \
         }                                                                                            \
     } while (false)
 
+// Whether an expression is a constant, e.g., a literal, such that invalid macro arguments can be rejected at compile
+// time if they are known. Always false on compilers without __builtin_constant_p(), which does not evaluate the
+// expression.
+#if defined(__GNUC__) || defined(__clang__)
+    #define KASSERT_KASSERT_HPP_IS_CONSTANT(expression) __builtin_constant_p(expression)
+#else
+    #define KASSERT_KASSERT_HPP_IS_CONSTANT(expression) false
+#endif
+
+// Implementation of KASSERT_SAMPLED() and KASSERT_SAMPLED_RANDOMIZED().
+//
+// - Constant sampling rates outside of [1, kassert::internal::max_sampling_rate] do not compile, also if the assertion
+//   is disabled. Other rates are clamped to this range by the sampler (see kassert::internal::clamp_sampling_rate()).
+// - The `static thread_local` sampler is local to the call site (and to each instantiation of the enclosing template,
+//   if any). It is trivial and zero-initialized, thus accessing it requires no initialization guard.
+// - The sampler is only consulted if the assertion is enabled, i.e., disabled sampled assertions generate no code.
+#define KASSERT_KASSERT_HPP_KASSERT_SAMPLED_IMPL(sampler_type, type, expression, message, level, rate) \
+    do {                                                                                               \
+        static_assert(                                                                                 \
+            !KASSERT_KASSERT_HPP_IS_CONSTANT(rate) || kassert::internal::valid_sampling_rate(rate),    \
+            "the sampling rate must be in [1, 2^31]"                                                   \
+        );                                                                                             \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                                   \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                                \
+                static thread_local sampler_type kassert_sampler;                                      \
+                if (kassert_sampler.sample(rate)) {                                                    \
+                    KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level)      \
+                }                                                                                      \
+            }                                                                                          \
+        }                                                                                              \
+    } while (false)
+
+// Implementation of KASSERT_WITH_COST().
+//
+// - The problem size is only evaluated if the assertion is enabled at compile time and at runtime, and the expression
+//   is only evaluated if its estimated cost is within the cost budget of its level (see cost_budget.hpp).
+// - In contrast to KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL, the call site is registered with the instrumentation
+//   before the budget is checked, such that evaluations that are skipped are attributed to the same call site.
+#define KASSERT_KASSERT_HPP_KASSERT_WITH_COST_IMPL(type, expression, message, level, complexity, size)            \
+    do {                                                                                                          \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                                              \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                                           \
+                KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_site, type, #expression)                        \
+                KASSERT_KASSERT_HPP_REGISTER_ASSERTION_SITE(kassert_site, level)                                  \
+                if (kassert::internal::within_cost_budget(level, complexity, static_cast<std::uint64_t>(size))) { \
+                    KASSERT_KASSERT_HPP_INSTRUMENTATION_SCOPE()                                                   \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                           \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                             \
+                    kassert::internal::evaluate_assertion(                                                        \
+                        KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_site, type, #expression),            \
+                        kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression),          \
+                        KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level)                                        \
+                    );                                                                                            \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                            \
+                } else {                                                                                          \
+                    KASSERT_KASSERT_HPP_COUNT_SKIPPED_EVALUATION()                                                \
+                }                                                                                                 \
+            }                                                                                                     \
+        }                                                                                                         \
+    } while (false)
+
+// Lowers an expression to an optimizer hint, i.e., the compiler may assume that the expression evaluates to true.
+// - C++23 / GCC >= 13: [[assume(expression)]], which does not evaluate the expression.
+// - Clang: __builtin_assume(expression), which does not evaluate the expression.
+// - MSVC: __assume(expression), which does not evaluate the expression.
+// - Older GCC: `if (!(expression)) __builtin_unreachable()`. The expression is evaluated unless the compiler can prove
+//   that it has no side effects, in which case the evaluation is optimized away. Thus, KASSERT_ASSUME() must only be
+//   used with side-effect-free expressions, and expressions that call functions the compiler cannot see into may cost
+//   as much as an enabled assertion.
+// - Other compilers: no hint, the expression is not evaluated.
+#if defined(__has_cpp_attribute)
+    #if __has_cpp_attribute(assume)
+        #define KASSERT_KASSERT_HPP_HAS_ASSUME_ATTRIBUTE
+    #endif
+#endif
+#if defined(KASSERT_KASSERT_HPP_HAS_ASSUME_ATTRIBUTE)
+    #define KASSERT_KASSERT_HPP_ASSUME(expression) [[assume(expression)]]
+#elif defined(__clang__)
+    #define KASSERT_KASSERT_HPP_ASSUME(expression) __builtin_assume(expression)
+#elif defined(_MSC_VER)
+    #define KASSERT_KASSERT_HPP_ASSUME(expression) __assume(expression)
+#elif defined(__GNUC__)
+    #define KASSERT_KASSERT_HPP_ASSUME(expression) \
+        if (!(expression)) {                       \
+            __builtin_unreachable();               \
+        }
+#else
+    #define KASSERT_KASSERT_HPP_ASSUME(expression)
+#endif
+
+// Implementation of KASSERT_ASSUME(): if the assertion is enabled at compile time, it behaves like KASSERT().
+// Otherwise, the expression is lowered to an optimizer hint (see above). Assertions that are enabled at compile time
+// but disabled at runtime are neither checked nor assumed.
+#define KASSERT_KASSERT_HPP_KASSERT_ASSUME_IMPL(type, expression, message, level)             \
+    do {                                                                                      \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                          \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                       \
+                KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level) \
+            }                                                                                 \
+        } else {                                                                              \
+            KASSERT_KASSERT_HPP_ASSUME(expression);                                           \
+        }                                                                                     \
+    } while (false)
+
+// Implementation of KASSERT_IN_CATEGORY(): behaves like KASSERT(), but the compile-time check uses the level of the
+// category (see kassert::internal::category_assertion_enabled()), i.e., assertions of disabled categories do not
+// generate any code. The runtime assertion level gates all levels of the category alike, including levels above
+// KASSERT_ASSERTION_LEVEL, such that lowering it never disables cheaper assertions while keeping more expensive ones.
+#define KASSERT_KASSERT_HPP_KASSERT_IN_CATEGORY_IMPL(category, type, expression, message, level) \
+    do {                                                                                         \
+        if constexpr (kassert::internal::category_assertion_enabled(#category, level)) {         \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                          \
+                KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level)    \
+            }                                                                                    \
+        }                                                                                        \
+    } while (false)
+
 // Expands a macro depending on its number of arguments. For instance,
 //
 // #define FOO(...) KASSERT_KASSERT_HPP_VARARG_HELPER_3(, __VA_ARGS__, IMPL3, IMPL2, IMPL1, dummy)
@@ -78,50 +336,104 @@
 #define KASSERT_2(expression, message)        KASSERT_3(expression, message, kassert::assert::normal)
 #define KASSERT_1(expression)                 KASSERT_2(expression, "")
 
+// KASSERT_WARN() chooses the right implementation depending on its number of arguments.
+#define KASSERT_WARN_3(expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_WARN_IMPL("WARNING", expression, message, level)
+#define KASSERT_WARN_2(expression, message) KASSERT_WARN_3(expression, message, kassert::assert::normal)
+#define KASSERT_WARN_1(expression)          KASSERT_WARN_2(expression, "")
+
+// KASSERT_ASSUME() chooses the right implementation depending on its number of arguments.
+#define KASSERT_ASSUME_3(expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_ASSUME_IMPL("ASSERTION", expression, message, level)
+#define KASSERT_ASSUME_2(expression, message) KASSERT_ASSUME_3(expression, message, kassert::assert::normal)
+#define KASSERT_ASSUME_1(expression)          KASSERT_ASSUME_2(expression, "")
+
+// KASSERT_IN_CATEGORY() chooses the right implementation depending on its number of arguments (after the category).
+#define KASSERT_IN_CATEGORY_3(category, expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_IN_CATEGORY_IMPL(category, "ASSERTION [" #category "]", expression, message, level)
+#define KASSERT_IN_CATEGORY_2(category, expression, message) \
+    KASSERT_IN_CATEGORY_3(category, expression, message, kassert::assert::normal)
+#define KASSERT_IN_CATEGORY_1(category, expression) KASSERT_IN_CATEGORY_2(category, expression, "")
+
 // Implementation of the THROWING_KASSERT() macro.
-// In KASSERT_EXCEPTION_MODE, we throw an exception similar to the implementation of KASSERT(), although expression
-// decomposition in exceptions is currently unsupported. Otherwise, the macro delegates to KASSERT().
+// In KASSERT_EXCEPTION_MODE, we throw an exception similar to the implementation of KASSERT(): the expression is
+// decomposed and the exception factory receives the decomposed expression as `kassert_expr`, such that it can report
+// the values of the operands. Otherwise, the macro behaves like an assertion of level kassert::assert::kthrow.
+//
+// In both cases, the exception object (and thus, the user message and the expansion) is only constructed by the cold
+// handlers `throw_exception` and `fail_throwing_assertion` if the expression evaluates to false. The call site
+// metadata is defined outside of the lambda that constructs the exception, such that it names the function containing
+// the assertion rather than the lambda, and passed to the lambda as `kassert_site` on the failure path.
 #ifdef KASSERT_EXCEPTION_MODE
-    #define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(expression, exception_type, message, ...) \
-        do {                                                                                             \
-            if (!(expression)) {                                                                         \
-                throw exception_type(message, ##__VA_ARGS__);                                            \
-            }                                                                                            \
+    #define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(expression, exception_type, message, ...)      \
+        do {                                                                                                  \
+            KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_call_site, #exception_type, #expression)        \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                               \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                                 \
+            kassert::internal::evaluate_throwing_assertion(                                                   \
+                kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression),              \
+                [&](kassert::internal::AssertionSite const& kassert_site,                                     \
+                    [[maybe_unused]] auto const& kassert_expr) {                                              \
+                    return exception_type(message, ##__VA_ARGS__);                                            \
+                },                                                                                            \
+                KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_call_site, #exception_type, #expression) \
+            );                                                                                                \
+            KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                                \
         } while (false)
 #else
-    #define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(expression, exception_type, message, ...) \
-        do {                                                                                             \
-            if constexpr (kassert::internal::assertion_enabled(kassert::assert::kthrow)) {               \
-                if (!(expression)) {                                                                     \
-                    kassert::Logger<std::ostream&>(std::cerr)                                            \
-                        << (exception_type(message, ##__VA_ARGS__).what()) << "\n";                      \
-                    std::abort();                                                                        \
-                }                                                                                        \
-            }                                                                                            \
+    #define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(expression, exception_type, message, ...)              \
+        do {                                                                                                          \
+            if constexpr (kassert::internal::assertion_enabled(kassert::assert::kthrow)) {                            \
+                if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(kassert::assert::kthrow)) {                         \
+                    KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_call_site, #exception_type, #expression)        \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_PUSH                                                               \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_IGNORE_PARENTHESES                                                 \
+                    kassert::internal::evaluate_fatal_throwing_assertion(                                             \
+                        kassert::internal::finalize_expr(kassert::internal::Decomposer{} <= expression),              \
+                        [&](kassert::internal::AssertionSite const& kassert_site,                                     \
+                            [[maybe_unused]] auto const& kassert_expr) {                                              \
+                            return exception_type(message, ##__VA_ARGS__);                                            \
+                        },                                                                                            \
+                        KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_call_site, #exception_type, #expression) \
+                    );                                                                                                \
+                    KASSERT_KASSERT_HPP_DIAGNOSTIC_POP                                                                \
+                }                                                                                                     \
+            }                                                                                                         \
         } while (false)
 #endif
 
-#define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL(expression, message)                                   \
-    KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(                                                  \
-        expression,                                                                                      \
-        kassert::KassertException,                                                                       \
-        kassert::internal::build_what(                                                                   \
-            #expression,                                                                                 \
-            KASSERT_KASSERT_HPP_SOURCE_LOCATION,                                                         \
-            (kassert::internal::RrefOStringstreamLogger{std::ostringstream{}} << message).stream().str() \
-        )                                                                                                \
+// Formats the user message of a THROWING_KASSERT() into a std::string (see kassert/exception.hpp). The logger is a
+// named object such that the message may start with a value that is stringified by a free << operator.
+#define KASSERT_KASSERT_HPP_STRINGIFY_MESSAGE(message)  \
+    [&] {                                               \
+        kassert::internal::StringLogger kassert_logger; \
+        kassert_logger << message;                      \
+        return std::move(kassert_logger.str());         \
+    }()
+
+// THROWING_KASSERT() throws a KassertException that stores the static location and expression of the call site, and
+// only formats the user message and the expansion of the expression. Its description is built lazily by what().
+#define KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL(expression, message) \
+    KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(                \
+        expression,                                                    \
+        kassert::KassertException,                                     \
+        kassert_site.location,                                         \
+        #expression,                                                   \
+        KASSERT_KASSERT_HPP_STRINGIFY_MESSAGE(message),                \
+        kassert::internal::stringify_expansion(kassert_expr)           \
     )
 
-#define KASSERT_KASSERT_HPP_THROWING_KASSERT_CUSTOM_IMPL(expression, exception_type, message, ...)       \
-    KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(                                                  \
-        expression,                                                                                      \
-        exception_type,                                                                                  \
-        kassert::internal::build_what(                                                                   \
-            #expression,                                                                                 \
-            KASSERT_KASSERT_HPP_SOURCE_LOCATION,                                                         \
-            (kassert::internal::RrefOStringstreamLogger{std::ostringstream{}} << message).stream().str() \
-        ),                                                                                               \
-        ##__VA_ARGS__                                                                                    \
+#define KASSERT_KASSERT_HPP_THROWING_KASSERT_CUSTOM_IMPL(expression, exception_type, message, ...) \
+    KASSERT_KASSERT_HPP_THROWING_KASSERT_IMPL_INTERNAL(                                            \
+        expression,                                                                                \
+        exception_type,                                                                            \
+        kassert::internal::build_what(                                                             \
+            #expression,                                                                           \
+            kassert_site.location,                                                                 \
+            KASSERT_KASSERT_HPP_STRINGIFY_MESSAGE(message),                                        \
+            kassert::internal::stringify_expansion(kassert_expr)                                   \
+        ),                                                                                         \
+        ##__VA_ARGS__                                                                              \
     )
 
 // THROWING_KASSERT() chooses the right implementation depending on its number of arguments.
@@ -0,0 +1,82 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Static description of an assertion call site.
+
+#pragma once
+
+#include <cstddef>
+
+#include "kassert/internal/source_location.hpp"
+
+namespace kassert::internal {
+/// @brief Static metadata of an assertion call site, which is passed to the failure path of the assertion.
+///
+/// If \c KASSERT_COMPACT_CALL_SITES is defined, each call site emits its metadata once as a constant record and only
+/// passes a pointer to this record to the failure path. Otherwise, the record is constructed on the failure path.
+struct AssertionSite {
+    /// @brief Type of the check, e.g., \c ASSERTION or the name of the exception type for THROWING_KASSERT().
+    char const* type;
+    /// @brief Stringified assertion expression.
+    char const* expression;
+    /// @brief Source code location of the assertion.
+    SourceLocation location;
+};
+
+/// @brief Constructs the metadata of a call site on the failure path from the arguments produced by
+/// \c KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS if \c KASSERT_COMPACT_CALL_SITES is not defined.
+/// @param type Type of the check.
+/// @param where Source code location of the assertion.
+/// @param expression Stringified assertion expression.
+/// @return The metadata of the call site.
+constexpr AssertionSite make_assertion_site(char const* type, SourceLocation const where, char const* expression) {
+    return AssertionSite{type, expression, where};
+}
+
+/// @brief Returns the metadata of a call site from the argument produced by
+/// \c KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS if \c KASSERT_COMPACT_CALL_SITES is defined.
+/// @param site Static metadata of the call site.
+/// @return The metadata of the call site.
+constexpr AssertionSite make_assertion_site(AssertionSite const* site) {
+    return *site;
+}
+
+/// @brief Returns the length of a function name as produced by \c __PRETTY_FUNCTION__, ignoring the list of template
+/// arguments that GCC (` [with T = ...]`) and Clang (` [T = ...]`) append to the names of template instantiations.
+/// @param name The function name.
+/// @return The length of the function name without template arguments.
+constexpr std::size_t function_name_length(char const* name) {
+    std::size_t length = 0;
+    while (name[length] != '\0' && !(name[length] == ' ' && name[length + 1] == '[')) {
+        ++length;
+    }
+    return length;
+}
+
+/// @brief A function name with a fixed length, stored in a constant.
+/// @tparam length Length of the function name, excluding the null terminator.
+template <std::size_t length>
+struct FunctionName {
+    /// @brief The null-terminated function name.
+    char data[length + 1];
+};
+
+/// @brief Copies the first \c length characters of a function name, i.e., strips the list of template arguments if
+/// \c length is obtained from \c function_name_length().
+///
+/// If the result initializes a \c constexpr variable, the full function name is only used during constant evaluation
+/// and thus not emitted into the binary.
+/// @tparam length Length of the stripped function name.
+/// @param name The function name.
+/// @return The stripped function name.
+template <std::size_t length>
+constexpr FunctionName<length> strip_function_name(char const* name) {
+    FunctionName<length> stripped{};
+    for (std::size_t i = 0; i < length; ++i) {
+        stripped.data[i] = name[i];
+    }
+    return stripped;
+}
+} // namespace kassert::internal
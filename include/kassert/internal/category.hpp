@@ -0,0 +1,77 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Compile-time assertion levels of assertion categories, used to implement KASSERT_IN_CATEGORY().
+
+#pragma once
+
+#ifndef KASSERT_CATEGORY_LEVELS
+    /// @brief Compile-time assertion levels of assertion categories as a comma-separated list of `category=level`
+    /// entries, e.g., `"comm=20,untrusted=40"`. Set by the CMake function \c kassert_set_category_level(). Categories
+    /// without an entry use \c KASSERT_ASSERTION_LEVEL; if a category has multiple entries, the last one is used.
+    #define KASSERT_CATEGORY_LEVELS ""
+#endif
+
+namespace kassert::internal {
+/// @brief Called by \c category_level() if \c KASSERT_CATEGORY_LEVELS is malformed. Since this function is not
+/// \c constexpr, this turns a malformed list into a compile-time error.
+inline void kassert_category_levels_are_malformed() {}
+
+/// @brief Checks if a category name equals the name of an entry of \c KASSERT_CATEGORY_LEVELS.
+/// @param category The null-terminated category name.
+/// @param begin The begin of the name of the entry.
+/// @param end The end of the name of the entry.
+/// @return Whether the names are equal.
+constexpr bool category_name_equals(char const* category, char const* begin, char const* const end) {
+    for (; begin != end; ++begin, ++category) {
+        if (*category != *begin) {
+            return false;
+        }
+    }
+    return *category == '\0';
+}
+
+/// @brief Looks up the compile-time assertion level of a category.
+/// @param category The name of the category.
+/// @param levels Comma-separated list of `category=level` entries.
+/// @param default_level Level of categories without an entry.
+/// @return The level of the last entry of the category, or \c default_level if there is none.
+constexpr int category_level(char const* const category, char const* const levels, int const default_level) {
+    int         result = default_level;
+    char const* entry  = levels;
+    while (*entry != '\0') {
+        char const* name_end = entry;
+        while (*name_end != '=' && *name_end != ',' && *name_end != '\0') {
+            ++name_end;
+        }
+        if (name_end == entry || *name_end != '=') {
+            kassert_category_levels_are_malformed();
+            return default_level;
+        }
+
+        char const* digits   = name_end + 1;
+        bool const  negative = *digits == '-';
+        if (negative) {
+            ++digits;
+        }
+        char const* digits_end = digits;
+        int         level      = 0;
+        while (*digits_end >= '0' && *digits_end <= '9') {
+            level = 10 * level + (*digits_end - '0');
+            ++digits_end;
+        }
+        if (digits_end == digits || (*digits_end != ',' && *digits_end != '\0')) {
+            kassert_category_levels_are_malformed();
+            return default_level;
+        }
+
+        if (category_name_equals(category, entry, name_end)) {
+            result = negative ? -level : level;
+        }
+        entry = *digits_end == ',' ? digits_end + 1 : digits_end;
+    }
+    return result;
+}
+} // namespace kassert::internal
@@ -0,0 +1,490 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Definitions of the non-template functions declared in \c kassert/core.hpp and
+/// \c kassert/internal/logger.hpp.
+///
+/// This header is included at the end of \c kassert/core.hpp unless \c KASSERT_RUNTIME_LIBRARY is defined, in which
+/// case it is compiled into the runtime library.
+
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if __has_include(<unistd.h>)
+    #include <time.h>
+    #include <unistd.h>
+    /// @brief Whether POSIX `write(2)` is available.
+    #define KASSERT_KASSERT_HPP_HAS_UNISTD 1
+#else
+    #include <thread>
+    /// @brief Whether POSIX `write(2)` is available.
+    #define KASSERT_KASSERT_HPP_HAS_UNISTD 0
+#endif
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+#else
+    #include <atomic>
+#endif
+
+#include "kassert/core.hpp"
+
+namespace kassert::internal {
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, long long const value) {
+    auto const result = std::to_chars(buffer, buffer + number_buffer_size, value);
+    return static_cast<std::size_t>(result.ptr - buffer);
+}
+
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, unsigned long long const value, int const base) {
+    auto const result = std::to_chars(buffer, buffer + number_buffer_size, value, base);
+    return static_cast<std::size_t>(result.ptr - buffer);
+}
+
+/// @brief Formats a floating point number using the shortest representation that round-trips.
+/// @tparam FloatT The floating point type.
+/// @param buffer Output buffer of size \c number_buffer_size.
+/// @param value The floating point number.
+/// @return The number of characters written.
+template <typename FloatT>
+std::size_t format_floating_point(char* buffer, FloatT const value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto const result = std::to_chars(buffer, buffer + number_buffer_size, value);
+    return result.ec == std::errc{} ? static_cast<std::size_t>(result.ptr - buffer) : 0;
+#else
+    int const length = std::snprintf(
+        buffer,
+        number_buffer_size,
+        "%.*Lg",
+        std::numeric_limits<FloatT>::max_digits10,
+        static_cast<long double>(value)
+    );
+    return length > 0 ? static_cast<std::size_t>(length) : 0;
+#endif
+}
+
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, float const value) {
+    return format_floating_point(buffer, value);
+}
+
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, double const value) {
+    return format_floating_point(buffer, value);
+}
+
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, long double const value) {
+    return format_floating_point(buffer, value);
+}
+
+/// @brief Returns the length of the well-formed UTF-8 sequence at the start of a string, i.e., of a sequence that
+/// encodes a single code point (excluding surrogates) with the least number of bytes.
+/// @param data The string, which starts with a byte of at least \c 0x80.
+/// @param size The length of the string.
+/// @return The length of the sequence, or \c 0 if the string does not start with a well-formed sequence.
+KASSERT_KASSERT_HPP_INLINE std::size_t utf8_sequence_length(char const* data, std::size_t const size) {
+    auto const  lead   = static_cast<unsigned char>(data[0]);
+    std::size_t length = 0;
+    // range of the second byte, which excludes overlong encodings, surrogates and code points above U+10FFFF
+    unsigned char min = 0x80;
+    unsigned char max = 0xbf;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        length = 2;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        length = 3;
+        min    = lead == 0xe0 ? 0xa0 : min;
+        max    = lead == 0xed ? 0x9f : max;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        length = 4;
+        min    = lead == 0xf0 ? 0x90 : min;
+        max    = lead == 0xf4 ? 0x8f : max;
+    }
+    if (length == 0 || length > size) {
+        return 0;
+    }
+    for (std::size_t i = 1; i < length; ++i) {
+        auto const continuation = static_cast<unsigned char>(data[i]);
+        if (continuation < (i == 1 ? min : 0x80) || continuation > (i == 1 ? max : 0xbf)) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+KASSERT_KASSERT_HPP_INLINE void write_to(FileDescriptor const out, char const* data, std::size_t size) {
+#if KASSERT_KASSERT_HPP_HAS_UNISTD
+    while (size > 0) {
+        auto const written = ::write(out.fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+#else
+    std::FILE* file = out.fd == 1 ? stdout : stderr;
+    std::fwrite(data, 1, size, file);
+    std::fflush(file);
+#endif
+}
+
+KASSERT_KASSERT_HPP_INLINE void submit_report(
+    FileDescriptor const out, char const* data, std::size_t const size, ReportSeverity const severity
+) {
+    ReportSink* const sink = out.fd == standard_error.fd ? report_sink() : nullptr;
+    if (sink != nullptr) {
+        sink->write(data, size, severity);
+    } else {
+        write_to(out, data, size);
+    }
+}
+} // namespace kassert::internal
+
+namespace kassert {
+KASSERT_KASSERT_HPP_INLINE void Logger<internal::FileDescriptor>::flush() {
+    if (std::size_t const size = discard(); size > 0) {
+        internal::submit_report(_out, _buffer, size, _severity);
+    }
+}
+
+KASSERT_KASSERT_HPP_INLINE std::size_t Logger<internal::FileDescriptor>::discard() {
+    if (_truncated && !_record) {
+        // the buffer always has space left for the truncation marker
+        std::memcpy(_buffer + _size, truncation_marker, truncation_marker_size);
+        _size += truncation_marker_size;
+    }
+    std::size_t const size = _size;
+    _size                  = 0;
+    _truncated             = false;
+    _record                = false;
+    _escaping              = false;
+    _has_level             = false;
+    return size;
+}
+
+KASSERT_KASSERT_HPP_INLINE void Logger<internal::FileDescriptor>::append(char const* data, std::size_t const size) {
+    if (_escaping) {
+        append_escaped(data, size);
+        return;
+    }
+    std::size_t const length = size < capacity - _size ? size : capacity - _size;
+    std::memcpy(_buffer + _size, data, length);
+    _size += length;
+    _truncated |= length < size;
+}
+
+KASSERT_KASSERT_HPP_INLINE void
+Logger<internal::FileDescriptor>::append_escaped(char const* data, std::size_t const size) {
+    static constexpr char hex_digits[] = "0123456789abcdef";
+    for (std::size_t i = 0; i < size;) {
+        char        escaped[6] = {'\\', data[i]};
+        char const* sequence   = escaped;
+        std::size_t length     = 2;
+        auto const  character  = static_cast<unsigned char>(data[i]);
+        if (character == '\n') {
+            escaped[1] = 'n';
+        } else if (character == '\t') {
+            escaped[1] = 't';
+        } else if (character < 0x20) {
+            escaped[1] = 'u';
+            escaped[2] = '0';
+            escaped[3] = '0';
+            escaped[4] = hex_digits[character >> 4];
+            escaped[5] = hex_digits[character & 0xf];
+            length     = 6;
+        } else if (character >= 0x80) {
+            // copy valid UTF-8 sequences as a whole, such that truncation never splits a code point, and replace all
+            // other bytes by U+FFFD, such that the record remains valid UTF-8
+            length = internal::utf8_sequence_length(data + i, size - i);
+            if (length > 0) {
+                sequence = data + i;
+            } else {
+                std::memcpy(escaped, "\\ufffd", 6);
+                length = 6;
+            }
+        } else if (character != '"' && character != '\\') {
+            escaped[0] = data[i];
+            length     = 1;
+        }
+        if (_size + length > capacity - record_reserve) {
+            _truncated = true;
+            return;
+        }
+        std::memcpy(_buffer + _size, sequence, length);
+        _size += length;
+        i += sequence == escaped ? 1 : length;
+    }
+}
+} // namespace kassert
+
+namespace kassert::internal {
+KASSERT_KASSERT_HPP_INLINE void print_failed_assertion(
+    FdLogger&               logger,
+    char const*             type,
+    ErasedExpression const& erased,
+    void const*             expr,
+    SourceLocation const&   where,
+    char const*             expr_str
+) {
+    if (erased.print_lhs == nullptr) {
+        print_failed_assertion(logger, type, false, where, expr_str);
+        return;
+    }
+    if (report_format() == ReportFormat::json) {
+        print_record_header(logger, type, where, expr_str);
+        if (erased.relation != nullptr) {
+            logger << ",\"relation\":";
+            print_record_string(logger, erased.relation);
+        }
+        logger << ",\"operands\":[\"";
+        logger.set_escaping(true);
+        erased.print_lhs(logger, expr);
+        if (erased.relation != nullptr) {
+            logger.set_escaping(false);
+            logger << "\",\"";
+            logger.set_escaping(true);
+            erased.print_rhs(logger, expr);
+        }
+        logger.set_escaping(false);
+        logger << "\"]";
+        open_record_message(logger);
+        return;
+    }
+    print_failed_assertion(logger, type, false, where, expr_str);
+    logger << "with expansion:\n\t";
+    erased.print_lhs(logger, expr);
+    if (erased.relation != nullptr) {
+        logger << " " << erased.relation << " ";
+        erased.print_rhs(logger, expr);
+    }
+    logger << "\n";
+}
+
+KASSERT_KASSERT_HPP_INLINE void print_record_string(FdLogger& logger, char const* value) {
+    logger << "\"";
+    logger.set_escaping(true);
+    logger << value;
+    logger.set_escaping(false);
+    logger << "\"";
+}
+
+KASSERT_KASSERT_HPP_INLINE void
+print_record_header(FdLogger& logger, char const* type, SourceLocation const& where, char const* expr_str) {
+    logger.begin_record();
+    logger << "{\"severity\":" << (logger.severity() == ReportSeverity::fatal ? "\"fatal\"" : "\"warning\"")
+           << ",\"type\":";
+    print_record_string(logger, type);
+    logger << ",\"file\":";
+    print_record_string(logger, where.file);
+    logger << ",\"line\":" << where.row << ",\"function\":";
+    print_record_string(logger, where.function);
+    logger << ",\"expression\":";
+    print_record_string(logger, expr_str);
+}
+
+KASSERT_KASSERT_HPP_INLINE void open_record_message(FdLogger& logger) {
+    logger << ",\"message\":\"";
+    logger.set_escaping(true);
+}
+
+KASSERT_KASSERT_HPP_INLINE void close_record_message(FdLogger& logger) {
+    if (logger.escaping()) {
+        logger.set_escaping(false);
+        logger << "\"";
+    }
+}
+
+KASSERT_KASSERT_HPP_INLINE void finish_record(FdLogger& logger) {
+    close_record_message(logger);
+    if (int level = 0; logger.level(level)) {
+        logger << ",\"level\":" << level;
+    }
+    logger << ",\"thread\":" << current_thread_id();
+    if (int const rank = report_rank.load(std::memory_order_relaxed); rank >= 0) {
+        logger << ",\"rank\":" << rank;
+    }
+    if (logger.truncated()) {
+        logger << ",\"truncated\":true";
+    }
+    logger << "}\n";
+}
+
+KASSERT_KASSERT_HPP_INLINE unsigned long long current_thread_id() {
+#if defined(__linux__)
+    return static_cast<unsigned long long>(::syscall(SYS_gettid));
+#else
+    static std::atomic<unsigned long long> next_id{1};
+    thread_local unsigned long long const  id = next_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+#endif
+}
+
+KASSERT_KASSERT_HPP_INLINE void print_failed_assertion(
+    FdLogger& logger, char const* type, bool, SourceLocation const& where, char const* expr_str
+) {
+    if (report_format() == ReportFormat::json) {
+        print_record_header(logger, type, where, expr_str);
+        open_record_message(logger);
+        return;
+    }
+    logger << where.file << ": In function '" << where.function << "':\n"
+           << where.file << ":" << where.row << ": FAILED " << type << "\n"
+           << "\t" << expr_str << "\n";
+}
+
+KASSERT_KASSERT_HPP_INLINE void pause_failing_thread() {
+#if KASSERT_KASSERT_HPP_HAS_UNISTD
+    timespec const duration{0, 1000 * 1000};
+    ::nanosleep(&duration, nullptr);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+}
+
+KASSERT_KASSERT_HPP_INLINE bool enter_failure_report() {
+    if (!first_failure_claimed.exchange(true, std::memory_order_acq_rel)) {
+        return true;
+    }
+    for (int waited = 0;
+         waited < KASSERT_FAILURE_GRACE_PERIOD_MS && !first_failure_reported.load(std::memory_order_acquire);
+         ++waited) {
+        pause_failing_thread();
+    }
+    return false;
+}
+
+KASSERT_KASSERT_HPP_INLINE void leave_failure_report(bool const first) {
+    if (first) {
+        first_failure_reported.store(true, std::memory_order_release);
+        // wait until the other failing threads have submitted their reports; they are counted as soon as they enter
+        // fail_with_report(), thus a single failing thread aborts the program without delay
+        for (int waited = 0;
+             waited < KASSERT_FAILURE_GRACE_PERIOD_MS && failing_threads.load(std::memory_order_acquire) > 1;
+             ++waited) {
+            pause_failing_thread();
+        }
+        std::abort();
+    }
+    failing_threads.fetch_sub(1, std::memory_order_acq_rel);
+    // hold this thread until the first failing thread aborts the program; if it is stuck, e.g., in the report sink,
+    // abort after twice the grace period
+    for (int waited = 0; waited < 2 * KASSERT_FAILURE_GRACE_PERIOD_MS; ++waited) {
+        pause_failing_thread();
+    }
+    std::abort();
+}
+
+KASSERT_KASSERT_HPP_INLINE void fail_with_report(char const* report, std::size_t const size) {
+    // a failure while reporting a failure of the same thread, e.g., in the failure handler or the report sink, must
+    // neither call the handler again nor wait for itself
+    thread_local bool reporting = false;
+    if (reporting) {
+        std::abort();
+    }
+
+    // this thread is counted before the failure handler is called, such that the first failing thread also waits for
+    // threads that are still in the handler; since this function never returns, the destructor only runs if the
+    // handler (or the report sink) leaves the failure path by throwing an exception
+    struct FailingThread {
+        FailingThread() {
+            reporting = true;
+            failing_threads.fetch_add(1, std::memory_order_acq_rel);
+        }
+        ~FailingThread() {
+            failing_threads.fetch_sub(1, std::memory_order_acq_rel);
+            reporting = false;
+        }
+    };
+    FailingThread const failing_thread;
+
+    if (FailureHandler const handler = failure_handler(); handler != nullptr) {
+        handler(report, size);
+    }
+    bool const first = enter_failure_report();
+    submit_report(standard_error, report, size, ReportSeverity::fatal);
+    leave_failure_report(first);
+}
+
+KASSERT_KASSERT_HPP_INLINE void finish_failed_assertion(FdLogger& logger) {
+    if (logger.record()) {
+        finish_record(logger);
+    } else {
+        logger << "\n";
+    }
+    // discard the report before calling the failure handler, such that it is not written if the handler throws
+    std::size_t const size = logger.discard();
+    fail_with_report(logger.data(), size);
+}
+
+KASSERT_KASSERT_HPP_INLINE void
+finish_warning(FdLogger& logger, std::uint64_t const suppressed, std::uint64_t const failures) {
+    if (logger.record()) {
+        close_record_message(logger);
+        logger << ",\"suppressed\":" << suppressed << ",\"failures\":" << failures;
+        finish_record(logger);
+        logger.flush();
+        return;
+    }
+    if (suppressed > 0) {
+        logger << "\n(" << suppressed << " similar warnings suppressed, " << failures << " in total)";
+    }
+    logger << "\n";
+    logger.flush();
+}
+
+KASSERT_KASSERT_HPP_INLINE void fail_erased_assertion(
+    char const*           type,
+    SourceLocation const& where,
+    char const*           expr_str,
+    ErasedFailure const&  erased,
+    void const*           expr,
+    void const*           message
+) {
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, type, erased.expression, expr, where, expr_str);
+    erased.write_message(logger, message);
+    finish_failed_assertion(logger);
+}
+
+KASSERT_KASSERT_HPP_INLINE void fail_erased_warning(
+    WarningLimiter&       limiter,
+    std::uint64_t const   burst,
+    char const*           type,
+    SourceLocation const& where,
+    char const*           expr_str,
+    ErasedFailure const&  erased,
+    void const*           expr,
+    void const*           message
+) {
+    if (!limiter.report(burst)) {
+        return;
+    }
+    FdLogger logger(standard_error, ReportSeverity::warning);
+    print_failed_assertion(logger, type, erased.expression, expr, where, expr_str);
+    erased.write_message(logger, message);
+    finish_warning(logger, limiter.take_suppressed(), limiter.failures);
+}
+
+KASSERT_KASSERT_HPP_INLINE void fail_with_description(char const* what) {
+    FdLogger logger(standard_error);
+    if (report_format() == ReportFormat::json) {
+        logger.begin_record();
+        logger << "{\"severity\":\"fatal\",\"description\":";
+        print_record_string(logger, what);
+        finish_record(logger);
+    } else {
+        logger << what << "\n";
+    }
+    std::size_t const size = logger.discard();
+    fail_with_report(logger.data(), size);
+}
+} // namespace kassert::internal
@@ -0,0 +1,147 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Complexity classes and per-level cost budgets used to implement KASSERT_WITH_COST().
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "kassert/internal/assertion_macros.hpp"
+
+#ifndef KASSERT_COST_BUDGET
+    /// @brief Initial cost budget of all assertion levels. By default, the budget is unlimited.
+    #define KASSERT_COST_BUDGET UINT64_MAX
+#endif
+
+namespace kassert {
+/// @brief Asymptotic complexity of the expression of an assertion, see KASSERT_WITH_COST().
+enum class Complexity {
+    constant,     ///< O(1)
+    logarithmic,  ///< O(log n)
+    linear,       ///< O(n)
+    linearithmic, ///< O(n log n)
+    quadratic,    ///< O(n^2)
+    cubic         ///< O(n^3)
+};
+
+/// @brief Cost budget that admits assertions of any cost.
+constexpr std::uint64_t unlimited_cost_budget = std::numeric_limits<std::uint64_t>::max();
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Number of assertion levels with separate (cost or time) budgets. Assertions with a negative level use the
+/// budget of level \c 0, assertions with a level of at least \c budget_levels use the budget of the highest level.
+constexpr int budget_levels = 128;
+
+/// @brief Cost budgets, indexed by the assertion level.
+///
+/// Budgets are stored XOR-ed with \c KASSERT_COST_BUDGET, such that the zero-initialized table holds the initial
+/// budget of all levels without requiring dynamic initialization.
+inline std::atomic<std::uint64_t> cost_budgets[budget_levels]{};
+
+/// @brief Returns the entry of a per-level budget table (e.g., \c cost_budgets) that holds the budget of an assertion
+/// level.
+/// @param level The assertion level.
+/// @return The index of the entry.
+constexpr std::size_t budget_slot(int const level) {
+    return static_cast<std::size_t>(level < 0 ? 0 : (level < budget_levels ? level : budget_levels - 1));
+}
+
+/// @brief Multiplies two numbers, saturating at the largest representable value.
+/// @param lhs The first factor.
+/// @param rhs The second factor.
+/// @return The product, or \c unlimited_cost_budget if it overflows.
+constexpr std::uint64_t saturating_multiply(std::uint64_t const lhs, std::uint64_t const rhs) {
+    if (rhs != 0 && lhs > unlimited_cost_budget / rhs) {
+        return unlimited_cost_budget;
+    }
+    return lhs * rhs;
+}
+
+/// @brief Computes the number of bits required to represent a number, i.e., `floor(log2(value)) + 1` for positive
+/// values.
+/// @param value The number.
+/// @return The number of bits, at least \c 1.
+constexpr std::uint64_t bit_width(std::uint64_t value) {
+    std::uint64_t width = 1;
+    while (value > 1) {
+        value >>= 1;
+        ++width;
+    }
+    return width;
+}
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Estimates the cost of evaluating an assertion, i.e., the number of elementary operations up to a constant
+/// factor: \c 1, `log2(n)`, \c n, `n log2(n)`, `n^2` or `n^3`. Logarithms are rounded up and at least \c 1.
+/// @param complexity The complexity class of the assertion.
+/// @param size The problem size \c n.
+/// @return The estimated cost, saturated at \c unlimited_cost_budget.
+constexpr std::uint64_t estimated_cost(Complexity const complexity, std::uint64_t const size) {
+    switch (complexity) {
+        case Complexity::constant:
+            return 1;
+        case Complexity::logarithmic:
+            return internal::bit_width(size);
+        case Complexity::linear:
+            return size;
+        case Complexity::linearithmic:
+            return internal::saturating_multiply(size, internal::bit_width(size));
+        case Complexity::quadratic:
+            return internal::saturating_multiply(size, size);
+        case Complexity::cubic:
+            return internal::saturating_multiply(internal::saturating_multiply(size, size), size);
+    }
+    return unlimited_cost_budget;
+}
+
+/// @brief Returns the cost budget of an assertion level.
+/// @param level The assertion level.
+/// @return The cost budget.
+inline std::uint64_t cost_budget(int const level) {
+    return internal::cost_budgets[internal::budget_slot(level)].load(std::memory_order_relaxed)
+           ^ KASSERT_COST_BUDGET;
+}
+
+/// @brief Sets the cost budget of an assertion level. Assertions of this level declared with KASSERT_WITH_COST() are
+/// only evaluated if their estimated cost (see \c estimated_cost()) does not exceed the budget. The budget is shared by
+/// all threads.
+/// @param level The assertion level.
+/// @param budget The cost budget, or \c unlimited_cost_budget to evaluate all assertions of this level.
+/// @return The previous cost budget of the level.
+inline std::uint64_t set_cost_budget(int const level, std::uint64_t const budget) {
+    return internal::cost_budgets[internal::budget_slot(level)].exchange(
+               budget ^ KASSERT_COST_BUDGET,
+               std::memory_order_relaxed
+           )
+           ^ KASSERT_COST_BUDGET;
+}
+
+/// @brief Sets the cost budget of all assertion levels.
+/// @param budget The cost budget, or \c unlimited_cost_budget to evaluate all assertions.
+inline void set_cost_budget(std::uint64_t const budget) {
+    for (auto& entry: internal::cost_budgets) {
+        entry.store(budget ^ KASSERT_COST_BUDGET, std::memory_order_relaxed);
+    }
+}
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Checks if the estimated cost of an assertion is within the cost budget of its level. If the complexity class
+/// is a constant, this is a relaxed load plus (at most) a multiplication and a comparison.
+/// @param level The level of the assertion.
+/// @param complexity The complexity class of the assertion.
+/// @param size The problem size.
+/// @return Whether the assertion should be evaluated.
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline bool
+within_cost_budget(int const level, Complexity const complexity, std::uint64_t const size) {
+    return estimated_cost(complexity, size) <= cost_budget(level);
+}
+} // namespace kassert::internal
@@ -0,0 +1,32 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Cheap timestamps used by the instrumentation and by time-budgeted assertions.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+#endif
+
+namespace kassert::internal {
+/// @brief Reads the cycle counter of the CPU (or a monotonic clock in nanoseconds on unsupported platforms).
+/// @return The current value of the cycle counter.
+inline std::uint64_t read_cycle_counter() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    std::uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+#endif
+}
+} // namespace kassert::internal
@@ -0,0 +1,67 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Definitions of the non-template functions declared in \c kassert/exception.hpp.
+///
+/// This header is included at the end of \c kassert/exception.hpp unless \c KASSERT_RUNTIME_LIBRARY is defined, in
+/// which case it is compiled into the runtime library.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "kassert/exception.hpp"
+
+namespace kassert::internal {
+KASSERT_KASSERT_HPP_INLINE std::string build_what(
+    std::string_view const expression, SourceLocation const where, std::string_view const message,
+    std::string_view const expansion
+) {
+    std::string_view const file     = where.file;
+    std::string_view const function = where.function;
+    std::string const      row      = std::to_string(where.row);
+
+    // build the description in a single allocation
+    std::string what;
+    what.reserve(
+        2 * file.size() + function.size() + row.size() + expression.size() + message.size() + expansion.size() + 64
+    );
+    what.append("\n").append(file).append(": In function '").append(function).append("':\n");
+    what.append(file).append(": ").append(row).append(": FAILED ASSERTION\n");
+    what.append("\t").append(expression).append("\n");
+    if (!expansion.empty()) {
+        what.append("with expansion:\n\t").append(expansion).append("\n");
+    }
+    what.append(message).append("\n");
+    return what;
+}
+} // namespace kassert::internal
+
+namespace kassert {
+KASSERT_KASSERT_HPP_INLINE KassertException::~KassertException() = default;
+
+KASSERT_KASSERT_HPP_INLINE char const* KassertException::what() const noexcept {
+    if (!_structured) {
+        return _message.c_str();
+    }
+    if (std::string const* description = _what.get(); description != nullptr) {
+        return description->c_str();
+    }
+    try {
+        auto description = std::make_unique<std::string const>(build_what(_expression, _where, _message, _expansion));
+        return _what.publish(std::move(description))->c_str();
+    } catch (...) {
+        // out of memory: the user message is better than nothing
+        return _message.c_str();
+    }
+}
+
+KASSERT_KASSERT_HPP_INLINE void Logger<std::string>::append(char const* data, std::size_t const size) {
+    _out.append(data, size);
+}
+} // namespace kassert
@@ -41,7 +41,9 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
+#include "kassert/internal/assertion_macros.hpp"
 #include "kassert/internal/logger.hpp"
 
 namespace kassert::internal {
@@ -51,91 +53,154 @@ namespace kassert::internal {
 template <typename T>
 struct AlwaysFalse : public std::false_type {};
 
-/// @brief Interface for decomposed unary and binary expressions.
+/// @brief Determines how an operand of a decomposed expression is stored: small, trivially copyable operands are
+/// stored by value, all other operands are stored by reference. The referenced operands live until the end of the
+/// full expression containing the assertion.
+/// @tparam T Type of the operand.
+template <typename T>
+using OperandStorage = std::conditional_t<
+    std::is_trivially_copyable_v<T> && !std::is_array_v<T> && sizeof(T) <= 2 * sizeof(void*),
+    T,
+    T const&>;
+
+/// @brief Base class for decomposed unary and binary expressions.
+///
+/// Decomposed expressions are statically dispatched using the curiously recurring template pattern (CRTP), i.e., the
+/// concrete expression type \c ExprT must implement `bool result() const` as well as
+/// `template <typename StreamT> void stringify(Logger<StreamT>&) const`. Thus, decomposed expressions do not carry a
+/// vtable pointer and the compiler does not have to devirtualize any calls to get back to a plain comparison.
+/// @tparam ExprT The concrete expression type.
+template <typename ExprT>
 class Expression {
 public:
-    /// @brief Virtual destructor since we use virtual functions.
-    virtual ~Expression() = default;
-
-    /// @brief Evaluate the assertion wrapped in this Expr.
-    /// @return The boolean value that the assertion evalutes to.
-    [[nodiscard]] virtual bool result() const = 0;
-
-    /// @brief Write this expression with stringified operands to the given assertion logger.
-    /// @param out The assertion logger.
-    virtual void stringify(OStreamLogger& out) const = 0;
-
     /// @brief Writes an expression with stringified operands to the given assertion logger.
+    /// @tparam StreamT The underlying streaming object of the assertion logger.
     /// @param out The assertion logger.
     /// @param expr The expression to be stringified.
     /// @return The assertion logger.
-    friend OStreamLogger& operator<<(OStreamLogger& out, Expression const& expr) {
-        expr.stringify(out);
+    template <typename StreamT>
+    friend Logger<StreamT>& operator<<(Logger<StreamT>& out, Expression const& expr) {
+        static_cast<ExprT const&>(expr).stringify(out);
         return out;
     }
+
+protected:
+    /// @brief Non-virtual destructor: expressions are never deleted through a pointer to their base class.
+    ~Expression() = default;
 };
 
+/// @cond IMPLEMENTATION
+template <typename ExprT>
+std::true_type is_expression_impl(Expression<ExprT> const*);
+std::false_type is_expression_impl(...);
+/// @endcond
+
+/// @brief Determines whether \c T is a decomposed expression, i.e., derived from \c Expression.
+/// @tparam T The type to be checked.
+template <typename T>
+constexpr bool is_expression = decltype(is_expression_impl(std::declval<std::remove_reference_t<T>*>()))::value;
+
+/// @brief Tag types naming the operator or relation of a decomposed binary expression. Since the operator is encoded in
+/// the type of the expression, decomposed expressions only store their result and their operands.
+namespace operators {
+/// @cond IMPLEMENTATION
+#define KASSERT_KASSERT_HPP_DEFINE_OPERATOR(name, op) \
+    struct name {                                     \
+        static constexpr char const* symbol = #op;    \
+    };
+
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(Equal, ==)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(NotEqual, !=)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(Less, <)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(LessEqual, <=)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(Greater, >)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(GreaterEqual, >=)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(BitAnd, &)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(BitOr, |)
+KASSERT_KASSERT_HPP_DEFINE_OPERATOR(BitXor, ^)
+
+#undef KASSERT_KASSERT_HPP_DEFINE_OPERATOR
+/// @endcond
+} // namespace operators
+
 /// @brief A decomposed binary expression.
 /// @tparam LhsT Decomposed type of the left hand side of the expression.
 /// @tparam RhsT Decomposed type of the right hand side of the expression.
-template <typename LhsT, typename RhsT>
-class BinaryExpression : public Expression {
+/// @tparam OpT Tag type of the operator or relation, see \c kassert::internal::operators.
+template <typename LhsT, typename RhsT, typename OpT>
+class BinaryExpression : public Expression<BinaryExpression<LhsT, RhsT, OpT>> {
 public:
     /// @brief Constructs a decomposed binary expression.
     /// @param result Boolean result of the expression.
     /// @param lhs Decomposed left hand side of the expression.
-    /// @param op Stringified operator or relation.
     /// @param rhs Decomposed right hand side of the expression.
-    BinaryExpression(bool const result, LhsT const& lhs, std::string_view const op, RhsT const& rhs)
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr BinaryExpression(
+        bool const result, LhsT const& lhs, RhsT const& rhs
+    )
         : _result(result),
           _lhs(lhs),
-          _op(op),
           _rhs(rhs) {}
 
     /// @brief The boolean result of the expression. This is used when retrieving the expression result after
     /// decomposition.
     /// @return The boolean result of the expression.
-    [[nodiscard]] bool result() const final {
+    [[nodiscard]] KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr bool result() const {
         return _result;
     }
 
     /// @brief Implicitly cast to bool. This is used when encountering && or ||.
+    /// This operator is intentionally non-const: otherwise, nested expressions would be stringified as \c bool.
     /// @return The boolean result of the expression.
-    operator bool() {
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr operator bool() {
         return _result;
     }
 
+    /// @brief The decomposed left hand side of this expression.
+    /// @return The left hand side.
+    [[nodiscard]] KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr OperandStorage<LhsT> const&
+    lhs_operand() const {
+        return _lhs;
+    }
+
+    /// @brief The right hand side of this expression.
+    /// @return The right hand side.
+    [[nodiscard]] KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr OperandStorage<RhsT> const&
+    rhs_operand() const {
+        return _rhs;
+    }
+
     /// @brief Writes this expression with stringified operands to the given assertion logger.
+    /// @tparam StreamT The underlying streaming object of the assertion logger.
     /// @param out The assertion logger.
-    void stringify(OStreamLogger& out) const final {
+    template <typename StreamT>
+    void stringify(Logger<StreamT>& out) const {
         stringify_value(out, _lhs);
-        out << " " << _op << " ";
+        out << " " << OpT::symbol << " ";
         stringify_value(out, _rhs);
     }
 
     /// @cond IMPLEMENTATION
 
     // Overload operators to return a proxy object that decomposes the rhs of the logical operator
-#define KASSERT_ASSERT_OP(op)                                                     \
-    template <typename RhsPrimeT>                                                 \
-    friend BinaryExpression<BinaryExpression<LhsT, RhsT>, RhsPrimeT> operator op( \
-        BinaryExpression<LhsT, RhsT>&& lhs,                                       \
-        RhsPrimeT const&               rhs_prime                                  \
-    ) {                                                                           \
-        using namespace std::string_view_literals;                                \
-        return BinaryExpression<BinaryExpression<LhsT, RhsT>, RhsPrimeT>(         \
-            lhs.result() op rhs_prime,                                            \
-            lhs,                                                                  \
-            #op##sv,                                                              \
-            rhs_prime                                                             \
-        );                                                                        \
+#define KASSERT_ASSERT_OP(op, name)                                                             \
+    template <typename RhsPrimeT>                                                               \
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE friend constexpr BinaryExpression<              \
+        BinaryExpression<LhsT, RhsT, OpT>,                                                      \
+        RhsPrimeT,                                                                              \
+        operators::name>                                                                        \
+    operator op(BinaryExpression<LhsT, RhsT, OpT>&& lhs, RhsPrimeT const& rhs_prime) {          \
+        return BinaryExpression<BinaryExpression<LhsT, RhsT, OpT>, RhsPrimeT, operators::name>( \
+            lhs.result() op rhs_prime,                                                          \
+            lhs,                                                                                \
+            rhs_prime                                                                           \
+        );                                                                                      \
     }
 
-    KASSERT_ASSERT_OP(&)
-    KASSERT_ASSERT_OP(|)
-    KASSERT_ASSERT_OP(^)
-    KASSERT_ASSERT_OP(==)
-    KASSERT_ASSERT_OP(!=)
+    KASSERT_ASSERT_OP(&, BitAnd)
+    KASSERT_ASSERT_OP(|, BitOr)
+    KASSERT_ASSERT_OP(^, BitXor)
+    KASSERT_ASSERT_OP(==, Equal)
+    KASSERT_ASSERT_OP(!=, NotEqual)
 
 #undef KASSERT_ASSERT_OP
 
@@ -145,37 +210,43 @@ private:
     /// @brief Boolean result of this expression.
     bool _result;
     /// @brief Decomposed left hand side of this expression.
-    LhsT const& _lhs;
-    /// @brief Stringified operand or relation symbol.
-    std::string_view _op;
+    OperandStorage<LhsT> _lhs;
     /// @brief Right hand side of this expression.
-    RhsT const& _rhs;
+    OperandStorage<RhsT> _rhs;
 };
 
 /// @brief Decomposed unary expression.
 /// @tparam Lhst Decomposed expression type.
 template <typename LhsT>
-class UnaryExpression : public Expression {
+class UnaryExpression : public Expression<UnaryExpression<LhsT>> {
 public:
     /// @brief Constructs this unary expression from an expression.
     /// @param lhs The expression.
-    explicit UnaryExpression(LhsT const& lhs) : _lhs(lhs) {}
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr explicit UnaryExpression(LhsT const& lhs) : _lhs(lhs) {}
 
     /// @brief Evaluates this expression.
     /// @return The boolean result of this expression.
-    [[nodiscard]] bool result() const final {
+    [[nodiscard]] KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr bool result() const {
         return static_cast<bool>(_lhs);
     }
 
+    /// @brief The operand of this expression.
+    /// @return The operand.
+    [[nodiscard]] KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr OperandStorage<LhsT> const& operand() const {
+        return _lhs;
+    }
+
     /// @brief Writes this expression with stringified operands to the given assertion logger.
+    /// @tparam StreamT The underlying streaming object of the assertion logger.
     /// @param out The assertion logger.
-    void stringify(OStreamLogger& out) const final {
+    template <typename StreamT>
+    void stringify(Logger<StreamT>& out) const {
         stringify_value(out, _lhs);
     }
 
 private:
     /// @brief The expression.
-    LhsT const& _lhs;
+    OperandStorage<LhsT> _lhs;
 };
 
 /// @brief The left hand size of a decomposed expression. This can either be turned into a \c BinaryExpr if an operand
@@ -186,41 +257,44 @@ class LhsExpression {
 public:
     /// @brief Constructs this left hand size of a decomposed expression.
     /// @param lhs The wrapped expression.
-    explicit LhsExpression(LhsT const& lhs) : _lhs(lhs) {}
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr explicit LhsExpression(LhsT const& lhs) : _lhs(lhs) {}
 
     /// @brief Turns this expression into an \c UnaryExpr. This might only be called if the wrapped expression is
     /// implicitly convertible to \c bool.
     /// @return This expression as \c UnaryExpr.
-    UnaryExpression<LhsT> make_unary() {
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr UnaryExpression<LhsT> make_unary() const {
         static_assert(std::is_convertible_v<LhsT, bool>, "expression must be convertible to bool");
         return UnaryExpression<LhsT>{_lhs};
     }
 
     /// @brief Implicitly cast to bool. This is used when encountering && or ||.
     /// @return The boolean result of the expression.
-    operator bool() {
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr operator bool() {
         return _lhs;
     }
 
     /// @cond IMPLEMENTATION
 
     // Overload binary operators to return a proxy object that decomposes the rhs of the operator.
-#define KASSERT_ASSERT_OP(op)                                                               \
-    template <typename RhsT>                                                                \
-    friend BinaryExpression<LhsT, RhsT> operator op(LhsExpression&& lhs, RhsT const& rhs) { \
-        using namespace std::string_view_literals;                                          \
-        return {lhs._lhs op rhs, lhs._lhs, #op##sv, rhs};                                   \
+#define KASSERT_ASSERT_OP(op, name)                                                           \
+    template <typename RhsT>                                                                  \
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE friend constexpr BinaryExpression<            \
+        LhsT,                                                                                 \
+        RhsT,                                                                                 \
+        operators::name>                                                                      \
+    operator op(LhsExpression&& lhs, RhsT const& rhs) {                                       \
+        return BinaryExpression<LhsT, RhsT, operators::name>(lhs._lhs op rhs, lhs._lhs, rhs); \
     }
 
-    KASSERT_ASSERT_OP(==)
-    KASSERT_ASSERT_OP(!=)
-    KASSERT_ASSERT_OP(<)
-    KASSERT_ASSERT_OP(<=)
-    KASSERT_ASSERT_OP(>)
-    KASSERT_ASSERT_OP(>=)
-    KASSERT_ASSERT_OP(&)
-    KASSERT_ASSERT_OP(|)
-    KASSERT_ASSERT_OP(^)
+    KASSERT_ASSERT_OP(==, Equal)
+    KASSERT_ASSERT_OP(!=, NotEqual)
+    KASSERT_ASSERT_OP(<, Less)
+    KASSERT_ASSERT_OP(<=, LessEqual)
+    KASSERT_ASSERT_OP(>, Greater)
+    KASSERT_ASSERT_OP(>=, GreaterEqual)
+    KASSERT_ASSERT_OP(&, BitAnd)
+    KASSERT_ASSERT_OP(|, BitOr)
+    KASSERT_ASSERT_OP(^, BitXor)
 
 #undef KASSERT_ASSERT_OP
 
@@ -228,7 +302,7 @@ public:
 
 private:
     /// @brief The wrapped expression.
-    LhsT const& _lhs;
+    OperandStorage<LhsT> _lhs;
 };
 
 /// @brief Decomposes an expression (see group description).
@@ -238,7 +312,8 @@ struct Decomposer {
     /// @param lhs The left hand side of the expression.
     /// @return \c lhs wrapped in a \c LhsExpr.
     template <typename LhsT>
-    friend LhsExpression<LhsT> operator<=(Decomposer&&, LhsT const& lhs) {
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE friend constexpr LhsExpression<LhsT>
+    operator<=(Decomposer&&, LhsT const& lhs) {
         return LhsExpression<LhsT>(lhs);
     }
 };
@@ -247,20 +322,91 @@ struct Decomposer {
 /// the result of the assertion.
 /// @param result Result of the assertion.
 /// @return Result of the assertion.
-inline bool finalize_expr(bool const result) {
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr bool finalize_expr(bool const result) {
     return result;
 }
 
 /// @brief Transforms \c LhsExpression into \c UnaryExpression, does nothing to a \c Expression (see group description).
 /// @tparam ExprT Type of the expression, either \c LhsExpression or a \c BinaryExpression.
 /// @param expr The expression.
-/// @return The expression as some subclass of \c Expression.
+/// @return The expression as some subclass of \c Expression. Since decomposed expressions only store their result and
+/// (references to) their operands, they are returned by value.
 template <typename ExprT>
-decltype(auto) finalize_expr(ExprT&& expr) {
-    if constexpr (std::is_base_of_v<Expression, std::remove_reference_t<std::remove_const_t<ExprT>>>) {
-        return std::forward<ExprT>(expr);
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE constexpr auto finalize_expr(ExprT&& expr) {
+    if constexpr (is_expression<ExprT>) {
+        return expr;
     } else {
         return expr.make_unary();
     }
 }
+
+/// @brief Type-erased formatting of a decomposed expression type, i.e., its relation and functions that stringify the
+/// operands of an expression of this type passed as a pointer. The failure paths only format type-erased expressions
+/// if \c KASSERT_TYPE_ERASED_OPERANDS is defined, such that the formatting is compiled once instead of once per call
+/// site.
+struct ErasedExpression {
+    /// @brief The operator or relation of a binary expression, or \c nullptr if the expression is unary.
+    char const* relation;
+    /// @brief Writes the left hand side of a binary expression or the operand of an unary expression to a logger, or
+    /// \c nullptr if the expression could not be decomposed.
+    void (*print_lhs)(FdLogger& out, void const* expr);
+    /// @brief Writes the right hand side of a binary expression to a logger, unused if the expression is unary.
+    void (*print_rhs)(FdLogger& out, void const* expr);
+};
+
+/// @brief Stringifies the operand of a type-erased unary expression.
+/// @tparam LhsT Type of the operand.
+/// @param out The logger.
+/// @param expr The expression.
+template <typename LhsT>
+void print_erased_operand(FdLogger& out, void const* expr) {
+    stringify_value(out, static_cast<UnaryExpression<LhsT> const*>(expr)->operand());
+}
+
+/// @brief Stringifies the left hand side of a type-erased binary expression.
+/// @tparam ExprT Type of the binary expression.
+/// @param out The logger.
+/// @param expr The expression.
+template <typename ExprT>
+void print_erased_lhs(FdLogger& out, void const* expr) {
+    stringify_value(out, static_cast<ExprT const*>(expr)->lhs_operand());
+}
+
+/// @brief Stringifies the right hand side of a type-erased binary expression.
+/// @tparam ExprT Type of the binary expression.
+/// @param out The logger.
+/// @param expr The expression.
+template <typename ExprT>
+void print_erased_rhs(FdLogger& out, void const* expr) {
+    stringify_value(out, static_cast<ExprT const*>(expr)->rhs_operand());
+}
+
+/// @brief Type-erased formatting of an assertion that could not be decomposed.
+/// @tparam ExprT Type of the assertion expression.
+template <typename ExprT>
+struct ExpressionErasure {
+    /// @brief Formatting without operands.
+    static constexpr ErasedExpression erased{nullptr, nullptr, nullptr};
+};
+
+/// @brief Type-erased formatting of a decomposed unary expression.
+/// @tparam LhsT Type of the operand.
+template <typename LhsT>
+struct ExpressionErasure<UnaryExpression<LhsT>> {
+    /// @brief Formatting of the operand.
+    static constexpr ErasedExpression erased{nullptr, &print_erased_operand<LhsT>, nullptr};
+};
+
+/// @brief Type-erased formatting of a decomposed binary expression.
+/// @tparam LhsT Type of the left hand side.
+/// @tparam RhsT Type of the right hand side.
+/// @tparam OpT Tag type of the operator or relation.
+template <typename LhsT, typename RhsT, typename OpT>
+struct ExpressionErasure<BinaryExpression<LhsT, RhsT, OpT>> {
+    /// @brief Formatting of the relation and both operands.
+    static constexpr ErasedExpression erased{
+        OpT::symbol,
+        &print_erased_lhs<BinaryExpression<LhsT, RhsT, OpT>>,
+        &print_erased_rhs<BinaryExpression<LhsT, RhsT, OpT>>};
+};
 } // namespace kassert::internal
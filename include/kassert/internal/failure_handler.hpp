@@ -0,0 +1,62 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Pluggable handler of failed fatal assertions, which aborts the program by default.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#ifndef KASSERT_FAILURE_GRACE_PERIOD_MS
+    /// @brief Time in milliseconds for which the first thread that fails a fatal assertion waits for the reports of
+    /// other threads that fail concurrently before it aborts the program.
+    #define KASSERT_FAILURE_GRACE_PERIOD_MS 100
+#endif
+
+namespace kassert {
+/// @brief Handler of failed fatal assertions, i.e., KASSERT(), its variants and THROWING_KASSERT() if exception mode is
+/// disabled.
+///
+/// The handler receives the formatted report of the failed assertion, which is not null-terminated, instead of the
+/// report sink. It may leave the failure path by throwing an exception (see \c kassert/testing.hpp) or by terminating
+/// the program. If the handler returns, the report is submitted to the report sink and the program is aborted.
+using FailureHandler = void (*)(char const* report, std::size_t size);
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The installed failure handler, or \c nullptr if failed assertions abort the program.
+inline std::atomic<FailureHandler> installed_failure_handler{nullptr};
+
+/// @brief Number of threads on the failure path of a fatal assertion, including the failure handler, that have not
+/// submitted their report yet; the first failing thread counts until it aborts the program. Only failing threads ever
+/// access it.
+inline std::atomic<unsigned> failing_threads{0};
+
+/// @brief Whether a thread has claimed to be the first failing thread, which aborts the program.
+inline std::atomic<bool> first_failure_claimed{false};
+
+/// @brief Whether the first failing thread has submitted its report, such that the reports of other failing threads
+/// follow it.
+inline std::atomic<bool> first_failure_reported{false};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Installs the handler that is called by all failed fatal assertions before the program is aborted.
+///
+/// Assertions that throw from the handler must not be evaluated in \c noexcept functions or destructors, since the
+/// exception would terminate the program.
+/// @param handler The new handler, or \c nullptr to abort the program immediately after the report was submitted.
+/// @return The previously installed handler, or \c nullptr.
+inline FailureHandler set_failure_handler(FailureHandler const handler) {
+    return internal::installed_failure_handler.exchange(handler, std::memory_order_acq_rel);
+}
+
+/// @brief Returns the installed failure handler.
+/// @return The installed handler, or \c nullptr if failed assertions abort the program.
+inline FailureHandler failure_handler() {
+    return internal::installed_failure_handler.load(std::memory_order_acquire);
+}
+} // namespace kassert
@@ -0,0 +1,432 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Per-call-site instrumentation of assertions. Only included if \c KASSERT_INSTRUMENTATION is defined.
+///
+/// Each call site of an assertion registers itself in a global registry the first time it is evaluated. Evaluations
+/// are counted in per-thread counters, which are only written by their owning thread and merged into the registry when
+/// the thread exits or when a report is requested. Thus, the instrumentation does not cause contention between
+/// threads. Optionally, every \c KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE-th evaluation of each call site is timed.
+/// Evaluations of KASSERT_WITH_COST() that are skipped because they exceed the cost budget are counted separately.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kassert/internal/cycle_counter.hpp"
+#include "kassert/internal/source_location.hpp"
+
+#ifndef KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE
+    /// @brief Time every n-th evaluation of each call site. A value of \c 0 disables timing.
+    #define KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE 0
+#endif
+
+namespace kassert {
+/// @brief Statistics of a single assertion call site, as collected by the instrumentation mode.
+struct AssertionSiteStatistics {
+    /// @brief Source code location of the assertion.
+    internal::SourceLocation where;
+    /// @brief Stringified assertion expression.
+    char const* expression;
+    /// @brief Assertion level.
+    int level;
+    /// @brief Number of times the assertion was evaluated, summed over all threads.
+    std::uint64_t evaluations;
+    /// @brief Number of evaluations that were timed.
+    std::uint64_t timed_evaluations;
+    /// @brief Cycles (or nanoseconds, on platforms without a cycle counter) spent in the timed evaluations.
+    std::uint64_t timed_cycles;
+    /// @brief Number of times the assertion was reached but not evaluated because its estimated cost exceeded the cost
+    /// budget of its level (see KASSERT_WITH_COST()), summed over all threads.
+    std::uint64_t skipped_evaluations;
+
+    /// @brief Estimates the total number of cycles spent evaluating this assertion.
+    /// @return The estimated number of cycles, or \c 0 if no evaluation was timed.
+    [[nodiscard]] double estimated_cycles() const {
+        if (timed_evaluations == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(timed_cycles) / static_cast<double>(timed_evaluations)
+               * static_cast<double>(evaluations);
+    }
+};
+
+/// @brief Output formats of the instrumentation report.
+enum class InstrumentationReportFormat {
+    table, ///< Human readable table.
+    csv    ///< Comma-separated values with a header line.
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Counters of a single call site, owned by a single thread.
+///
+/// Counters are only written by their owning thread, but may be read concurrently while a report is created. Thus, they
+/// are atomics that are updated with relaxed loads and stores instead of read-modify-write operations.
+struct SiteCounters {
+    std::atomic<std::uint64_t> evaluations{0};         ///< @brief Number of evaluations.
+    std::atomic<std::uint64_t> timed_evaluations{0};   ///< @brief Number of timed evaluations.
+    std::atomic<std::uint64_t> timed_cycles{0};        ///< @brief Cycles spent in timed evaluations.
+    std::atomic<std::uint64_t> skipped_evaluations{0}; ///< @brief Number of evaluations skipped by the cost budget.
+
+    /// @brief Increments a counter that is only written by the calling thread.
+    /// @param counter The counter.
+    /// @param value The value to add.
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t const value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+class ThreadCounters;
+
+/// @brief Registry of all instrumented assertion call sites and all threads that evaluated instrumented assertions.
+class InstrumentationRegistry {
+public:
+    /// @brief Registers a call site.
+    /// @param where Source code location of the assertion.
+    /// @param expression Stringified assertion expression.
+    /// @param level Level of the assertion.
+    /// @return The identifier of the call site.
+    std::size_t register_site(SourceLocation const where, char const* expression, int const level) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sites.push_back(AssertionSiteStatistics{where, expression, level, 0, 0, 0, 0});
+        return _sites.size() - 1;
+    }
+
+    /// @brief Collects the statistics of all call sites, aggregated over all threads.
+    /// @return The statistics of all call sites, sorted by decreasing estimated cycles and evaluations.
+    std::vector<AssertionSiteStatistics> collect();
+
+    /// @brief Resets the statistics of all call sites.
+    void reset();
+
+    /// @brief Registers the counters of a thread.
+    /// @param counters The counters.
+    void attach(ThreadCounters& counters) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(&counters);
+    }
+
+    /// @brief Merges the counters of an exiting thread into the registry and deregisters them.
+    /// @param counters The counters.
+    void detach(ThreadCounters& counters);
+
+    /// @brief Mutex protecting the registry. Also protects the growth of the counters in \c ThreadCounters.
+    /// @return The mutex.
+    std::mutex& mutex() {
+        return _mutex;
+    }
+
+private:
+    std::mutex                           _mutex;   ///< @brief Protects all members.
+    std::vector<AssertionSiteStatistics> _sites;   ///< @brief Call sites with counters of exited threads.
+    std::vector<ThreadCounters*>         _threads; ///< @brief Counters of running threads.
+};
+
+/// @brief Returns the global instrumentation registry. The registry is never destroyed, such that threads can still
+/// merge their counters after static destruction has started.
+/// @return The registry.
+inline InstrumentationRegistry& instrumentation_registry() {
+    static InstrumentationRegistry* registry = new InstrumentationRegistry();
+    return *registry;
+}
+
+/// @brief Counters of all call sites evaluated by a single thread, indexed by the call site identifier.
+class ThreadCounters {
+public:
+    /// @brief Registers the counters with the registry.
+    ThreadCounters() {
+        instrumentation_registry().attach(*this);
+    }
+
+    /// @brief Counters cannot be copied.
+    ThreadCounters(ThreadCounters const&) = delete;
+
+    /// @brief Counters cannot be copied.
+    /// @return This object.
+    ThreadCounters& operator=(ThreadCounters const&) = delete;
+
+    /// @brief Merges the counters into the registry.
+    ~ThreadCounters() {
+        instrumentation_registry().detach(*this);
+    }
+
+    /// @brief Returns the counters of a call site, growing the storage if necessary.
+    /// @param site The identifier of the call site.
+    /// @return The counters of the call site.
+    SiteCounters& operator[](std::size_t const site) {
+        if (site >= _size) {
+            grow(site + 1);
+        }
+        return _counters[site];
+    }
+
+    /// @brief Number of call sites for which this object holds counters. Must be called while holding the registry
+    /// mutex.
+    /// @return The number of call sites.
+    [[nodiscard]] std::size_t size() const {
+        return _size;
+    }
+
+    /// @brief Counters of a call site. Must be called while holding the registry mutex.
+    /// @param site The identifier of the call site, must be less than \c size().
+    /// @return The counters of the call site.
+    [[nodiscard]] SiteCounters const& at(std::size_t const site) const {
+        return _counters[site];
+    }
+
+    /// @brief Resets all counters. Must be called while holding the registry mutex.
+    void reset() {
+        for (std::size_t site = 0; site < _size; ++site) {
+            _counters[site].evaluations.store(0, std::memory_order_relaxed);
+            _counters[site].timed_evaluations.store(0, std::memory_order_relaxed);
+            _counters[site].timed_cycles.store(0, std::memory_order_relaxed);
+            _counters[site].skipped_evaluations.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    /// @brief Grows the storage to hold counters for at least \c size call sites.
+    /// @param size The minimum number of call sites.
+    void grow(std::size_t const size) {
+        std::lock_guard<std::mutex> lock(instrumentation_registry().mutex());
+        std::size_t const           new_size     = std::max(size, 2 * _size);
+        auto                        new_counters = std::make_unique<SiteCounters[]>(new_size);
+        for (std::size_t site = 0; site < _size; ++site) {
+            new_counters[site].evaluations.store(_counters[site].evaluations.load(std::memory_order_relaxed));
+            new_counters[site].timed_evaluations.store(
+                _counters[site].timed_evaluations.load(std::memory_order_relaxed)
+            );
+            new_counters[site].timed_cycles.store(_counters[site].timed_cycles.load(std::memory_order_relaxed));
+            new_counters[site].skipped_evaluations.store(
+                _counters[site].skipped_evaluations.load(std::memory_order_relaxed)
+            );
+        }
+        _counters = std::move(new_counters);
+        _size     = new_size;
+    }
+
+    std::unique_ptr<SiteCounters[]> _counters; ///< @brief Counters, indexed by the call site identifier.
+    std::size_t                     _size = 0; ///< @brief Number of call sites in \c _counters.
+};
+
+inline std::vector<AssertionSiteStatistics> InstrumentationRegistry::collect() {
+    std::vector<AssertionSiteStatistics> statistics;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        statistics = _sites;
+        for (ThreadCounters const* counters: _threads) {
+            std::size_t const num_sites = std::min(counters->size(), statistics.size());
+            for (std::size_t site = 0; site < num_sites; ++site) {
+                SiteCounters const& site_counters = counters->at(site);
+                statistics[site].evaluations += site_counters.evaluations.load(std::memory_order_relaxed);
+                statistics[site].timed_evaluations += site_counters.timed_evaluations.load(std::memory_order_relaxed);
+                statistics[site].timed_cycles += site_counters.timed_cycles.load(std::memory_order_relaxed);
+                statistics[site].skipped_evaluations +=
+                    site_counters.skipped_evaluations.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    std::stable_sort(statistics.begin(), statistics.end(), [](auto const& lhs, auto const& rhs) {
+        if (lhs.estimated_cycles() != rhs.estimated_cycles()) {
+            return lhs.estimated_cycles() > rhs.estimated_cycles();
+        }
+        return lhs.evaluations > rhs.evaluations;
+    });
+    return statistics;
+}
+
+inline void InstrumentationRegistry::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& site: _sites) {
+        site.evaluations         = 0;
+        site.timed_evaluations   = 0;
+        site.timed_cycles        = 0;
+        site.skipped_evaluations = 0;
+    }
+    for (ThreadCounters* counters: _threads) {
+        counters->reset();
+    }
+}
+
+inline void InstrumentationRegistry::detach(ThreadCounters& counters) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t const           num_sites = std::min(counters.size(), _sites.size());
+    for (std::size_t site = 0; site < num_sites; ++site) {
+        SiteCounters const& site_counters = counters.at(site);
+        _sites[site].evaluations += site_counters.evaluations.load(std::memory_order_relaxed);
+        _sites[site].timed_evaluations += site_counters.timed_evaluations.load(std::memory_order_relaxed);
+        _sites[site].timed_cycles += site_counters.timed_cycles.load(std::memory_order_relaxed);
+        _sites[site].skipped_evaluations += site_counters.skipped_evaluations.load(std::memory_order_relaxed);
+    }
+    _threads.erase(std::find(_threads.begin(), _threads.end(), &counters));
+}
+
+/// @brief Returns the counters of the calling thread.
+/// @return The counters of the calling thread.
+inline ThreadCounters& thread_counters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+/// @brief Records the evaluation of an instrumented assertion. Counts the evaluation on construction and, if the
+/// evaluation is timed, records the elapsed cycles on destruction.
+///
+/// The scope only stores the identifier of the call site: the expression may reach an instrumented call site with a
+/// higher identifier for the first time, which grows and thus moves the counters of the thread.
+class InstrumentationScope {
+public:
+    /// @brief Counts the evaluation and starts the timer if this evaluation is timed.
+    /// @param site The identifier of the call site.
+    explicit InstrumentationScope(std::size_t const site) : _site(site), _start(0) {
+        SiteCounters&       counters    = thread_counters()[site];
+        std::uint64_t const evaluations = counters.evaluations.load(std::memory_order_relaxed);
+        counters.evaluations.store(evaluations + 1, std::memory_order_relaxed);
+        if constexpr (KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE > 0) {
+            if (evaluations % KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE == 0) {
+                _start = read_cycle_counter();
+            }
+        }
+    }
+
+    /// @brief Scopes cannot be copied.
+    InstrumentationScope(InstrumentationScope const&) = delete;
+
+    /// @brief Scopes cannot be copied.
+    /// @return This object.
+    InstrumentationScope& operator=(InstrumentationScope const&) = delete;
+
+    /// @brief Records the elapsed cycles if this evaluation is timed.
+    ~InstrumentationScope() {
+        if constexpr (KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE > 0) {
+            if (_start != 0) {
+                std::uint64_t const end      = read_cycle_counter();
+                SiteCounters&       counters = thread_counters()[_site];
+                SiteCounters::add(counters.timed_evaluations, 1);
+                SiteCounters::add(counters.timed_cycles, end - _start);
+            }
+        }
+    }
+
+private:
+    std::size_t   _site;  ///< @brief The identifier of the call site.
+    std::uint64_t _start; ///< @brief Cycle counter at the start of a timed evaluation, zero otherwise.
+};
+
+/// @brief Counts an evaluation of an instrumented assertion that was skipped because its estimated cost exceeded the
+/// cost budget of its level.
+/// @param site The identifier of the call site.
+inline void count_skipped_evaluation(std::size_t const site) {
+    SiteCounters::add(thread_counters()[site].skipped_evaluations, 1);
+}
+
+/// @brief Writes a field of the CSV report, quoting it if necessary.
+/// @param out The output stream.
+/// @param field The field.
+inline void write_csv_field(std::ostream& out, std::string_view const field) {
+    if (field.find_first_of(",\"\n") == std::string_view::npos) {
+        out << field;
+        return;
+    }
+    out << '"';
+    for (char const c: field) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Collects the statistics of all instrumented assertion call sites, aggregated over all threads. Only available
+/// if \c KASSERT_INSTRUMENTATION is defined.
+/// @return The statistics of all call sites, sorted by decreasing estimated cycles and evaluations.
+inline std::vector<AssertionSiteStatistics> instrumentation_statistics() {
+    return internal::instrumentation_registry().collect();
+}
+
+/// @brief Resets the statistics of all instrumented assertion call sites. Only available if \c KASSERT_INSTRUMENTATION
+/// is defined.
+inline void reset_instrumentation() {
+    internal::instrumentation_registry().reset();
+}
+
+/// @brief Prints the statistics of all instrumented assertion call sites, sorted by decreasing estimated cycles and
+/// evaluations. Only available if \c KASSERT_INSTRUMENTATION is defined.
+/// @param out The output stream.
+/// @param format The output format.
+inline void print_instrumentation_report(
+    std::ostream& out, InstrumentationReportFormat const format = InstrumentationReportFormat::table
+) {
+    std::vector<AssertionSiteStatistics> const statistics = instrumentation_statistics();
+
+    if (format == InstrumentationReportFormat::csv) {
+        out << "file,line,function,expression,level,evaluations,timed_evaluations,timed_cycles,estimated_cycles,"
+               "skipped_evaluations\n";
+        for (auto const& site: statistics) {
+            internal::write_csv_field(out, site.where.file);
+            out << ',' << site.where.row << ',';
+            internal::write_csv_field(out, site.where.function);
+            out << ',';
+            internal::write_csv_field(out, site.expression);
+            out << ',' << site.level << ',' << site.evaluations << ',' << site.timed_evaluations << ','
+                << site.timed_cycles << ',' << std::fixed << std::setprecision(0) << site.estimated_cycles()
+                << std::defaultfloat << ',' << site.skipped_evaluations << '\n';
+        }
+        return;
+    }
+
+    out << std::left << std::setw(16) << "evaluations" << std::setw(12) << "skipped" << std::setw(20)
+        << "estimated cycles" << std::setw(8) << "level"
+        << "location / expression\n";
+    for (auto const& site: statistics) {
+        out << std::left << std::setw(16) << site.evaluations << std::setw(12) << site.skipped_evaluations
+            << std::setw(20) << std::fixed << std::setprecision(0) << site.estimated_cycles() << std::defaultfloat
+            << std::setw(8) << site.level << site.where.file << ":" << site.where.row << ": " << site.expression
+            << "\n";
+    }
+}
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Prints the instrumentation report at program exit if requested by the environment variable
+/// \c KASSERT_INSTRUMENTATION_REPORT (either \c table or \c csv). The report is written to the file named by
+/// \c KASSERT_INSTRUMENTATION_REPORT_FILE, if set, and to \c std::cerr otherwise.
+inline void print_instrumentation_report_at_exit() {
+    char const* format_name = std::getenv("KASSERT_INSTRUMENTATION_REPORT");
+    if (format_name == nullptr) {
+        return;
+    }
+    auto const format = std::string_view(format_name) == "csv" ? InstrumentationReportFormat::csv
+                                                               : InstrumentationReportFormat::table;
+    if (char const* filename = std::getenv("KASSERT_INSTRUMENTATION_REPORT_FILE"); filename != nullptr) {
+        std::ofstream out(filename);
+        print_instrumentation_report(out, format);
+    } else {
+        print_instrumentation_report(std::cerr, format);
+    }
+}
+
+/// @brief Registers \c print_instrumentation_report_at_exit() with \c std::atexit() during static initialization.
+/// Since objects with thread storage duration of the main thread are destroyed before the handler runs, the report
+/// contains the counters of the main thread.
+[[maybe_unused]] inline bool const instrumentation_report_at_exit_registered =
+    (instrumentation_registry(), std::atexit(print_instrumentation_report_at_exit) == 0);
+} // namespace kassert::internal
@@ -0,0 +1,27 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Definitions of the non-template functions declared in \c kassert/kassert.hpp.
+///
+/// This header is included at the end of \c kassert/kassert.hpp unless \c KASSERT_RUNTIME_LIBRARY is defined, in which
+/// case it is compiled into the runtime library.
+
+#pragma once
+
+#include "kassert/kassert.hpp"
+
+namespace kassert::internal {
+KASSERT_KASSERT_HPP_INLINE bool
+evaluate_and_print_assertion(char const* type, bool result, SourceLocation const& where, char const* expr_str) {
+    if (!result) {
+        FdLogger logger(standard_error);
+        print_failed_assertion(logger, type, result, where, expr_str);
+        if (logger.record()) {
+            finish_record(logger);
+        }
+    }
+    return result;
+}
+} // namespace kassert::internal
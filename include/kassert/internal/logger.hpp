@@ -4,14 +4,29 @@
 
 /// @file
 /// @brief Logger utility class to build error messages for failed assertins.
+///
+/// This header only provides the logger for the error messages of failed assertions, which neither depends on iostreams
+/// nor on \c std::string. The logger for exception messages is provided by \c kassert/exception.hpp; the stream-based
+/// logger and the stringification of STL containers are provided by \c kassert/stream.hpp.
 
 #pragma once
 
-#include <ostream>
-#include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <type_traits>
 #include <utility>
-#include <vector>
+
+#include "kassert/internal/failure_handler.hpp"
+#include "kassert/internal/report_format.hpp"
+#include "kassert/internal/report_sink.hpp"
+#include "kassert/internal/runtime_library.hpp"
+
+/// @brief Size of the stack buffer (in bytes) used by loggers that write to a file descriptor. This includes the
+/// failure messages of KASSERT(). Longer messages are truncated.
+#ifndef KASSERT_LOGGER_BUFFER_SIZE
+    #define KASSERT_LOGGER_BUFFER_SIZE 4096
+#endif
 
 namespace kassert::internal {
 // If partially specialized template is not applicable, set value to false.
@@ -31,61 +46,347 @@ struct is_streamable_type_impl<
 /// @tparam ValueT A value type that may or may not be used with \c StreamT::operator<<.
 template <typename StreamT, typename ValueT>
 constexpr bool is_streamable_type = is_streamable_type_impl<StreamT, ValueT>::value;
+
+// If partially specialized template is not applicable, set value to false.
+template <typename, typename = void>
+struct is_string_like_impl : std::false_type {};
+
+// Partially specialize template if ValueT looks like a std::basic_string<char> or std::basic_string_view<char>.
+template <typename ValueT>
+struct is_string_like_impl<
+    ValueT,
+    std::void_t<
+        typename ValueT::traits_type,
+        decltype(std::declval<ValueT const&>().data()),
+        decltype(std::declval<ValueT const&>().size())>>
+    : std::bool_constant<
+          std::is_same_v<typename ValueT::traits_type::char_type, char>
+          && std::is_convertible_v<decltype(std::declval<ValueT const&>().data()), char const*>> {};
+
+/// @brief Determines whether \c ValueT is a string type such as \c std::string or \c std::string_view. Such types are
+/// detected by their members such that this header does not have to include \c <string>.
+/// @ingroup expression-expansion
+/// @tparam ValueT A value type.
+template <typename ValueT>
+constexpr bool is_string_like = is_string_like_impl<ValueT>::value;
+
+/// @brief Determines whether a value of type \c ValueT is formatted by \c NativeFormatter, i.e., without iostreams.
+/// This includes booleans, characters, integers, floating point numbers, unscoped enums, pointers and strings.
+/// @ingroup expression-expansion
+/// @tparam ValueT A value type.
+template <typename ValueT, typename DecayedT = std::decay_t<ValueT>>
+constexpr bool is_natively_formattable =
+    std::is_arithmetic_v<DecayedT> || (std::is_enum_v<DecayedT> && std::is_convertible_v<DecayedT, long long>)
+    || std::is_pointer_v<DecayedT> || std::is_same_v<DecayedT, std::nullptr_t> || is_string_like<DecayedT>;
+
+/// @brief Size of the buffers passed to \c format_number(), which is sufficient for integers in any base and for the
+/// shortest representation of floating point numbers.
+inline constexpr std::size_t number_buffer_size = 128;
+
+/// @brief Formats a signed integer in base 10 using \c std::to_chars.
+/// @param buffer Output buffer of size \c number_buffer_size.
+/// @param value The integer.
+/// @return The number of characters written.
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, long long value);
+
+/// @brief Formats an unsigned integer using \c std::to_chars.
+/// @param buffer Output buffer of size \c number_buffer_size.
+/// @param value The integer.
+/// @param base The base of the representation.
+/// @return The number of characters written.
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, unsigned long long value, int base);
+
+/// @brief Formats a floating point number using the shortest representation that round-trips.
+/// @param buffer Output buffer of size \c number_buffer_size.
+/// @param value The floating point number.
+/// @return The number of characters written.
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, float value);
+
+/// @copydoc format_number(char*, float)
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, double value);
+
+/// @copydoc format_number(char*, float)
+KASSERT_KASSERT_HPP_INLINE std::size_t format_number(char* buffer, long double value);
+
+/// @brief Base class of the loggers that format values without iostreams.
+///
+/// Booleans, characters, strings, integers, floating point numbers and pointers are formatted without allocating heap
+/// memory (see \c format_number()). The output matches the output of a
+/// \c std::ostream with \c std::boolalpha. The derived logger must provide a member `append(char const*, std::size_t)`
+/// that receives the formatted output.
+///
+/// @tparam LoggerT The derived logger.
+template <typename LoggerT>
+class NativeFormatter {
+public:
+    /// @brief Format all values for which \c is_natively_formattable is true.
+    /// @param value Value to be stringified.
+    /// @tparam ValueT Type of the value to be stringified.
+    /// @return The derived logger.
+    template <typename ValueT, std::enable_if_t<is_natively_formattable<ValueT>, int> = 0>
+    LoggerT& operator<<(ValueT const& value) {
+        using DecayedT = std::decay_t<ValueT>;
+
+        if constexpr (std::is_same_v<DecayedT, bool>) {
+            if (value) {
+                emit("true", 4);
+            } else {
+                emit("false", 5);
+            }
+        } else if constexpr (std::is_same_v<DecayedT, char> || std::is_same_v<DecayedT, signed char>
+                             || std::is_same_v<DecayedT, unsigned char>) {
+            char const character = static_cast<char>(value);
+            emit(&character, 1);
+        } else if constexpr (std::is_integral_v<DecayedT> || std::is_floating_point_v<DecayedT>) {
+            append_number(value);
+        } else if constexpr (std::is_enum_v<DecayedT>) {
+            append_number(static_cast<std::underlying_type_t<DecayedT>>(value));
+        } else if constexpr (std::is_same_v<DecayedT, char const*> || std::is_same_v<DecayedT, char*>) {
+            // copy first, comparing a char array against nullptr is diagnosed
+            char const* str = value;
+            if (str == nullptr) {
+                str = "(null)";
+            }
+            emit(str, std::strlen(str));
+        } else if constexpr (std::is_same_v<DecayedT, std::nullptr_t>) {
+            emit("nullptr", 7);
+        } else if constexpr (std::is_pointer_v<DecayedT> && std::is_function_v<std::remove_pointer_t<DecayedT>>) {
+            // std::ostream prints function pointers as booleans
+            return *this << (value != nullptr);
+        } else if constexpr (std::is_pointer_v<DecayedT>) {
+            char              digits[number_buffer_size];
+            std::size_t const length =
+                format_number(digits, static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(value)), 16);
+            emit("0x", 2);
+            emit(digits, length);
+        } else {
+            emit(value.data(), static_cast<std::size_t>(value.size()));
+        }
+        return static_cast<LoggerT&>(*this);
+    }
+
+protected:
+    /// @brief Only derived loggers can be constructed.
+    NativeFormatter() = default;
+
+private:
+    /// @brief Passes formatted output to the derived logger.
+    /// @param data The formatted output.
+    /// @param size The number of characters.
+    void emit(char const* data, std::size_t const size) {
+        static_cast<LoggerT&>(*this).append(data, size);
+    }
+
+    /// @brief Formats a number using the non-template overloads of \c format_number().
+    /// @tparam NumberT The integer or floating point type.
+    /// @param value The number.
+    template <typename NumberT>
+    void append_number(NumberT const value) {
+        char        digits[number_buffer_size];
+        std::size_t length = 0;
+        if constexpr (std::is_floating_point_v<NumberT>) {
+            length = format_number(digits, value);
+        } else if constexpr (std::is_signed_v<NumberT>) {
+            length = format_number(digits, static_cast<long long>(value));
+        } else {
+            length = format_number(digits, static_cast<unsigned long long>(value), 10);
+        }
+        emit(digits, length);
+    }
+};
+
+/// @brief Output target of a \c Logger that writes to a file descriptor, e.g., \c STDERR_FILENO.
+struct KASSERT_KASSERT_HPP_ATTRIBUTE_CONFIGURATION_TAG FileDescriptor {
+    int fd; ///< @brief The file descriptor.
+};
+
+/// @brief File descriptor of the standard error stream.
+inline constexpr FileDescriptor standard_error{2};
+
+/// @brief Writes a buffer to a file descriptor. The buffer is written with a single `write(2)` call unless the call is
+/// interrupted or only writes parts of the buffer, in which case the remaining bytes are written by further calls.
+/// @param out The file descriptor.
+/// @param data The buffer.
+/// @param size The number of bytes to be written.
+KASSERT_KASSERT_HPP_INLINE void write_to(FileDescriptor out, char const* data, std::size_t size);
+
+/// @brief Submits the report of a failed assertion: reports for the standard error stream are passed to the installed
+/// report sink (see \c kassert::set_report_sink()), if any. Otherwise, the report is written to the file descriptor.
+/// @param out The file descriptor.
+/// @param data The report.
+/// @param size The length of the report.
+/// @param severity The severity of the report.
+KASSERT_KASSERT_HPP_INLINE void
+submit_report(FileDescriptor out, char const* data, std::size_t size, ReportSeverity severity);
 } // namespace kassert::internal
 
 namespace kassert {
-/// @brief Simple wrapper for output streams that is used to stringify values in assertions and exceptions.
+/// @brief Simple wrapper for output targets that is used to stringify values in assertions and exceptions.
 ///
 /// To enable stringification for custom types, overload the \c << operator of this class.
-/// The library overloads this operator for the following STL types:
+/// The library provides the following specializations, which do not depend on iostreams:
+///
+/// * \c Logger<internal::FileDescriptor> prints the error messages of failed assertions (defined in this header).
+/// * \c Logger<std::string> builds the error messages of exceptions (defined in \c kassert/exception.hpp).
 ///
-/// * \c std::vector<T>
-/// * \c std::pair<K, V>
+/// The primary template, which wraps an output stream, and the overloads for STL types are defined in
+/// \c kassert/stream.hpp.
 ///
-/// @tparam StreamT The underlying streaming object (e.g., \c std::ostream or \c std::ostringstream).
+/// @tparam StreamT The underlying output target.
 template <typename StreamT>
-class Logger {
+class Logger;
+
+/// @brief Logger that formats all values into a fixed-size stack buffer and writes the buffer to a file descriptor
+/// with a single `write(2)` call. This logger is used to print the error messages of failed assertions. Output for the
+/// standard error stream is passed to the installed report sink instead, if any (see \c kassert::set_report_sink()).
+///
+/// Since built-in types are formatted by \c internal::NativeFormatter, the error message of a failed assertion can be
+/// printed even if the heap is exhausted or corrupted. Other types are formatted using the overloads of the \c <<
+/// operator for this class (see \c Logger) or, if \c kassert/stream.hpp is included, using a \c std::ostringstream as
+/// last resort.
+///
+/// If the formatted output exceeds the size of the buffer (see \c KASSERT_LOGGER_BUFFER_SIZE), the output is truncated
+/// and marked as such.
+template <>
+class Logger<internal::FileDescriptor> : public internal::NativeFormatter<Logger<internal::FileDescriptor>> {
 public:
-    /// @brief Construct the object with an underlying streaming object.
-    /// @param out The underlying streaming object.
-    explicit Logger(StreamT&& out) : _out_buffer(), _out(std::forward<StreamT>(out)) {
-        _out_buffer << std::boolalpha;
+    /// @brief Construct the object with the file descriptor to write to.
+    /// @param out The file descriptor.
+    /// @param severity Severity of the output, which is passed to the report sink.
+    explicit Logger(internal::FileDescriptor const out, ReportSeverity const severity = ReportSeverity::fatal)
+        : _size(0),
+          _truncated(false),
+          _record(false),
+          _escaping(false),
+          _has_level(false),
+          _level(0),
+          _out(out),
+          _severity(severity) {}
+
+    /// @brief Loggers cannot be copied.
+    Logger(Logger const&) = delete;
+
+    /// @brief Loggers cannot be copied.
+    /// @return This logger.
+    Logger& operator=(Logger const&) = delete;
+
+    /// @brief Writes the buffered output to the file descriptor (or report sink) and clears the buffer. Does nothing if
+    /// the buffer is empty.
+    KASSERT_KASSERT_HPP_INLINE void flush();
+
+    /// @brief Clears the buffer without writing it to the file descriptor. The discarded output, terminated with the
+    /// truncation marker if it was truncated, stays valid until the next output.
+    /// @return The length of the discarded output, which starts at \c data().
+    KASSERT_KASSERT_HPP_INLINE std::size_t discard();
+
+    /// @brief Returns the buffer.
+    /// @return The buffered (or just discarded) output, which is not null-terminated.
+    [[nodiscard]] char const* data() const {
+        return _buffer;
     }
 
-    /// @brief Forward all values for which \c StreamT::operator<< is defined to the underlying streaming object.
-    /// @param value Value to be stringified.
-    /// @tparam ValueT Type of the value to be stringified.
-    template <typename ValueT, std::enable_if_t<internal::is_streamable_type<std::ostream, ValueT>, int> = 0>
-    Logger<StreamT>& operator<<(ValueT&& value) {
-        // we buffer logged values and only flush when the destructor is called or the buffer is flushed manually
-        // this prevents interleaving of the outputs of multiple processes (e.g. MPI ranks)
-        _out_buffer << std::forward<ValueT>(value);
-        return *this;
+    /// @brief Returns the number of buffered bytes.
+    /// @return The number of bytes that were logged since the last flush (at most the capacity of the buffer).
+    [[nodiscard]] std::size_t size() const {
+        return _size;
     }
 
-    /// @brief Get the underlying streaming object.
-    /// Flushes all buffered logs to the underlying stream before returning a reference to the stream.
-    /// @return The underlying streaming object.
-    StreamT&& stream() {
-        flush();
-        return std::forward<StreamT>(_out);
+    /// @brief Returns the severity of the output.
+    /// @return The severity, which is passed to the report sink.
+    [[nodiscard]] ReportSeverity severity() const {
+        return _severity;
     }
 
-    /// @brief Flushes all buffered logs to the underlying stream.
-    void flush() {
-        _out << _out_buffer.str() << std::flush;
-        _out_buffer.str(std::string{});
+    /// @brief Returns whether the output was truncated.
+    /// @return Whether output was truncated since the last flush.
+    [[nodiscard]] bool truncated() const {
+        return _truncated;
     }
 
-    /// @brief Destructor of the logger stream, which flushes all buffered logs to the underlying stream upon
-    /// destruction.
+    /// @brief Marks the output as a JSON record (see \c kassert::ReportFormat::json) until the next flush. Truncated
+    /// records are not terminated with the truncation marker, since the record reports the truncation itself.
+    void begin_record() {
+        _record = true;
+    }
+
+    /// @brief Returns whether the output is a JSON record.
+    /// @return Whether \c begin_record() was called since the last flush.
+    [[nodiscard]] bool record() const {
+        return _record;
+    }
+
+    /// @brief Starts or ends the contents of a JSON string. While the contents of a string are written, the output is
+    /// escaped and truncated early enough that the record can still be completed.
+    /// @param escaping Whether the following output is the contents of a JSON string.
+    void set_escaping(bool const escaping) {
+        _escaping = escaping;
+    }
+
+    /// @brief Returns whether the contents of a JSON string are written.
+    /// @return Whether the output is escaped.
+    [[nodiscard]] bool escaping() const {
+        return _escaping;
+    }
+
+    /// @brief Sets the level of the failed assertion, which is reported by JSON records.
+    /// @param level The assertion level.
+    void set_level(int const level) {
+        _has_level = true;
+        _level     = level;
+    }
+
+    /// @brief Returns the level of the failed assertion, if it was set.
+    /// @param level Set to the assertion level if it was set since the last flush.
+    /// @return Whether the level was set.
+    bool level(int& level) const {
+        level = _level;
+        return _has_level;
+    }
+
+    /// @brief Destructor of the logger, which writes the buffered output to the file descriptor.
     ~Logger() {
         flush();
     }
 
 private:
-    std::stringstream _out_buffer; ///> @brief The output buffer.
-    StreamT&&         _out;        ///> @brief The underlying streaming object.
+    friend class internal::NativeFormatter<Logger>;
+
+    /// @brief Marker that is appended to truncated output.
+    static constexpr char truncation_marker[] = " [...] (truncated)\n";
+
+    /// @brief Length of the truncation marker.
+    static constexpr std::size_t truncation_marker_size = sizeof(truncation_marker) - 1;
+
+    /// @brief Number of bytes in the buffer that can be used for output.
+    static constexpr std::size_t capacity = KASSERT_LOGGER_BUFFER_SIZE - truncation_marker_size;
+
+    /// @brief Number of bytes of the buffer that the contents of JSON strings leave for completing the record.
+    static constexpr std::size_t record_reserve = 256;
+
+    static_assert(KASSERT_LOGGER_BUFFER_SIZE > 2 * truncation_marker_size, "KASSERT_LOGGER_BUFFER_SIZE is too small");
+    static_assert(capacity > 2 * record_reserve, "KASSERT_LOGGER_BUFFER_SIZE is too small for JSON records");
+
+    /// @brief Appends a string to the buffer, truncating it if the buffer is full.
+    /// @param data The string.
+    /// @param size The length of the string.
+    KASSERT_KASSERT_HPP_INLINE void append(char const* data, std::size_t size);
+
+    /// @brief Appends the contents of a JSON string to the buffer, escaping quotes, backslashes and control characters.
+    /// Bytes that are not part of a well-formed UTF-8 sequence are replaced by U+FFFD. Truncates the contents if less
+    /// than \c record_reserve bytes would be left, but never within a UTF-8 sequence.
+    /// @param data The string.
+    /// @param size The length of the string.
+    KASSERT_KASSERT_HPP_INLINE void append_escaped(char const* data, std::size_t size);
+
+    char                     _buffer[KASSERT_LOGGER_BUFFER_SIZE]; ///< @brief The output buffer.
+    std::size_t              _size;                               ///< @brief Number of bytes in the buffer.
+    bool                     _truncated;                          ///< @brief Whether output was truncated.
+    bool                     _record;                             ///< @brief Whether the output is a JSON record.
+    bool                     _escaping;                           ///< @brief Whether the output is escaped.
+    bool                     _has_level;                          ///< @brief Whether \c _level was set.
+    int                      _level;                              ///< @brief Level of the failed assertion.
+    internal::FileDescriptor _out;                                ///< @brief The file descriptor to write to.
+    ReportSeverity           _severity;                           ///< @brief Severity of the output.
 };
 } // namespace kassert
 
@@ -108,57 +409,9 @@ void stringify_value(Logger<StreamT>& out, ValueT const& value) {
     }
 }
 
-/// @brief Logger writing all output to a \c std::ostream. This specialization is used to generate the KASSERT error
-/// messages.
-using OStreamLogger = Logger<std::ostream&>;
-
-/// @brief Logger writing all output to a rvalue \c std::ostringstream. This specialization is used to generate the
-/// custom error message for THROWING_KASSERT exceptions.
-using RrefOStringstreamLogger = Logger<std::ostringstream&&>;
+/// @brief Logger formatting all output into a fixed-size stack buffer that is written to a file descriptor. This
+/// specialization is used to generate the KASSERT error messages.
+using FdLogger = Logger<FileDescriptor>;
 
 /// @}
 } // namespace kassert::internal
-
-namespace kassert {
-
-/// @brief Stringification of `std::vector<T>` in assertions.
-///
-/// Outputs a `std::vector<T>` in the following format, where `element i` are the stringified elements of the
-/// vector: `[element 1, element 2, ...]`
-///
-/// @tparam StreamT The underlying output stream of the Logger.
-/// @tparam ValueT The type of the elements contained in the vector.
-/// @tparam AllocatorT The allocator of the vector.
-/// @param logger The assertion logger.
-/// @param container The vector to be stringified.
-/// @return The stringified vector as described above.
-template <typename StreamT, typename ValueT, typename AllocatorT>
-Logger<StreamT>& operator<<(Logger<StreamT>& logger, std::vector<ValueT, AllocatorT> const& container) {
-    logger << "[";
-    bool first = true;
-    for (auto const& element: container) {
-        if (!first) {
-            logger << ", ";
-        }
-        logger << element;
-        first = false;
-    }
-    return logger << "]";
-}
-
-/// @brief Stringification of `std::pair<K, V>` in assertions.
-///
-/// Outputs a `std::pair<K, V>` in the following format, where `first` and `second` are the stringified
-/// components of the pair: `(first, second)`.
-///
-/// @tparam StreamT The underlying output stream of the Logger.
-/// @tparam Key Type of the first component of the pair.
-/// @tparam Value Type of the second component of the pair.
-/// @param logger The assertion logger.
-/// @param pair The pair to be stringified.
-/// @return The stringification of the pair as described above.
-template <typename StreamT, typename Key, typename Value>
-Logger<StreamT>& operator<<(Logger<StreamT>& logger, std::pair<Key, Value> const& pair) {
-    return logger << "(" << pair.first << ", " << pair.second << ")";
-}
-} // namespace kassert
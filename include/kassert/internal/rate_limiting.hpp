@@ -0,0 +1,51 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Per-call-site rate limiting of non-fatal assertions, i.e., KASSERT_WARN().
+
+#pragma once
+
+#include <cstdint>
+
+#ifndef KASSERT_WARNING_BURST
+    /// @brief Number of failures of a KASSERT_WARN() call site that are reported by each thread before reports are
+    /// backed off exponentially.
+    #define KASSERT_WARNING_BURST 8
+#endif
+
+namespace kassert::internal {
+/// @brief Rate limiter of a non-fatal assertion: reports the first \c burst failures and afterwards only every failure
+/// whose number is a power of two, i.e., the number of reports grows logarithmically with the number of failures.
+///
+/// Each call site of a non-fatal assertion owns a `static thread_local` instance of this class, which is only accessed
+/// on the failure path. Since the class is trivial and zero-initialized, accessing the instance requires no
+/// initialization guard and no synchronization between threads, thus a storm of warnings never contends on a lock.
+struct WarningLimiter {
+    /// @brief Number of failures so far.
+    std::uint64_t failures;
+    /// @brief Number of failures that were suppressed since the last report.
+    std::uint64_t suppressed;
+
+    /// @brief Counts a failure and decides whether it is reported.
+    /// @param burst Number of failures that are always reported.
+    /// @return Whether the failure should be reported.
+    bool report(std::uint64_t const burst) {
+        ++failures;
+        if (failures <= burst || (failures & (failures - 1)) == 0) {
+            return true;
+        }
+        ++suppressed;
+        return false;
+    }
+
+    /// @brief Returns the number of failures that were suppressed since the last report and resets it.
+    /// @return The number of suppressed failures.
+    std::uint64_t take_suppressed() {
+        std::uint64_t const count = suppressed;
+        suppressed                = 0;
+        return count;
+    }
+};
+} // namespace kassert::internal
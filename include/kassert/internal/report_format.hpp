@@ -0,0 +1,93 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Format of the reports of failed assertions and the MPI rank they report.
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+namespace kassert {
+/// @brief Format of the reports of failed assertions.
+enum class ReportFormat {
+    /// @brief Multi-line text for humans (default).
+    text,
+    /// @brief One single-line JSON object per report, terminated by a newline, for log pipelines. See
+    /// \c kassert::set_report_format().
+    json
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The format of the reports of failed assertions. Set to \c ReportFormat::json by default if
+/// \c KASSERT_JSON_REPORTS is defined.
+#ifdef KASSERT_JSON_REPORTS
+inline std::atomic<ReportFormat> installed_report_format{ReportFormat::json};
+#else
+inline std::atomic<ReportFormat> installed_report_format{ReportFormat::text};
+#endif
+
+/// @brief Reads the MPI rank from the environment variables set by common MPI launchers.
+/// @return The rank, or a negative number if it is unknown.
+inline int mpi_rank_from_environment() {
+    for (char const* variable: {"OMPI_COMM_WORLD_RANK", "PMIX_RANK", "PMI_RANK", "MV2_COMM_WORLD_RANK"}) {
+        char const* const value = std::getenv(variable);
+        if (value == nullptr) {
+            continue;
+        }
+        char const* const end    = value + std::strlen(value);
+        int               rank   = -1;
+        auto const        result = std::from_chars(value, end, rank);
+        if (value != end && result.ec == std::errc{} && result.ptr == end && rank >= 0) {
+            return rank;
+        }
+    }
+    return -1;
+}
+
+/// @brief The MPI rank reported by JSON reports and crash reports, or a negative number if unknown. Read from the
+/// environment during static initialization.
+inline std::atomic<int> report_rank{mpi_rank_from_environment()};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Sets the format of the reports of failed assertions.
+///
+/// In the JSON format, each failed assertion produces a single line
+///
+/// ```
+/// {"severity":"fatal","type":"ASSERTION","file":"a.cpp","line":42,"function":"int main()","expression":"lhs == rhs",
+///  "relation":"==","operands":["2","3"],"message":"user message","level":30,"thread":4711,"rank":0}
+/// ```
+///
+/// which is formatted into the same stack buffer as the text format and submitted to the report sink (see
+/// \c kassert::set_report_sink()) or written to the standard error stream with a single call. `relation` and
+/// `operands` are only present if the expression was decomposed, `level` if the level of the assertion is known,
+/// `rank` if the MPI rank is known (see \c kassert::set_report_rank()), and `truncated` if the record exceeded the
+/// buffer; non-fatal assertions additionally report the number of `suppressed` and total `failures`. The `message`
+/// contains all output after the expression, i.e., the user message and details such as the first mismatch of range
+/// assertions.
+/// @param format The new format.
+/// @return The previous format.
+inline ReportFormat set_report_format(ReportFormat const format) {
+    return internal::installed_report_format.exchange(format, std::memory_order_relaxed);
+}
+
+/// @brief Returns the format of the reports of failed assertions.
+/// @return The format.
+inline ReportFormat report_format() {
+    return internal::installed_report_format.load(std::memory_order_relaxed);
+}
+
+/// @brief Sets the MPI rank reported by JSON reports (see \c kassert::set_report_format()) and crash reports (see
+/// \c kassert/crash_report.hpp). By default, the rank is read from the environment variables of common MPI launchers.
+/// @param rank The rank, or a negative number if it is unknown.
+inline void set_report_rank(int const rank) {
+    internal::report_rank.store(rank, std::memory_order_relaxed);
+}
+} // namespace kassert
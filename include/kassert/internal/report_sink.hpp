@@ -0,0 +1,80 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Pluggable destination of the reports of failed assertions.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace kassert {
+/// @brief Severity of a report of a failed assertion.
+enum class ReportSeverity {
+    /// @brief Report of a non-fatal assertion, e.g., KASSERT_WARN(). The program continues.
+    warning,
+    /// @brief Report of a fatal assertion, e.g., KASSERT(). The program is aborted after the report was submitted.
+    fatal
+};
+
+/// @brief Destination of the reports of failed assertions, which are written to the standard error stream by default.
+///
+/// Install a sink with \c kassert::set_report_sink() to redirect the reports, e.g., to a logging framework or to
+/// \c kassert::AsyncReportSink (see \c kassert/async_report_sink.hpp), which writes non-fatal reports from a
+/// background thread.
+class ReportSink {
+public:
+    /// @brief Destroys the sink.
+    virtual ~ReportSink() = default;
+
+    /// @brief Receives the report of a failed assertion. May be called concurrently by multiple threads.
+    ///
+    /// Fatal reports must be written before this function returns, together with all non-fatal reports that were
+    /// received before, since the program is aborted afterwards.
+    /// @param data The formatted report, which is not null-terminated.
+    /// @param size The length of the report.
+    /// @param severity The severity of the report.
+    virtual void write(char const* data, std::size_t size, ReportSeverity severity) = 0;
+
+    /// @brief Writes all reports that were received so far. Called before the program is terminated by other means
+    /// than a fatal report, e.g., by \c MPI_Abort().
+    virtual void flush() {}
+
+protected:
+    /// @brief Only derived sinks can be constructed.
+    ReportSink() = default;
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The installed report sink, or \c nullptr if reports are written to the standard error stream.
+inline std::atomic<ReportSink*> installed_report_sink{nullptr};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Installs the sink that receives the reports of all failed assertions that are otherwise written to the
+/// standard error stream.
+///
+/// The sink must outlive all assertions that may fail while it is installed, including assertions that are evaluated
+/// concurrently by other threads.
+/// @param sink The new sink, or \c nullptr to write reports to the standard error stream.
+/// @return The previously installed sink, or \c nullptr.
+inline ReportSink* set_report_sink(ReportSink* const sink) {
+    return internal::installed_report_sink.exchange(sink, std::memory_order_acq_rel);
+}
+
+/// @brief Returns the installed report sink.
+/// @return The installed sink, or \c nullptr if reports are written to the standard error stream.
+inline ReportSink* report_sink() {
+    return internal::installed_report_sink.load(std::memory_order_acquire);
+}
+
+/// @brief Writes all reports that the installed report sink received so far (see \c kassert::ReportSink::flush()).
+inline void flush_reports() {
+    if (ReportSink* const sink = report_sink(); sink != nullptr) {
+        sink->flush();
+    }
+}
+} // namespace kassert
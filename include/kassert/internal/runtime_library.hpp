@@ -0,0 +1,50 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Configuration of the optional compiled runtime library.
+///
+/// By default, KAssert is header-only and the non-template functions on the failure path of assertions are defined
+/// inline in every translation unit. If \c KASSERT_RUNTIME_LIBRARY is defined (which is done by linking the CMake
+/// target \c kassert::runtime), these functions are only declared in the headers and defined once in the library.
+/// Their definitions are in the `*_impl.hpp` headers, which are either included at the end of the public headers or
+/// compiled into the library.
+
+#pragma once
+
+#ifdef KASSERT_RUNTIME_LIBRARY
+    /// @brief Linkage of functions that are defined in the runtime library.
+    #define KASSERT_KASSERT_HPP_INLINE
+#else
+    /// @brief Linkage of functions that are defined in the runtime library.
+    #define KASSERT_KASSERT_HPP_INLINE inline
+#endif
+
+// The runtime library depends on the configuration below. If it is linked, the configuration is encoded in an ABI tag
+// of \c FileDescriptor and thus in the mangled names of all functions that take a \c FileDescriptor or a \c FdLogger,
+// such that linking a runtime library that was compiled with a different configuration fails instead of corrupting
+// memory. CMake compiles the library with the configuration of the target \c kassert::kassert.
+#if defined(KASSERT_RUNTIME_LIBRARY) && (defined(__GNUC__) || defined(__clang__))
+    #ifdef KASSERT_JSON_REPORTS
+        /// @brief Whether failed assertions are reported as JSON records by default.
+        #define KASSERT_KASSERT_HPP_JSON_REPORTS 1
+    #else
+        /// @brief Whether failed assertions are reported as JSON records by default.
+        #define KASSERT_KASSERT_HPP_JSON_REPORTS 0
+    #endif
+    /// @brief Formats the ABI tag of the configuration.
+    #define KASSERT_KASSERT_HPP_CONFIGURATION_TAG_IMPL(buffer_size, json_reports, grace_period) \
+        "kassert_buffer" #buffer_size "_json" #json_reports "_grace" #grace_period
+    /// @brief Formats the ABI tag of the configuration after expanding its macros.
+    #define KASSERT_KASSERT_HPP_CONFIGURATION_TAG(buffer_size, json_reports, grace_period) \
+        KASSERT_KASSERT_HPP_CONFIGURATION_TAG_IMPL(buffer_size, json_reports, grace_period)
+    /// @brief Attribute that encodes the configuration of the runtime library in the mangled names of a type.
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_CONFIGURATION_TAG                                               \
+        [[gnu::abi_tag(KASSERT_KASSERT_HPP_CONFIGURATION_TAG(                                             \
+            KASSERT_LOGGER_BUFFER_SIZE, KASSERT_KASSERT_HPP_JSON_REPORTS, KASSERT_FAILURE_GRACE_PERIOD_MS \
+        ))]]
+#else
+    /// @brief Attribute that encodes the configuration of the runtime library in the mangled names of a type.
+    #define KASSERT_KASSERT_HPP_ATTRIBUTE_CONFIGURATION_TAG
+#endif
@@ -0,0 +1,132 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Per-call-site counters used to implement sampled assertions, i.e., KASSERT_SAMPLED() and
+/// KASSERT_SAMPLED_RANDOMIZED().
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "kassert/internal/assertion_macros.hpp"
+
+namespace kassert::internal {
+/// @brief Largest sampling rate of KASSERT_SAMPLED() and KASSERT_SAMPLED_RANDOMIZED(). The randomized sampler skips up
+/// to `2 * (rate - 1)` evaluations, which must fit into its 32-bit countdown.
+constexpr std::uint32_t max_sampling_rate = std::uint32_t{1} << 31;
+
+/// @brief Checks if a sampling rate is in the valid range `[1, max_sampling_rate]`.
+/// @tparam RateT The integral type of the rate.
+/// @param rate The sampling rate.
+/// @return Whether the rate is valid.
+template <typename RateT>
+constexpr bool valid_sampling_rate(RateT const rate) {
+    static_assert(std::is_integral_v<RateT>, "the sampling rate must be an integer");
+    return rate >= RateT{1} && static_cast<std::uint64_t>(rate) <= max_sampling_rate;
+}
+
+/// @brief Clamps a sampling rate to the valid range `[1, max_sampling_rate]`, such that non-positive rates sample
+/// every evaluation instead of wrapping around to a huge rate that effectively disables the assertion. Constant rates
+/// outside of the range are rejected at compile time (see KASSERT_KASSERT_HPP_KASSERT_SAMPLED_IMPL).
+/// @tparam RateT The integral type of the rate.
+/// @param rate The sampling rate.
+/// @return The clamped sampling rate.
+template <typename RateT>
+constexpr std::uint32_t clamp_sampling_rate(RateT const rate) {
+    static_assert(std::is_integral_v<RateT>, "the sampling rate must be an integer");
+    if (rate < RateT{1}) {
+        return 1;
+    }
+    if (static_cast<std::uint64_t>(rate) > max_sampling_rate) {
+        return max_sampling_rate;
+    }
+    return static_cast<std::uint32_t>(rate);
+}
+
+/// @brief Deterministic sampler: selects the first and then every \c rate-th evaluation of an assertion.
+///
+/// Each call site of a sampled assertion owns a `static thread_local` instance of this class. Since the class is
+/// trivial and zero-initialized, accessing the instance requires no initialization guard, no atomic operations and no
+/// shared cache lines.
+struct Sampler {
+    /// @brief Number of evaluations to skip before the next sample. A value of zero selects the next evaluation.
+    std::uint32_t countdown;
+
+    /// @brief Decides whether the current evaluation of the assertion is sampled.
+    /// @tparam RateT The integral type of the rate.
+    /// @param rate Sample every \c rate-th evaluation, clamped to `[1, max_sampling_rate]`.
+    /// @return Whether the assertion should be evaluated.
+    template <typename RateT>
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE bool sample(RateT const rate) {
+        if (KASSERT_KASSERT_HPP_UNLIKELY(countdown == 0)) {
+            countdown = clamp_sampling_rate(rate) - 1;
+            return true;
+        }
+        --countdown;
+        return false;
+    }
+};
+
+/// @brief State of the per-thread pseudo random number generator used by \c RandomizedSampler. Zero means that the
+/// generator has not been seeded yet.
+inline thread_local std::uint64_t sampling_random_state = 0;
+
+/// @brief Returns the next number of the per-thread pseudo random number generator (xorshift64*).
+///
+/// The generator is lazily seeded with the address of the thread-local state, which differs between threads.
+/// @return A pseudo random number.
+inline std::uint64_t next_sampling_random_number() {
+    std::uint64_t state = sampling_random_state;
+    if (state == 0) {
+        // splitmix64 finalizer to spread the bits of the address; multiply instead of adding the increment, which the
+        // compiler could otherwise fold into the (32-bit) offset of the thread-local relocation
+        state = reinterpret_cast<std::uintptr_t>(&sampling_random_state) * 0x9E3779B97F4A7C15ull;
+        state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ull;
+        state = (state ^ (state >> 27)) * 0x94D049BB133111EBull;
+        state = (state ^ (state >> 31)) | 1;
+    }
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    sampling_random_state = state;
+    return state * 0x2545F4914F6CDD1Dull;
+}
+
+/// @brief Randomized sampler: selects the first evaluation of an assertion and afterwards skips a uniformly random
+/// number of evaluations in `[0, 2 * (rate - 1)]`, i.e., on average every \c rate-th evaluation is sampled.
+///
+/// In contrast to \c Sampler, the sampled evaluations do not follow a fixed stride and thus cannot alias with
+/// periodic patterns in the checked data. The random number generator is only advanced when a sample is taken.
+struct RandomizedSampler {
+    /// @brief Number of evaluations to skip before the next sample. A value of zero selects the next evaluation.
+    std::uint32_t countdown;
+
+    /// @brief Decides whether the current evaluation of the assertion is sampled.
+    /// @tparam RateT The integral type of the rate.
+    /// @param rate Sample every \c rate-th evaluation on average, clamped to `[1, max_sampling_rate]`.
+    /// @return Whether the assertion should be evaluated.
+    template <typename RateT>
+    KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE bool sample(RateT const rate) {
+        if (KASSERT_KASSERT_HPP_UNLIKELY(countdown == 0)) {
+            std::uint32_t const clamped = clamp_sampling_rate(rate);
+            countdown                   = clamped > 1 ? draw_countdown(clamped) : 0;
+            return true;
+        }
+        --countdown;
+        return false;
+    }
+
+private:
+    /// @brief Draws the number of evaluations to skip before the next sample.
+    /// @param rate The average sampling rate, must be greater than \c 1.
+    /// @return A uniformly random number in `[0, 2 * (rate - 1)]`.
+    static std::uint32_t draw_countdown(std::uint32_t const rate) {
+        std::uint64_t const range = 2 * (static_cast<std::uint64_t>(rate) - 1) + 1;
+        // multiply-shift instead of modulo to map the upper 32 random bits to [0, range)
+        return static_cast<std::uint32_t>(((next_sampling_random_number() >> 32) * range) >> 32);
+    }
+};
+} // namespace kassert::internal
@@ -0,0 +1,20 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Description of the source code location of an assertion.
+
+#pragma once
+
+namespace kassert::internal {
+/// @brief Describes a source code location.
+struct SourceLocation {
+    /// @brief Filename.
+    char const* file;
+    /// @brief Line number.
+    unsigned row;
+    /// @brief Function name.
+    char const* function;
+};
+} // namespace kassert::internal
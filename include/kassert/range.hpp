@@ -0,0 +1,971 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Assertions on ranges that report the first violating element instead of the whole ranges.
+///
+/// `KASSERT(a == b)` on two large vectors prints both vectors in full if it fails. The assertions in this header
+/// instead print the index of the first violating element and a small window of elements around it (see
+/// \c KASSERT_RANGE_CONTEXT). For contiguous ranges of integers, enums and pointers, the checks use \c std::memcmp or
+/// branchless block-wise kernels that the compiler can vectorize; the violating element is only searched for once the
+/// check failed.
+///
+/// Large contiguous ranges can be checked in parallel by installing a \c kassert::RangeExecutor.
+///
+/// This header is not included by \c kassert/kassert.hpp.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(_OPENMP)
+    #include <omp.h>
+#endif
+
+#include "kassert/kassert.hpp"
+
+#ifndef KASSERT_PARALLEL_RANGE_MIN_SIZE
+    /// @brief Default minimum number of elements of contiguous ranges that range assertions check in parallel if a
+    /// range executor is installed (see \c kassert::RangeExecutor).
+    #define KASSERT_PARALLEL_RANGE_MIN_SIZE (1 << 20)
+#endif
+
+#ifndef KASSERT_RANGE_CONTEXT
+    /// @brief Number of elements before and after the violating element that are printed by failed range assertions.
+    #define KASSERT_RANGE_CONTEXT 3
+#endif
+
+/// @brief Asserts that two ranges are element-wise equal. Accepts between two and four parameters.
+/// @ingroup assertion
+///
+/// The assertion holds if both ranges have the same size and all pairs of elements compare equal with \c ==. If it
+/// fails, the index of the first mismatch and the elements around it are printed instead of both ranges.
+///
+/// The macro accepts 2 to 4 parameters:
+/// 1. The left-hand range (mandatory).
+/// 2. The right-hand range (mandatory).
+/// 3. Error message that is printed in addition to the first mismatch (optional).
+/// 4. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_RANGE_EQ(lhs, ...)            \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3(      \
+        ,                                     \
+        __VA_ARGS__,                          \
+        KASSERT_RANGE_EQ_3(lhs, __VA_ARGS__), \
+        KASSERT_RANGE_EQ_2(lhs, __VA_ARGS__), \
+        KASSERT_RANGE_EQ_1(lhs, __VA_ARGS__), \
+        ignore                                \
+    )
+
+/// @brief Asserts that a range is sorted in non-descending order with respect to \c <. Accepts between one and three
+/// parameters.
+/// @ingroup assertion
+///
+/// If the assertion fails, the first element that is smaller than its predecessor and the elements around it are
+/// printed.
+///
+/// The macro accepts 1 to 3 parameters:
+/// 1. The range (mandatory).
+/// 2. Error message that is printed in addition to the violating element (optional).
+/// 3. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_SORTED(...)              \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_SORTED_3(__VA_ARGS__),   \
+        KASSERT_SORTED_2(__VA_ARGS__),   \
+        KASSERT_SORTED_1(__VA_ARGS__),   \
+        ignore                           \
+    )
+
+/// @brief Asserts that a predicate holds for all elements of a range. Accepts between two and four parameters.
+/// @ingroup assertion
+///
+/// If the assertion fails, the first element for which the predicate does not hold and the elements around it are
+/// printed. The predicate must be free of side effects: for contiguous ranges of integers, enums and pointers, it is
+/// evaluated block-wise without branches and may thus be called for elements after the first violating element. If a
+/// range executor is installed (see \c kassert::set_range_executor()), the predicate is called concurrently for large
+/// contiguous ranges and must be thread-safe.
+///
+/// The macro accepts 2 to 4 parameters:
+/// 1. The range (mandatory).
+/// 2. The unary predicate (mandatory).
+/// 3. Error message that is printed in addition to the violating element (optional).
+/// 4. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_ALL_OF(range, ...)            \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3(      \
+        ,                                     \
+        __VA_ARGS__,                          \
+        KASSERT_ALL_OF_3(range, __VA_ARGS__), \
+        KASSERT_ALL_OF_2(range, __VA_ARGS__), \
+        KASSERT_ALL_OF_1(range, __VA_ARGS__), \
+        ignore                                \
+    )
+
+/// @brief Asserts that all elements of a range are pairwise distinct. Accepts between one and three parameters.
+/// @ingroup assertion
+///
+/// Elements are compared with \c < and \c ==, where \c < must be a strict weak ordering. The check sorts a copy of the
+/// range (or of pointers to its elements), i.e., it takes `O(n log n)` time and `O(n)` additional memory, and is always
+/// evaluated by the calling thread. If the assertion fails, the first element that equals an earlier element is
+/// printed together with the earlier element.
+///
+/// The macro accepts 1 to 3 parameters:
+/// 1. The range (mandatory).
+/// 2. Error message that is printed in addition to the duplicate elements (optional).
+/// 3. The level of the assertion (optional, default: `kassert::assert::normal`, see @ref assertion-levels).
+#define KASSERT_UNIQUE(...)              \
+    KASSERT_KASSERT_HPP_VARARG_HELPER_3( \
+        ,                                \
+        __VA_ARGS__,                     \
+        KASSERT_UNIQUE_3(__VA_ARGS__),   \
+        KASSERT_UNIQUE_2(__VA_ARGS__),   \
+        KASSERT_UNIQUE_1(__VA_ARGS__),   \
+        ignore                           \
+    )
+
+/// @cond IMPLEMENTATION
+
+// Implementation of the range assertions. Same as KASSERT(), but instead of a decomposed expression, `check` is a
+// range check object (e.g., kassert::internal::RangeEqualCheck) that evaluates the assertion when it is constructed and
+// prints the first violating element once the assertion failed.
+#define KASSERT_KASSERT_HPP_KASSERT_RANGE_IMPL(type, expr_str, check, message, level)           \
+    do {                                                                                        \
+        if constexpr (kassert::internal::assertion_enabled(level)) {                            \
+            if (KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                         \
+                KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(kassert_site, type, expr_str)         \
+                KASSERT_KASSERT_HPP_INSTRUMENT_ASSERTION(kassert_site, level)                   \
+                kassert::internal::evaluate_range_assertion(                                    \
+                    KASSERT_KASSERT_HPP_ASSERTION_SITE_ARGUMENTS(kassert_site, type, expr_str), \
+                    check,                                                                      \
+                    KASSERT_KASSERT_HPP_MESSAGE_WRITER(message, level)                          \
+                );                                                                              \
+            }                                                                                   \
+        }                                                                                       \
+    } while (false)
+
+// The range assertions choose the right implementation depending on their number of arguments.
+#define KASSERT_RANGE_EQ_3(lhs, rhs, message, level)    \
+    KASSERT_KASSERT_HPP_KASSERT_RANGE_IMPL(             \
+        "ASSERTION",                                    \
+        #lhs " == " #rhs,                               \
+        kassert::internal::check_range_equal(lhs, rhs), \
+        message,                                        \
+        level                                           \
+    )
+#define KASSERT_RANGE_EQ_2(lhs, rhs, message) KASSERT_RANGE_EQ_3(lhs, rhs, message, kassert::assert::normal)
+#define KASSERT_RANGE_EQ_1(lhs, rhs)          KASSERT_RANGE_EQ_2(lhs, rhs, "")
+
+#define KASSERT_SORTED_3(range, message, level)       \
+    KASSERT_KASSERT_HPP_KASSERT_RANGE_IMPL(           \
+        "ASSERTION",                                  \
+        "is_sorted(" #range ")",                      \
+        kassert::internal::check_range_sorted(range), \
+        message,                                      \
+        level                                         \
+    )
+#define KASSERT_SORTED_2(range, message) KASSERT_SORTED_3(range, message, kassert::assert::normal)
+#define KASSERT_SORTED_1(range)          KASSERT_SORTED_2(range, "")
+
+#define KASSERT_ALL_OF_3(range, predicate, message, level)       \
+    KASSERT_KASSERT_HPP_KASSERT_RANGE_IMPL(                      \
+        "ASSERTION",                                             \
+        "all_of(" #range ", " #predicate ")",                    \
+        kassert::internal::check_range_all_of(range, predicate), \
+        message,                                                 \
+        level                                                    \
+    )
+#define KASSERT_ALL_OF_2(range, predicate, message) KASSERT_ALL_OF_3(range, predicate, message, kassert::assert::normal)
+#define KASSERT_ALL_OF_1(range, predicate)          KASSERT_ALL_OF_2(range, predicate, "")
+
+#define KASSERT_UNIQUE_3(range, message, level)       \
+    KASSERT_KASSERT_HPP_KASSERT_RANGE_IMPL(           \
+        "ASSERTION",                                  \
+        "is_unique(" #range ")",                      \
+        kassert::internal::check_range_unique(range), \
+        message,                                      \
+        level                                         \
+    )
+#define KASSERT_UNIQUE_2(range, message) KASSERT_UNIQUE_3(range, message, kassert::assert::normal)
+#define KASSERT_UNIQUE_1(range)          KASSERT_UNIQUE_2(range, "")
+
+/// @endcond
+
+namespace kassert {
+/// @brief Non-owning reference to a callable `void(std::size_t chunk)` that checks one chunk of a parallel range
+/// check.
+class RangeTask {
+public:
+    /// @brief Constructs a reference to a callable, which must outlive this reference.
+    /// @tparam FunctionT The type of the callable.
+    /// @param function The callable.
+    template <typename FunctionT>
+    explicit RangeTask(FunctionT const& function) : _call(&call<FunctionT>),
+                                                    _function(&function) {}
+
+    /// @brief Checks a chunk.
+    /// @param chunk The index of the chunk.
+    void operator()(std::size_t const chunk) const {
+        _call(_function, chunk);
+    }
+
+private:
+    /// @brief Calls the referenced callable.
+    /// @tparam FunctionT The type of the callable.
+    /// @param function The callable.
+    /// @param chunk The index of the chunk.
+    template <typename FunctionT>
+    static void call(void const* function, std::size_t const chunk) {
+        (*static_cast<FunctionT const*>(function))(chunk);
+    }
+
+    void (*_call)(void const*, std::size_t); ///< @brief Calls the referenced callable.
+    void const* _function;                   ///< @brief The referenced callable.
+};
+
+/// @brief Executes the chunks of range assertions on large contiguous ranges in parallel.
+///
+/// If an executor is installed using \c kassert::set_range_executor(), KASSERT_RANGE_EQ(), KASSERT_SORTED() and
+/// KASSERT_ALL_OF() split contiguous ranges of at least \c min_parallel_size() elements into chunks and pass them to
+/// \c run(). The first violating index is reduced over all chunks, i.e., the report is the same as that of a sequential
+/// check. Predicates of KASSERT_ALL_OF() are then called concurrently and must be thread-safe.
+///
+/// Implementations are \c kassert::OpenMPRangeExecutor (if compiled with OpenMP) and \c kassert::ThreadRangeExecutor
+/// (in \c kassert/thread_range_executor.hpp). Other thread pools can be plugged in by deriving from this class.
+class RangeExecutor {
+public:
+    /// @brief Constructs the executor.
+    /// @param min_parallel_size Minimum number of elements of ranges that are checked in parallel.
+    explicit RangeExecutor(std::size_t const min_parallel_size = KASSERT_PARALLEL_RANGE_MIN_SIZE)
+        : _min_parallel_size(min_parallel_size) {}
+
+    /// @brief Destructor.
+    virtual ~RangeExecutor() = default;
+
+    /// @brief Calls `task(i)` for all `i` in `[0, tasks)` in any order and possibly concurrently, and returns once all
+    /// calls have returned.
+    /// @param tasks The number of tasks.
+    /// @param task The task.
+    virtual void run(std::size_t tasks, RangeTask const& task) = 0;
+
+    /// @brief Returns the number of tasks that can run concurrently. Ranges are only checked in parallel if this is at
+    /// least two.
+    /// @return The number of threads of the executor.
+    [[nodiscard]] virtual std::size_t concurrency() const = 0;
+
+    /// @brief Returns the minimum number of elements of ranges that are checked in parallel.
+    /// @return The minimum size.
+    [[nodiscard]] std::size_t min_parallel_size() const {
+        return _min_parallel_size;
+    }
+
+private:
+    std::size_t _min_parallel_size; ///< @brief Minimum number of elements of ranges that are checked in parallel.
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The installed range executor, or \c nullptr if range assertions are checked sequentially.
+inline std::atomic<RangeExecutor*> installed_range_executor{nullptr};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Installs the executor that checks range assertions on large contiguous ranges in parallel.
+/// @param executor The executor, or \c nullptr to check all range assertions sequentially. The executor must outlive
+/// all range assertions that are evaluated while it is installed.
+/// @return The previously installed executor.
+inline RangeExecutor* set_range_executor(RangeExecutor* executor) {
+    return internal::installed_range_executor.exchange(executor, std::memory_order_acq_rel);
+}
+
+/// @brief Returns the installed range executor.
+/// @return The executor, or \c nullptr if none is installed.
+inline RangeExecutor* range_executor() {
+    return internal::installed_range_executor.load(std::memory_order_acquire);
+}
+
+#if defined(_OPENMP)
+/// @brief Range executor that runs the chunks of parallel range checks in an OpenMP parallel region. Available if the
+/// code is compiled with OpenMP.
+class OpenMPRangeExecutor final : public RangeExecutor {
+public:
+    using RangeExecutor::RangeExecutor;
+
+    /// @brief Runs the tasks with dynamic scheduling.
+    /// @param tasks The number of tasks.
+    /// @param task The task.
+    void run(std::size_t const tasks, RangeTask const& task) override {
+        auto const count = static_cast<std::ptrdiff_t>(tasks);
+    #pragma omp parallel for schedule(dynamic, 1)
+        for (std::ptrdiff_t i = 0; i < count; ++i) {
+            task(static_cast<std::size_t>(i));
+        }
+    }
+
+    /// @brief Returns the maximum number of OpenMP threads.
+    /// @return The number of threads.
+    [[nodiscard]] std::size_t concurrency() const override {
+        return static_cast<std::size_t>(omp_get_max_threads());
+    }
+};
+#endif
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The type of the elements of a range.
+/// @tparam RangeT The type of the range.
+template <typename RangeT>
+using range_value_t =
+    std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(std::declval<RangeT const&>()))>>;
+
+// If partially specialized template is not applicable, set value to false.
+template <typename, typename = void>
+struct is_contiguous_range_impl : std::false_type {};
+
+// Partially specialize template if std::data() and std::size() are valid for RangeT.
+template <typename RangeT>
+struct is_contiguous_range_impl<
+    RangeT,
+    std::void_t<decltype(std::data(std::declval<RangeT const&>())), decltype(std::size(std::declval<RangeT const&>()))>>
+    : std::true_type {};
+
+/// @brief Determines whether \c ValueT can be compared by its object representation, i.e., two values compare equal
+/// if and only if their bytes are equal. This holds for integers, enums and pointers, but not for floating point
+/// numbers (`-0.0 == 0.0`, `NaN != NaN`) or classes (padding, user-defined \c == operator).
+/// @tparam ValueT A type.
+template <typename ValueT>
+constexpr bool is_trivially_comparable =
+    std::is_integral_v<ValueT> || std::is_enum_v<ValueT> || std::is_pointer_v<ValueT>;
+
+/// @brief Determines whether \c RangeT stores trivially comparable elements contiguously in memory, i.e., whether the
+/// range checks can use the vectorized kernels.
+/// @tparam RangeT A type.
+template <typename RangeT>
+constexpr bool has_trivially_comparable_storage =
+    is_contiguous_range_impl<RangeT>::value && is_trivially_comparable<range_value_t<RangeT>>;
+
+/// @brief Number of elements that the block-wise kernels check without branching.
+constexpr std::size_t range_kernel_block_size = 256;
+
+/// @brief Unsigned integer with the same size as \c ValueT, which the block-wise kernels use to accumulate the results
+/// of their comparisons. Using the width of the elements avoids packing the results into narrower vector lanes.
+/// @tparam ValueT The type of the elements.
+template <typename ValueT>
+using kernel_accumulator_t = std::conditional_t<
+    sizeof(ValueT) == 1,
+    std::uint8_t,
+    std::conditional_t<
+        sizeof(ValueT) == 2,
+        std::uint16_t,
+        std::conditional_t<sizeof(ValueT) == 4, std::uint32_t, std::uint64_t>>>;
+
+/// @brief Returns the index of the first mismatch of two arrays within `[begin, end)`, or \c end if there is none.
+/// Blocks of trivially comparable elements are compared with \c std::memcmp, which is vectorized by the C library.
+/// @tparam LhsValueT The type of the elements of the first array.
+/// @tparam RhsValueT The type of the elements of the second array.
+/// @param lhs The first array.
+/// @param rhs The second array.
+/// @param begin The first index to compare.
+/// @param end The end of the compared indices.
+/// @return The index of the first mismatch.
+template <typename LhsValueT, typename RhsValueT>
+std::size_t
+contiguous_mismatch(LhsValueT const* lhs, RhsValueT const* rhs, std::size_t const begin, std::size_t const end) {
+    std::size_t index = begin;
+    if constexpr (std::is_same_v<LhsValueT, RhsValueT> && is_trivially_comparable<LhsValueT>) {
+        while (index + range_kernel_block_size <= end
+               && std::memcmp(lhs + index, rhs + index, range_kernel_block_size * sizeof(LhsValueT)) == 0) {
+            index += range_kernel_block_size;
+        }
+    }
+    while (index < end && lhs[index] == rhs[index]) {
+        ++index;
+    }
+    return index;
+}
+
+/// @brief Returns the first index in `[max(begin, 1), end)` whose element is smaller than its predecessor, or \c end
+/// if there is none. Blocks of trivially comparable elements are checked without branches, which allows the compiler
+/// to vectorize the comparisons.
+/// @tparam ValueT The type of the elements.
+/// @param data The array.
+/// @param begin The first index to check.
+/// @param end The end of the checked indices.
+/// @return The index of the first unsorted element.
+template <typename ValueT>
+std::size_t contiguous_sorted_until(ValueT const* data, std::size_t const begin, std::size_t const end) {
+    std::size_t index = std::max<std::size_t>(begin, 1);
+    if constexpr (is_trivially_comparable<ValueT>) {
+        for (; index + range_kernel_block_size <= end; index += range_kernel_block_size) {
+            kernel_accumulator_t<ValueT> unsorted = 0;
+            for (std::size_t i = index; i < index + range_kernel_block_size; ++i) {
+                unsorted |= static_cast<kernel_accumulator_t<ValueT>>(data[i] < data[i - 1]);
+            }
+            if (unsorted != 0) {
+                break;
+            }
+        }
+    }
+    for (; index < end; ++index) {
+        if (data[index] < data[index - 1]) {
+            return index;
+        }
+    }
+    return end;
+}
+
+/// @brief Returns the first index in `[begin, end)` whose element does not satisfy a predicate, or \c end if there is
+/// none. Blocks of trivially comparable elements are checked without branches, i.e., the predicate may be called for
+/// elements after the first violating element.
+/// @tparam ValueT The type of the elements.
+/// @tparam PredicateT The type of the predicate.
+/// @param data The array.
+/// @param begin The first index to check.
+/// @param end The end of the checked indices.
+/// @param predicate The predicate.
+/// @return The index of the first violating element.
+template <typename ValueT, typename PredicateT>
+std::size_t contiguous_find_if_not(
+    ValueT const* data, std::size_t const begin, std::size_t const end, PredicateT const& predicate
+) {
+    std::size_t index = begin;
+    if constexpr (is_trivially_comparable<ValueT>) {
+        for (; index + range_kernel_block_size <= end; index += range_kernel_block_size) {
+            kernel_accumulator_t<ValueT> violated = 0;
+            for (std::size_t i = index; i < index + range_kernel_block_size; ++i) {
+                violated |= static_cast<kernel_accumulator_t<ValueT>>(!predicate(data[i]));
+            }
+            if (violated != 0) {
+                break;
+            }
+        }
+    }
+    for (; index < end; ++index) {
+        if (!predicate(data[index])) {
+            return index;
+        }
+    }
+    return end;
+}
+
+/// @brief Returns the installed range executor if a contiguous range of the given size should be checked in parallel.
+/// @param size The number of elements of the range.
+/// @return The executor, or \c nullptr if the range should be checked by the calling thread.
+inline RangeExecutor* parallel_range_executor(std::size_t const size) {
+    RangeExecutor* const executor = range_executor();
+    if (executor == nullptr || size < executor->min_parallel_size() || executor->concurrency() < 2) {
+        return nullptr;
+    }
+    return executor;
+}
+
+/// @brief Number of chunks per thread into which parallel range checks are split. More chunks balance the load and
+/// allow skipping more elements after a violation was found.
+constexpr std::size_t parallel_range_chunks_per_thread = 4;
+
+/// @brief Finds the first violating index of a range in parallel.
+///
+/// The range is split into chunks, which the executor checks in any order. Each chunk returns its first violating
+/// index and the smallest of them is kept. Chunks that start after an already found violation are skipped, since they
+/// cannot contain the first violation. Thus, the result is the same as that of a sequential search.
+/// @tparam FindT Callable `std::size_t(std::size_t begin, std::size_t end)` returning the first violating index in
+/// `[begin, end)`, or \c end if there is none.
+/// @param executor The executor.
+/// @param size The number of elements of the range.
+/// @param find Searches a chunk.
+/// @return The first violating index, or \c size if there is none.
+template <typename FindT>
+std::size_t parallel_find_first(RangeExecutor& executor, std::size_t const size, FindT const& find) {
+    std::size_t const blocks     = (size + range_kernel_block_size - 1) / range_kernel_block_size;
+    std::size_t const chunks     = std::max<std::size_t>(
+        1,
+        std::min(blocks, executor.concurrency() * parallel_range_chunks_per_thread)
+    );
+    std::size_t const chunk_size = (size + chunks - 1) / chunks;
+
+    std::atomic<std::size_t> first{size};
+    auto const               check_chunk = [&](std::size_t const chunk) {
+        std::size_t const begin = chunk * chunk_size;
+        if (begin >= first.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::size_t const end   = std::min(size, begin + chunk_size);
+        std::size_t const index = find(begin, end);
+        if (index < end) {
+            std::size_t current = first.load(std::memory_order_relaxed);
+            while (index < current && !first.compare_exchange_weak(current, index, std::memory_order_relaxed)) {
+            }
+        }
+    };
+    executor.run(chunks, RangeTask(check_chunk));
+    return first.load(std::memory_order_relaxed);
+}
+
+/// @brief Finds the first violating index of a contiguous range, in parallel if the installed range executor (if any)
+/// accepts the size of the range.
+/// @tparam FindT Callable `std::size_t(std::size_t begin, std::size_t end)` returning the first violating index in
+/// `[begin, end)`, or \c end if there is none.
+/// @param size The number of elements of the range.
+/// @param find Searches a part of the range.
+/// @return The first violating index, or \c size if there is none.
+template <typename FindT>
+std::size_t find_first_violation(std::size_t const size, FindT const& find) {
+    if (RangeExecutor* const executor = parallel_range_executor(size); executor != nullptr) {
+        return parallel_find_first(*executor, size, find);
+    }
+    return find(0, size);
+}
+
+/// @brief Returns an iterator to the element of a range at the given index.
+/// @tparam RangeT The type of the range.
+/// @param range The range.
+/// @param index The index.
+/// @return The iterator.
+template <typename RangeT>
+auto range_iterator_at(RangeT const& range, std::size_t const index) {
+    auto it = std::begin(range);
+    std::advance(it, static_cast<typename std::iterator_traits<decltype(it)>::difference_type>(index));
+    return it;
+}
+
+/// @brief Prints the elements of a range around the given index, e.g., `lhs[4..10]: [..., 1, 2, 3, 4, 5, 6, 7, ...]`.
+/// @tparam RangeT The type of the range.
+/// @param logger The logger.
+/// @param name The name of the range.
+/// @param range The range.
+/// @param size The number of elements of the range.
+/// @param index The index of the violating element.
+template <typename RangeT>
+void print_range_window(
+    FdLogger& logger, char const* name, RangeT const& range, std::size_t const size, std::size_t const index
+) {
+    std::size_t const context = KASSERT_RANGE_CONTEXT;
+    std::size_t const first   = std::min(size, index > context ? index - context : 0);
+    std::size_t const last    = std::min(size, index + context + 1);
+
+    logger << "\t" << name;
+    if (first < last) {
+        logger << "[" << first << ".." << last - 1 << "]";
+    }
+    logger << ": [" << (first > 0 ? "..., " : "");
+    auto it = range_iterator_at(range, first);
+    for (std::size_t i = first; i < last; ++i, ++it) {
+        if (i > first) {
+            logger << ", ";
+        }
+        stringify_value(logger, *it);
+    }
+    logger << (last < size ? ", ...]" : "]") << "\n";
+}
+
+/// @brief Marks the index of the first violation of a range check as not yet computed.
+constexpr std::size_t unknown_range_index = static_cast<std::size_t>(-1);
+
+/// @brief Check of KASSERT_RANGE_EQ(): two ranges are element-wise equal.
+/// @tparam LhsT The type of the left-hand range.
+/// @tparam RhsT The type of the right-hand range.
+template <typename LhsT, typename RhsT>
+class RangeEqualCheck {
+public:
+    /// @brief Evaluates the check.
+    /// @param lhs The left-hand range.
+    /// @param rhs The right-hand range.
+    RangeEqualCheck(LhsT const& lhs, RhsT const& rhs) : _lhs(lhs), _rhs(rhs), _result(evaluate()) {}
+
+    /// @brief Returns the result of the check.
+    /// @return Whether the ranges are equal.
+    [[nodiscard]] bool result() const {
+        return _result;
+    }
+
+    /// @brief Prints the first mismatch of the ranges.
+    /// @param logger The logger.
+    void print(FdLogger& logger) const {
+        std::size_t const lhs_size = range_size(_lhs);
+        std::size_t const rhs_size = range_size(_rhs);
+        std::size_t const index    = _index != unknown_range_index ? _index : mismatch(std::min(lhs_size, rhs_size));
+
+        logger << "with expansion:\n";
+        if (lhs_size != rhs_size) {
+            logger << "\tsizes differ: " << lhs_size << " != " << rhs_size << "\n";
+        }
+        if (index < std::min(lhs_size, rhs_size)) {
+            logger << "\tfirst mismatch at index " << index << ": ";
+            stringify_value(logger, *range_iterator_at(_lhs, index));
+            logger << " != ";
+            stringify_value(logger, *range_iterator_at(_rhs, index));
+            logger << "\n";
+        } else {
+            logger << "\tthe first " << index << " elements are equal\n";
+        }
+        print_range_window(logger, "lhs", _lhs, lhs_size, index);
+        print_range_window(logger, "rhs", _rhs, rhs_size, index);
+    }
+
+private:
+    /// @brief Compares the ranges. Large contiguous ranges are compared in parallel if a range executor is installed.
+    /// @return Whether the ranges are equal.
+    bool evaluate() {
+        std::size_t const size = range_size(_lhs);
+        if (size != range_size(_rhs)) {
+            return false;
+        }
+        if constexpr (is_contiguous) {
+            if (RangeExecutor* const executor = parallel_range_executor(size); executor != nullptr) {
+                _index = parallel_find_first(*executor, size, [this](std::size_t const begin, std::size_t const end) {
+                    return contiguous_mismatch(std::data(_lhs), std::data(_rhs), begin, end);
+                });
+                return _index == size;
+            }
+        }
+        if constexpr (use_memcmp) {
+            return size == 0 || std::memcmp(std::data(_lhs), std::data(_rhs), size * sizeof(range_value_t<LhsT>)) == 0;
+        } else {
+            return std::equal(std::begin(_lhs), std::end(_lhs), std::begin(_rhs), std::end(_rhs));
+        }
+    }
+
+    /// @brief Returns the index of the first mismatch within the first \c size elements.
+    /// @param size The size of the shorter range.
+    /// @return The index of the first mismatch, or \c size if there is none.
+    std::size_t mismatch(std::size_t const size) const {
+        if constexpr (is_contiguous) {
+            return contiguous_mismatch(std::data(_lhs), std::data(_rhs), 0, size);
+        } else {
+            auto const lhs_end = range_iterator_at(_lhs, size);
+            return static_cast<std::size_t>(
+                std::distance(std::begin(_lhs), std::mismatch(std::begin(_lhs), lhs_end, std::begin(_rhs)).first)
+            );
+        }
+    }
+
+    /// @brief Whether both ranges store their elements contiguously.
+    static constexpr bool is_contiguous =
+        is_contiguous_range_impl<LhsT>::value && is_contiguous_range_impl<RhsT>::value;
+
+    /// @brief Whether both ranges store the same trivially comparable type contiguously.
+    static constexpr bool use_memcmp = has_trivially_comparable_storage<LhsT> && has_trivially_comparable_storage<RhsT>
+                                       && std::is_same_v<range_value_t<LhsT>, range_value_t<RhsT>>;
+
+    LhsT const& _lhs;                         ///< @brief The left-hand range.
+    RhsT const& _rhs;                         ///< @brief The right-hand range.
+    std::size_t _index = unknown_range_index; ///< @brief Index of the first mismatch, if already computed.
+    bool        _result;                      ///< @brief Result of the check.
+};
+
+/// @brief Check of KASSERT_SORTED(): a range is sorted in non-descending order.
+/// @tparam RangeT The type of the range.
+template <typename RangeT>
+class RangeSortedCheck {
+public:
+    /// @brief Evaluates the check.
+    /// @param range The range.
+    explicit RangeSortedCheck(RangeT const& range) : _range(range), _result(evaluate()) {}
+
+    /// @brief Returns the result of the check.
+    /// @return Whether the range is sorted.
+    [[nodiscard]] bool result() const {
+        return _result;
+    }
+
+    /// @brief Prints the first element that is smaller than its predecessor.
+    /// @param logger The logger.
+    void print(FdLogger& logger) const {
+        logger << "with expansion:\n"
+               << "\telement at index " << _index << " is smaller than its predecessor: ";
+        stringify_value(logger, *range_iterator_at(_range, _index));
+        logger << " < ";
+        stringify_value(logger, *range_iterator_at(_range, _index - 1));
+        logger << "\n";
+        print_range_window(logger, "range", _range, range_size(_range), _index);
+    }
+
+private:
+    /// @brief Checks the range. Large contiguous ranges are checked in parallel if a range executor is installed.
+    /// @return Whether the range is sorted.
+    bool evaluate() {
+        if constexpr (is_contiguous_range_impl<RangeT>::value) {
+            std::size_t const size = std::size(_range);
+            _index = find_first_violation(size, [this](std::size_t const begin, std::size_t const end) {
+                return contiguous_sorted_until(std::data(_range), begin, end);
+            });
+            return _index == size;
+        } else {
+            auto const it = std::is_sorted_until(std::begin(_range), std::end(_range));
+            _index        = static_cast<std::size_t>(std::distance(std::begin(_range), it));
+            return it == std::end(_range);
+        }
+    }
+
+    RangeT const& _range;  ///< @brief The range.
+    std::size_t   _index;  ///< @brief Index of the first unsorted element.
+    bool          _result; ///< @brief Result of the check.
+};
+
+/// @brief Check of KASSERT_ALL_OF(): a predicate holds for all elements of a range.
+/// @tparam RangeT The type of the range.
+/// @tparam PredicateT The type of the predicate.
+template <typename RangeT, typename PredicateT>
+class RangeAllOfCheck {
+public:
+    /// @brief Evaluates the check.
+    /// @param range The range.
+    /// @param predicate The predicate.
+    RangeAllOfCheck(RangeT const& range, PredicateT predicate)
+        : _range(range),
+          _predicate(std::move(predicate)),
+          _result(evaluate()) {}
+
+    /// @brief Returns the result of the check.
+    /// @return Whether the predicate holds for all elements.
+    [[nodiscard]] bool result() const {
+        return _result;
+    }
+
+    /// @brief Prints the first element for which the predicate does not hold.
+    /// @param logger The logger.
+    void print(FdLogger& logger) const {
+        logger << "with expansion:\n"
+               << "\tpredicate does not hold for the element at index " << _index << ": ";
+        stringify_value(logger, *range_iterator_at(_range, _index));
+        logger << "\n";
+        print_range_window(logger, "range", _range, range_size(_range), _index);
+    }
+
+private:
+    /// @brief Checks the range. Large contiguous ranges are checked in parallel if a range executor is installed.
+    /// @return Whether the predicate holds for all elements.
+    bool evaluate() {
+        auto const holds = [this](auto const& element) {
+            return static_cast<bool>(_predicate(element));
+        };
+        if constexpr (is_contiguous_range_impl<RangeT>::value) {
+            std::size_t const size = std::size(_range);
+            _index = find_first_violation(size, [&](std::size_t const begin, std::size_t const end) {
+                return contiguous_find_if_not(std::data(_range), begin, end, holds);
+            });
+            return _index == size;
+        } else {
+            auto const it = std::find_if_not(std::begin(_range), std::end(_range), holds);
+            _index        = static_cast<std::size_t>(std::distance(std::begin(_range), it));
+            return it == std::end(_range);
+        }
+    }
+
+    RangeT const& _range;     ///< @brief The range.
+    PredicateT    _predicate; ///< @brief The predicate.
+    std::size_t   _index;     ///< @brief Index of the first violating element.
+    bool          _result;    ///< @brief Result of the check.
+};
+
+/// @brief Check of KASSERT_UNIQUE(): all elements of a range are pairwise distinct.
+/// @tparam RangeT The type of the range.
+template <typename RangeT>
+class RangeUniqueCheck {
+public:
+    /// @brief Evaluates the check.
+    /// @param range The range.
+    explicit RangeUniqueCheck(RangeT const& range) : _range(range), _result(evaluate()) {}
+
+    /// @brief Returns the result of the check.
+    /// @return Whether all elements are distinct.
+    [[nodiscard]] bool result() const {
+        return _result;
+    }
+
+    /// @brief Prints the first element that equals an earlier element, together with the earlier element.
+    /// @param logger The logger.
+    void print(FdLogger& logger) const {
+        // sort the indices by element, such that equal elements are adjacent and ordered by their index
+        std::size_t const        size = range_size(_range);
+        std::vector<value_type const*> elements;
+        elements.reserve(size);
+        for (auto const& element: _range) {
+            elements.push_back(&element);
+        }
+        std::vector<std::size_t> order(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t const lhs, std::size_t const rhs) {
+            return less(*elements[lhs], *elements[rhs]);
+        });
+
+        // the first duplicate is the second element with the smallest index among all groups of equal elements
+        std::size_t first     = size;
+        std::size_t duplicate = size;
+        for (std::size_t i = 1; i < size; ++i) {
+            bool const starts_group = i == 1 || !(*elements[order[i - 2]] == *elements[order[i - 1]]);
+            if (starts_group && *elements[order[i - 1]] == *elements[order[i]] && order[i] < duplicate) {
+                first     = order[i - 1];
+                duplicate = order[i];
+            }
+        }
+
+        logger << "with expansion:\n"
+               << "\telement at index " << duplicate << " equals the element at index " << first << ": ";
+        stringify_value(logger, *elements[duplicate]);
+        logger << "\n";
+        print_range_window(logger, "range", _range, size, first);
+        print_range_window(logger, "range", _range, size, duplicate);
+    }
+
+private:
+    /// @brief The type of the elements.
+    using value_type = range_value_t<RangeT>;
+
+    /// @brief Compares two elements. Pointers are compared with \c std::less, which is a total order.
+    /// @param lhs The first element.
+    /// @param rhs The second element.
+    /// @return Whether \c lhs is smaller than \c rhs.
+    static bool less(value_type const& lhs, value_type const& rhs) {
+        return std::less<value_type>{}(lhs, rhs);
+    }
+
+    /// @brief Checks the range by sorting a copy of its elements (trivially comparable elements) or of pointers to
+    /// its elements (other elements).
+    /// @return Whether all elements are distinct.
+    bool evaluate() const {
+        if constexpr (is_trivially_comparable<value_type>) {
+            std::vector<value_type> values(std::begin(_range), std::end(_range));
+            std::sort(values.begin(), values.end(), less);
+            return std::adjacent_find(values.begin(), values.end()) == values.end();
+        } else {
+            std::vector<value_type const*> elements;
+            elements.reserve(range_size(_range));
+            for (auto const& element: _range) {
+                elements.push_back(&element);
+            }
+            std::sort(elements.begin(), elements.end(), [](value_type const* lhs, value_type const* rhs) {
+                return less(*lhs, *rhs);
+            });
+            return std::adjacent_find(
+                       elements.begin(),
+                       elements.end(),
+                       [](value_type const* lhs, value_type const* rhs) { return *lhs == *rhs; }
+                   )
+                   == elements.end();
+        }
+    }
+
+    RangeT const& _range;  ///< @brief The range.
+    bool          _result; ///< @brief Result of the check.
+};
+
+/// @brief Evaluates the check of KASSERT_RANGE_EQ().
+/// @tparam LhsT The type of the left-hand range.
+/// @tparam RhsT The type of the right-hand range.
+/// @param lhs The left-hand range.
+/// @param rhs The right-hand range.
+/// @return The evaluated check.
+template <typename LhsT, typename RhsT>
+RangeEqualCheck<LhsT, RhsT> check_range_equal(LhsT const& lhs, RhsT const& rhs) {
+    return {lhs, rhs};
+}
+
+/// @brief Evaluates the check of KASSERT_SORTED().
+/// @tparam RangeT The type of the range.
+/// @param range The range.
+/// @return The evaluated check.
+template <typename RangeT>
+RangeSortedCheck<RangeT> check_range_sorted(RangeT const& range) {
+    return RangeSortedCheck<RangeT>(range);
+}
+
+/// @brief Evaluates the check of KASSERT_ALL_OF().
+/// @tparam RangeT The type of the range.
+/// @tparam PredicateT The type of the predicate.
+/// @param range The range.
+/// @param predicate The predicate.
+/// @return The evaluated check.
+template <typename RangeT, typename PredicateT>
+RangeAllOfCheck<RangeT, PredicateT> check_range_all_of(RangeT const& range, PredicateT predicate) {
+    return {range, std::move(predicate)};
+}
+
+/// @brief Evaluates the check of KASSERT_UNIQUE().
+/// @tparam RangeT The type of the range.
+/// @param range The range.
+/// @return The evaluated check.
+template <typename RangeT>
+RangeUniqueCheck<RangeT> check_range_unique(RangeT const& range) {
+    return RangeUniqueCheck<RangeT>(range);
+}
+
+/// @brief Failure path of the range assertions: prints an error describing the failed assertion and its first
+/// violating element, followed by the user message, and aborts the program.
+/// @tparam CheckT Type of the range check.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param type Type of this check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion.
+/// @param check The failed range check.
+/// @param message Callable that writes the user message.
+template <typename CheckT, typename MessageT>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void fail_range_assertion(
+    char const* type, SourceLocation const where, char const* expr_str, CheckT const& check, MessageT const message
+) {
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, type, false, where, expr_str);
+    check.print(logger);
+    message(logger);
+    finish_failed_assertion(logger);
+}
+
+/// @brief Failure path of the range assertions if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but the
+/// static metadata of the call site is passed as a single pointer to a constant record.
+/// @tparam CheckT Type of the range check.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site.
+/// @param check The failed range check.
+/// @param message Callable that writes the user message.
+template <typename CheckT, typename MessageT>
+[[noreturn]] KASSERT_KASSERT_HPP_ATTRIBUTE_COLD void
+fail_range_assertion(AssertionSite const* site, CheckT const& check, MessageT const message) {
+    FdLogger logger(standard_error);
+    print_failed_assertion(logger, site->type, false, site->location, site->expression);
+    check.print(logger);
+    message(logger);
+    finish_failed_assertion(logger);
+}
+
+/// @brief Evaluates a range assertion. If the check failed, calls the cold failure path \c fail_range_assertion().
+/// @tparam CheckT Type of the range check.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param type Type of this check.
+/// @param where Source code location of the assertion.
+/// @param expr_str Stringified assertion.
+/// @param check The evaluated range check.
+/// @param message Callable that writes the user message. Only called if the assertion failed.
+template <typename CheckT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline void evaluate_range_assertion(
+    char const* type, SourceLocation const where, char const* expr_str, CheckT const& check, MessageT const message
+) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!check.result())) {
+        fail_range_assertion(type, where, expr_str, check, message);
+    }
+}
+
+/// @brief Evaluates a range assertion if \c KASSERT_COMPACT_CALL_SITES is defined: same as above, but the static
+/// metadata of the call site is passed as a single pointer to a constant record.
+/// @tparam CheckT Type of the range check.
+/// @tparam MessageT Callable that writes the user message to a \c FdLogger.
+/// @param site Static metadata of the assertion call site.
+/// @param check The evaluated range check.
+/// @param message Callable that writes the user message. Only called if the assertion failed.
+template <typename CheckT, typename MessageT>
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline void
+evaluate_range_assertion(AssertionSite const* site, CheckT const& check, MessageT const message) {
+    if (KASSERT_KASSERT_HPP_UNLIKELY(!check.result())) {
+        fail_range_assertion(site, check, message);
+    }
+}
+} // namespace kassert::internal
@@ -0,0 +1,442 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Stream-based logger and stringification of STL types.
+///
+/// This header extends the iostream-free loggers of \c kassert/core.hpp: it defines the primary \c kassert::Logger
+/// template wrapping an output stream, overloads the \c << operator of all loggers for STL containers and formats
+/// values that can only be written to a \c std::ostream using a \c std::ostringstream.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kassert/core.hpp"
+
+#ifndef KASSERT_STRINGIFICATION_MAX_ELEMENTS
+    /// @brief Default maximum number of elements of a range that are stringified, see
+    /// \c kassert::StringificationLimits.
+    #define KASSERT_STRINGIFICATION_MAX_ELEMENTS 32
+#endif
+
+#ifndef KASSERT_STRINGIFICATION_MAX_DEPTH
+    /// @brief Default maximum nesting depth of stringified ranges and tuples, see \c kassert::StringificationLimits.
+    #define KASSERT_STRINGIFICATION_MAX_DEPTH 8
+#endif
+
+#ifndef KASSERT_STRINGIFICATION_MAX_BYTES
+    /// @brief Default maximum number of bytes of a stringified range or tuple, see \c kassert::StringificationLimits.
+    #define KASSERT_STRINGIFICATION_MAX_BYTES 1024
+#endif
+
+namespace kassert {
+/// @brief Limits of the stringification of ranges and tuples in the error messages of failed assertions. A limit of
+/// \c 0 disables the limit.
+struct StringificationLimits {
+    /// @brief Maximum number of elements of a range that are printed. Larger ranges are printed as their first and
+    /// last elements, followed by their size.
+    std::size_t max_elements = KASSERT_STRINGIFICATION_MAX_ELEMENTS;
+    /// @brief Maximum nesting depth of ranges and tuples. Deeper ranges are printed as `[...]`, deeper tuples as
+    /// `(...)`.
+    std::size_t max_depth = KASSERT_STRINGIFICATION_MAX_DEPTH;
+    /// @brief Maximum number of bytes that the outermost range or tuple adds to the error message. Once exceeded, the
+    /// remaining elements are elided.
+    std::size_t max_bytes = KASSERT_STRINGIFICATION_MAX_BYTES;
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief The limits of the stringification of ranges and tuples, see \c kassert::set_stringification_limits().
+struct AtomicStringificationLimits {
+    std::atomic<std::size_t> max_elements{KASSERT_STRINGIFICATION_MAX_ELEMENTS}; ///< @brief See StringificationLimits.
+    std::atomic<std::size_t> max_depth{KASSERT_STRINGIFICATION_MAX_DEPTH};       ///< @brief See StringificationLimits.
+    std::atomic<std::size_t> max_bytes{KASSERT_STRINGIFICATION_MAX_BYTES};       ///< @brief See StringificationLimits.
+};
+
+/// @brief The limits of the stringification of ranges and tuples.
+inline AtomicStringificationLimits stringification_limits;
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Sets the limits of the stringification of ranges and tuples in the error messages of failed assertions.
+/// @param limits The new limits.
+inline void set_stringification_limits(StringificationLimits const& limits) {
+    internal::stringification_limits.max_elements.store(limits.max_elements, std::memory_order_relaxed);
+    internal::stringification_limits.max_depth.store(limits.max_depth, std::memory_order_relaxed);
+    internal::stringification_limits.max_bytes.store(limits.max_bytes, std::memory_order_relaxed);
+}
+
+/// @brief Returns the limits of the stringification of ranges and tuples in the error messages of failed assertions.
+/// @return The limits.
+inline StringificationLimits stringification_limits() {
+    StringificationLimits limits;
+    limits.max_elements = internal::stringification_limits.max_elements.load(std::memory_order_relaxed);
+    limits.max_depth    = internal::stringification_limits.max_depth.load(std::memory_order_relaxed);
+    limits.max_bytes    = internal::stringification_limits.max_bytes.load(std::memory_order_relaxed);
+    return limits;
+}
+} // namespace kassert
+
+namespace kassert::internal {
+// If partially specialized template is not applicable, set value to false.
+template <typename, typename = void>
+struct is_range_impl : std::false_type {};
+
+// Partially specialize template if std::begin() and std::end() are valid for RangeT.
+template <typename RangeT>
+struct is_range_impl<
+    RangeT,
+    std::void_t<decltype(std::begin(std::declval<RangeT const&>())), decltype(std::end(std::declval<RangeT const&>()))>>
+    : std::true_type {};
+
+/// @brief Determines whether \c RangeT can be iterated using \c std::begin() and \c std::end().
+/// @ingroup expression-expansion
+/// @tparam RangeT A type.
+template <typename RangeT>
+constexpr bool is_range = is_range_impl<RangeT>::value;
+
+// If partially specialized template is not applicable, set value to false.
+template <typename, typename = void>
+struct is_sized_range_impl : std::false_type {};
+
+// Partially specialize template if std::size() is valid for RangeT.
+template <typename RangeT>
+struct is_sized_range_impl<RangeT, std::void_t<decltype(std::size(std::declval<RangeT const&>()))>> : std::true_type {
+};
+
+// If partially specialized template is not applicable, set value to false.
+template <typename, typename = void>
+struct has_output_size_impl : std::false_type {};
+
+// Partially specialize template if LoggerT::size() is valid.
+template <typename LoggerT>
+struct has_output_size_impl<LoggerT, std::void_t<decltype(std::declval<LoggerT&>().size())>> : std::true_type {};
+
+/// @brief State of the (possibly nested) stringification of ranges and tuples by the current thread.
+struct StringificationState {
+    /// @brief Nesting depth of the range or tuple that is currently stringified.
+    std::size_t depth;
+    /// @brief Output size of the logger at which the remaining elements are elided, or \c 0 if unlimited.
+    std::size_t byte_limit;
+};
+
+/// @brief State of the stringification of ranges and tuples by the current thread.
+inline thread_local StringificationState stringification_state{};
+
+/// @brief Tracks the nesting depth and the output size of the stringification of a range or tuple.
+/// @tparam LoggerT The logger.
+template <typename LoggerT>
+class NestedStringification {
+public:
+    /// @brief Enters a range or tuple. The outermost range or tuple sets the byte limit of the stringification.
+    /// @param logger The logger.
+    explicit NestedStringification(LoggerT& logger) : _logger(logger) {
+        StringificationState& state = stringification_state;
+        if constexpr (has_output_size_impl<LoggerT>::value) {
+            if (state.depth == 0) {
+                std::size_t const max_bytes = stringification_limits.max_bytes.load(std::memory_order_relaxed);
+                state.byte_limit            = max_bytes > 0 ? logger.size() + max_bytes : 0;
+            }
+        }
+        ++state.depth;
+    }
+
+    NestedStringification(NestedStringification const&)            = delete;
+    NestedStringification& operator=(NestedStringification const&) = delete;
+
+    /// @brief Leaves the range or tuple.
+    ~NestedStringification() {
+        --stringification_state.depth;
+    }
+
+    /// @brief Returns whether the range or tuple exceeds the maximum nesting depth.
+    /// @return Whether the range or tuple is nested too deeply.
+    [[nodiscard]] bool too_deep() const {
+        std::size_t const max_depth = stringification_limits.max_depth.load(std::memory_order_relaxed);
+        return max_depth > 0 && stringification_state.depth > max_depth;
+    }
+
+    /// @brief Returns whether the stringification exceeded the maximum number of bytes.
+    /// @return Whether the remaining elements should be elided.
+    [[nodiscard]] bool out_of_bytes() const {
+        if constexpr (has_output_size_impl<LoggerT>::value) {
+            std::size_t const byte_limit = stringification_state.byte_limit;
+            return byte_limit > 0 && _logger.size() >= byte_limit;
+        } else {
+            return false;
+        }
+    }
+
+private:
+    LoggerT& _logger; ///< @brief The logger.
+};
+
+/// @brief Returns the number of elements of a range.
+/// @tparam RangeT The type of the range.
+/// @param range The range.
+/// @return The number of elements.
+template <typename RangeT>
+std::size_t range_size(RangeT const& range) {
+    if constexpr (is_sized_range_impl<RangeT>::value) {
+        return static_cast<std::size_t>(std::size(range));
+    } else {
+        return static_cast<std::size_t>(std::distance(std::begin(range), std::end(range)));
+    }
+}
+
+/// @brief Stringifies a range within the limits of the stringification, see \c kassert::StringificationLimits.
+/// @tparam LoggerT The logger.
+/// @tparam RangeT The type of the range.
+/// @param logger The logger.
+/// @param range The range.
+template <typename LoggerT, typename RangeT>
+void stringify_range(LoggerT& logger, RangeT const& range) {
+    NestedStringification<LoggerT> const nested(logger);
+    if (nested.too_deep()) {
+        logger << "[...]";
+        return;
+    }
+
+    // print the first `head` and the last `tail` elements
+    std::size_t const size         = range_size(range);
+    std::size_t const max_elements = stringification_limits.max_elements.load(std::memory_order_relaxed);
+    bool const        elided       = max_elements > 0 && size > max_elements;
+    std::size_t const head         = elided ? max_elements - max_elements / 2 : size;
+    std::size_t const tail         = elided ? max_elements / 2 : 0;
+
+    bool        complete = true;
+    std::size_t printed  = 0;
+    auto        print    = [&](auto const& element) {
+        if (nested.out_of_bytes()) {
+            logger << (printed > 0 ? ", ..." : "...");
+            complete = false;
+            return;
+        }
+        if (printed > 0) {
+            logger << ", ";
+        }
+        stringify_value(logger, element);
+        ++printed;
+    };
+
+    logger << "[";
+    auto it = std::begin(range);
+    for (std::size_t i = 0; i < head && complete; ++i, ++it) {
+        print(*it);
+    }
+    if (elided && complete) {
+        logger << ", ...";
+        std::advance(it, static_cast<typename std::iterator_traits<decltype(it)>::difference_type>(size - head - tail));
+        for (std::size_t i = 0; i < tail && complete; ++i, ++it) {
+            print(*it);
+        }
+    }
+    logger << "]";
+    if (elided || !complete) {
+        logger << " (size=" << size << ")";
+    }
+}
+
+/// @brief Stringifies the components of a tuple or pair within the maximum nesting depth, see
+/// \c kassert::StringificationLimits.
+/// @tparam LoggerT The logger.
+/// @tparam TupleT The type of the tuple.
+/// @tparam indices The indices of the components.
+/// @param logger The logger.
+/// @param tuple The tuple.
+template <typename LoggerT, typename TupleT, std::size_t... indices>
+void stringify_tuple(LoggerT& logger, TupleT const& tuple, std::index_sequence<indices...>) {
+    NestedStringification<LoggerT> const nested(logger);
+    if (nested.too_deep()) {
+        logger << "(...)";
+        return;
+    }
+    logger << "(";
+    ((logger << (indices == 0 ? "" : ", "), stringify_value(logger, std::get<indices>(tuple))), ...);
+    logger << ")";
+}
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Simple wrapper for output streams that is used to stringify values in assertions and exceptions.
+///
+/// To enable stringification for custom types, overload the \c << operator of this class.
+/// The library overloads this operator for the following STL types:
+///
+/// * ranges, e.g., \c std::vector<T>, \c std::array<T, N>, \c std::map<K, V> or \c std::set<T>
+/// * \c std::pair<K, V> and \c std::tuple<T...>
+/// * \c std::optional<T>
+///
+/// These overloads also apply to the loggers defined in \c kassert/internal/logger.hpp.
+///
+/// @tparam StreamT The underlying streaming object (e.g., \c std::ostream or \c std::ostringstream).
+template <typename StreamT>
+class Logger {
+public:
+    /// @brief Construct the object with an underlying streaming object.
+    /// @param out The underlying streaming object.
+    explicit Logger(StreamT&& out) : _out_buffer(), _out(std::forward<StreamT>(out)) {
+        _out_buffer << std::boolalpha;
+    }
+
+    /// @brief Forward all values for which \c StreamT::operator<< is defined to the underlying streaming object.
+    /// @param value Value to be stringified.
+    /// @tparam ValueT Type of the value to be stringified.
+    template <typename ValueT, std::enable_if_t<internal::is_streamable_type<std::ostream, ValueT>, int> = 0>
+    Logger<StreamT>& operator<<(ValueT&& value) {
+        // we buffer logged values and only flush when the destructor is called or the buffer is flushed manually
+        // this prevents interleaving of the outputs of multiple processes (e.g. MPI ranks)
+        _out_buffer << std::forward<ValueT>(value);
+        return *this;
+    }
+
+    /// @brief Get the underlying streaming object.
+    /// Flushes all buffered logs to the underlying stream before returning a reference to the stream.
+    /// @return The underlying streaming object.
+    StreamT&& stream() {
+        flush();
+        return std::forward<StreamT>(_out);
+    }
+
+    /// @brief Returns the number of buffered bytes.
+    /// @return The number of bytes that were logged since the last flush.
+    std::size_t size() {
+        return static_cast<std::size_t>(_out_buffer.tellp());
+    }
+
+    /// @brief Flushes all buffered logs to the underlying stream.
+    void flush() {
+        _out << _out_buffer.str() << std::flush;
+        _out_buffer.str(std::string{});
+    }
+
+    /// @brief Destructor of the logger stream, which flushes all buffered logs to the underlying stream upon
+    /// destruction.
+    ~Logger() {
+        flush();
+    }
+
+private:
+    std::stringstream _out_buffer; ///> @brief The output buffer.
+    StreamT&&         _out;        ///> @brief The underlying streaming object.
+};
+
+/// @brief Fallback stringification for the loggers that format values without iostreams (see
+/// \c internal::NativeFormatter): values that are not natively formattable, but can be written to a \c std::ostream,
+/// are formatted using a \c std::ostringstream. This allocates heap memory.
+/// @tparam StreamT The underlying output target of the Logger.
+/// @tparam ValueT Type of the value to be stringified.
+/// @param logger The assertion logger.
+/// @param value The value to be stringified.
+/// @return The logger.
+template <
+    typename StreamT,
+    typename ValueT,
+    std::enable_if_t<
+        std::is_base_of_v<internal::NativeFormatter<Logger<StreamT>>, Logger<StreamT>>
+            && !internal::is_natively_formattable<ValueT> && internal::is_streamable_type<std::ostream, ValueT const&>,
+        int> = 0>
+Logger<StreamT>& operator<<(Logger<StreamT>& logger, ValueT const& value) {
+    std::ostringstream stream;
+    stream << std::boolalpha << value;
+    return logger << stream.str();
+}
+
+/// @brief Stringification of ranges in assertions, e.g., \c std::vector, \c std::array, \c std::span, \c std::set or
+/// \c std::map.
+///
+/// Outputs a range in the following format, where `element i` are the stringified elements of the range:
+/// `[element 1, element 2, ...]`. The output is bounded by the limits set by \c kassert::set_stringification_limits():
+/// if the range has more elements than allowed, only its first and last elements are printed, followed by its size,
+/// e.g., `[1, 2, 3, ..., 98, 99] (size=50000000)`. Ranges that are nested too deeply are printed as `[...]`.
+///
+/// This overload does not apply to strings and to ranges that can be written to a \c std::ostream.
+///
+/// @tparam StreamT The underlying output stream of the Logger.
+/// @tparam RangeT The type of the range.
+/// @param logger The assertion logger.
+/// @param range The range to be stringified.
+/// @return The logger.
+template <
+    typename StreamT,
+    typename RangeT,
+    std::enable_if_t<
+        internal::is_range<RangeT> && !internal::is_natively_formattable<RangeT>
+            && !internal::is_streamable_type<std::ostream, RangeT const&>,
+        int> = 0>
+Logger<StreamT>& operator<<(Logger<StreamT>& logger, RangeT const& range) {
+    internal::stringify_range(logger, range);
+    return logger;
+}
+
+/// @brief Stringification of `std::pair<K, V>` in assertions.
+///
+/// Outputs a `std::pair<K, V>` in the following format, where `first` and `second` are the stringified
+/// components of the pair: `(first, second)`.
+///
+/// @tparam StreamT The underlying output stream of the Logger.
+/// @tparam Key Type of the first component of the pair.
+/// @tparam Value Type of the second component of the pair.
+/// @param logger The assertion logger.
+/// @param pair The pair to be stringified.
+/// @return The stringification of the pair as described above.
+template <typename StreamT, typename Key, typename Value>
+Logger<StreamT>& operator<<(Logger<StreamT>& logger, std::pair<Key, Value> const& pair) {
+    internal::stringify_tuple(logger, pair, std::index_sequence_for<Key, Value>{});
+    return logger;
+}
+
+/// @brief Stringification of `std::tuple<T...>` in assertions.
+///
+/// Outputs a `std::tuple<T...>` in the same format as a \c std::pair: `(element 1, element 2, ...)`.
+///
+/// @tparam StreamT The underlying output stream of the Logger.
+/// @tparam ValueTs Types of the components of the tuple.
+/// @param logger The assertion logger.
+/// @param tuple The tuple to be stringified.
+/// @return The logger.
+template <typename StreamT, typename... ValueTs>
+Logger<StreamT>& operator<<(Logger<StreamT>& logger, std::tuple<ValueTs...> const& tuple) {
+    internal::stringify_tuple(logger, tuple, std::index_sequence_for<ValueTs...>{});
+    return logger;
+}
+
+/// @brief Stringification of `std::optional<T>` in assertions.
+///
+/// Outputs the stringified value of the optional or `nullopt` if it is empty.
+///
+/// @tparam StreamT The underlying output stream of the Logger.
+/// @tparam ValueT Type of the value of the optional.
+/// @param logger The assertion logger.
+/// @param optional The optional to be stringified.
+/// @return The logger.
+template <typename StreamT, typename ValueT>
+Logger<StreamT>& operator<<(Logger<StreamT>& logger, std::optional<ValueT> const& optional) {
+    if (optional.has_value()) {
+        internal::stringify_value(logger, *optional);
+    } else {
+        logger << "nullopt";
+    }
+    return logger;
+}
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Logger writing all output to a \c std::ostream.
+using OStreamLogger = Logger<std::ostream&>;
+
+/// @brief Logger writing all output to a rvalue \c std::ostringstream.
+using RrefOStringstreamLogger = Logger<std::ostringstream&&>;
+} // namespace kassert::internal
@@ -0,0 +1,93 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief In-process testing of assertions: a failure handler that turns failed fatal assertions into exceptions.
+///
+/// Testing that an assertion fails usually requires a death test, which forks a process per check. While a
+/// \c kassert::testing::ThrowOnFailure object is alive, failed fatal assertions instead throw a
+/// \c kassert::testing::AssertionFailure that carries the report of the assertion, i.e., the checks run in-process.
+/// See \c kassert/gmock.hpp for matchers that use this handler.
+///
+/// Since the failure handler is shared by all threads, assertions that fail concurrently on other threads also throw.
+/// Assertions in \c noexcept functions and destructors still terminate the program.
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "kassert/core.hpp"
+
+namespace kassert::testing {
+/// @brief Exception thrown by failed fatal assertions while \c ThrowOnFailure is active.
+class AssertionFailure : public std::exception {
+public:
+    /// @brief Constructs the exception.
+    /// @param report The report of the failed assertion.
+    explicit AssertionFailure(std::string report) : _report(std::move(report)) {}
+
+    /// @brief Returns the report of the failed assertion.
+    /// @return The report, i.e., what would have been written to the standard error stream.
+    [[nodiscard]] std::string const& report() const noexcept {
+        return _report;
+    }
+
+    /// @brief Returns the report of the failed assertion.
+    /// @return The report.
+    [[nodiscard]] char const* what() const noexcept override {
+        return _report.c_str();
+    }
+
+private:
+    std::string _report; ///< @brief The report of the failed assertion.
+};
+
+/// @brief Failure handler that throws an \c AssertionFailure (see \c kassert::set_failure_handler()).
+/// @param report The formatted report of the failed assertion.
+/// @param size The length of the report.
+[[noreturn]] inline void throw_assertion_failure(char const* report, std::size_t const size) {
+    throw AssertionFailure(std::string(report, size));
+}
+
+/// @brief Installs \c throw_assertion_failure() as failure handler for the lifetime of this object.
+class ThrowOnFailure {
+public:
+    /// @brief Installs the handler.
+    ThrowOnFailure() : _previous(set_failure_handler(&throw_assertion_failure)) {}
+
+    /// @brief The handler cannot be installed twice by the same object.
+    ThrowOnFailure(ThrowOnFailure const&) = delete;
+
+    /// @brief The handler cannot be installed twice by the same object.
+    /// @return This object.
+    ThrowOnFailure& operator=(ThrowOnFailure const&) = delete;
+
+    /// @brief Restores the previously installed handler.
+    ~ThrowOnFailure() {
+        set_failure_handler(_previous);
+    }
+
+private:
+    FailureHandler _previous; ///< @brief The previously installed handler.
+};
+
+/// @brief Calls a function and returns the report of the first fatal assertion that fails during the call.
+/// @tparam FunctionT Type of the function.
+/// @param function The function, which is called without arguments.
+/// @return The report of the failed assertion, or \c std::nullopt if the function returned normally.
+template <typename FunctionT>
+std::optional<std::string> failure_report(FunctionT&& function) {
+    ThrowOnFailure const handler;
+    try {
+        std::forward<FunctionT>(function)();
+    } catch (AssertionFailure const& failure) {
+        return failure.report();
+    }
+    return std::nullopt;
+}
+} // namespace kassert::testing
@@ -0,0 +1,77 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Range executor that checks large ranges with a team of \c std::thread.
+///
+/// This header uses \c std::thread and is not included by \c kassert/kassert.hpp. Programs using it must link a
+/// threading library, e.g., the CMake target \c Threads::Threads.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "kassert/range.hpp"
+
+namespace kassert {
+/// @brief Range executor that runs the chunks of parallel range checks on a team of threads.
+///
+/// The threads are started for each parallel check and joined before the check returns; the calling thread takes part
+/// in the check. Thus, the executor is meant for expensive checks of large ranges, for which the cost of starting the
+/// threads is negligible (see \c KASSERT_PARALLEL_RANGE_MIN_SIZE).
+class ThreadRangeExecutor final : public RangeExecutor {
+public:
+    /// @brief Constructs the executor.
+    /// @param threads Number of threads that check a range, including the calling thread. Defaults to the number of
+    /// hardware threads.
+    /// @param min_parallel_size Minimum number of elements of ranges that are checked in parallel.
+    explicit ThreadRangeExecutor(
+        std::size_t const threads           = std::thread::hardware_concurrency(),
+        std::size_t const min_parallel_size = KASSERT_PARALLEL_RANGE_MIN_SIZE
+    )
+        : RangeExecutor(min_parallel_size),
+          _threads(std::max<std::size_t>(threads, 1)) {}
+
+    /// @brief Runs the tasks on the calling thread and up to `concurrency() - 1` additional threads, which take the
+    /// next task from a shared counter.
+    /// @param tasks The number of tasks.
+    /// @param task The task.
+    void run(std::size_t const tasks, RangeTask const& task) override {
+        if (tasks == 0) {
+            return;
+        }
+        std::atomic<std::size_t> next{0};
+        auto const               work = [&] {
+            for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < tasks;
+                 i             = next.fetch_add(1, std::memory_order_relaxed)) {
+                task(i);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        std::size_t const        helpers = std::min(_threads, tasks) - 1;
+        workers.reserve(helpers);
+        for (std::size_t i = 0; i < helpers; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker: workers) {
+            worker.join();
+        }
+    }
+
+    /// @brief Returns the number of threads that check a range.
+    /// @return The number of threads.
+    [[nodiscard]] std::size_t concurrency() const override {
+        return _threads;
+    }
+
+private:
+    std::size_t _threads; ///< @brief Number of threads that check a range, including the calling thread.
+};
+} // namespace kassert
@@ -0,0 +1,451 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+/// @file
+/// @brief Assertions whose evaluation is capped at a fraction of the wall time of each thread.
+///
+/// A time budget, e.g., 2%, is assigned to an assertion level using \c kassert::set_time_budget(). Each thread then
+/// spends at most this fraction of its wall time (plus a bounded burst, see \c KASSERT_TIME_BUDGET_WINDOW) on
+/// evaluating the assertions of this level declared with KASSERT_TIME_BUDGETED() or KASSERT_TIME_BUDGETED_BLOCK(). The
+/// time is measured with the cycle counter of the CPU. Once the budget of a thread is exhausted, evaluations are
+/// skipped until the thread has accumulated enough budget again, i.e., the fraction of evaluated assertions adapts to
+/// their cost. The number of evaluated and skipped assertions per level is reported at program exit if some evaluation
+/// was skipped, and on demand using \c kassert::print_time_budget_report().
+///
+/// This header is not included by \c kassert/kassert.hpp.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "kassert/internal/cycle_counter.hpp"
+#include "kassert/kassert.hpp"
+
+#ifndef KASSERT_TIME_BUDGET_WINDOW
+    /// @brief Maximum number of cycles of budget that a thread accumulates while it does not evaluate time-budgeted
+    /// assertions, multiplied by the time budget. Bounds the burst of evaluations after an idle period.
+    #define KASSERT_TIME_BUDGET_WINDOW (1ull << 26)
+#endif
+
+/// @brief Time-budgeted assertion macro. Requires exactly three parameters.
+/// @ingroup assertion
+///
+/// Behaves like KASSERT(), but if a time budget is set for its level (see \c kassert::set_time_budget()), the
+/// assertion is only evaluated while the calling thread has budget left. Deciding whether to evaluate the assertion
+/// reads the cycle counter once; evaluating it reads the cycle counter a second time to charge the elapsed cycles. If
+/// no time budget is set for the level, the assertion behaves like KASSERT().
+///
+/// The macro requires 3 parameters:
+/// 1. The assertion expression.
+/// 2. Error message that is printed in addition to the decomposed expression (use `""` for no message).
+/// 3. The level of the assertion (see @ref assertion-levels).
+#define KASSERT_TIME_BUDGETED(expression, message, level) \
+    KASSERT_KASSERT_HPP_KASSERT_TIME_BUDGETED_IMPL("ASSERTION", expression, message, level)
+
+/// @brief Charges a block of assertions to the time budget of a level. Must be followed by a compound statement.
+/// @ingroup assertion
+///
+/// The block is executed if the assertion level is enabled and the calling thread has budget left, and the time spent
+/// in the block is charged to the budget. Thus, a block of several assertions (and the code that prepares them) is
+/// either executed completely or skipped:
+///
+/// ```
+/// KASSERT_TIME_BUDGETED_BLOCK(kassert::assert::heavy) {
+///     auto const copy = sorted_copy(data);
+///     KASSERT(std::adjacent_find(copy.begin(), copy.end()) == copy.end(), "duplicate elements");
+/// }
+/// ```
+///
+/// Blocks of the same level must not be nested, as the inner block would be charged twice.
+/// @param level The level of the assertions in the block (see @ref assertion-levels).
+#define KASSERT_TIME_BUDGETED_BLOCK(level)                                                \
+    if constexpr (!kassert::internal::assertion_enabled(level)) {                         \
+    } else if (!KASSERT_KASSERT_HPP_RUNTIME_ASSERTION_ENABLED(level)) {                   \
+    } else if (kassert::internal::TimeBudgetScope const kassert_time_budget_scope(level); \
+               !kassert_time_budget_scope.admitted()) {                                   \
+    } else
+
+/// @cond IMPLEMENTATION
+
+// Implementation of KASSERT_TIME_BUDGETED(): a time-budgeted block containing a single assertion, wrapped in a pseudo
+// loop to act like a statement.
+#define KASSERT_KASSERT_HPP_KASSERT_TIME_BUDGETED_IMPL(type, expression, message, level)  \
+    do {                                                                                  \
+        KASSERT_TIME_BUDGETED_BLOCK(level) {                                              \
+            KASSERT_KASSERT_HPP_EVALUATE_ASSERTION_IMPL(type, expression, message, level) \
+        }                                                                                 \
+    } while (false)
+
+/// @endcond
+
+namespace kassert {
+/// @brief Statistics of the time-budgeted assertions of a single level, aggregated over all threads.
+struct TimeBudgetStatistics {
+    /// @brief The assertion level. The statistics of level \c 0 also contain assertions with negative levels, the
+    /// statistics of the highest level also contain assertions of all higher levels.
+    int level;
+    /// @brief The time budget of the level, as a fraction of the wall time.
+    double budget;
+    /// @brief Number of evaluated assertions or blocks.
+    std::uint64_t evaluations;
+    /// @brief Number of skipped assertions or blocks.
+    std::uint64_t skipped;
+    /// @brief Cycles spent evaluating assertions or blocks.
+    std::uint64_t cycles;
+    /// @brief Cycles elapsed between the first and the last time-budgeted assertion of each thread, summed over all
+    /// threads.
+    std::uint64_t elapsed_cycles;
+
+    /// @brief Fraction of the assertions that were evaluated.
+    /// @return The coverage, or \c 1 if no assertion was reached.
+    [[nodiscard]] double coverage() const {
+        std::uint64_t const reached = evaluations + skipped;
+        return reached == 0 ? 1.0 : static_cast<double>(evaluations) / static_cast<double>(reached);
+    }
+
+    /// @brief Fraction of the elapsed time that was spent evaluating assertions.
+    /// @return The fraction, or \c 0 if no time elapsed.
+    [[nodiscard]] double time_fraction() const {
+        return elapsed_cycles == 0 ? 0.0 : static_cast<double>(cycles) / static_cast<double>(elapsed_cycles);
+    }
+};
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Time budgets are stored as fixed-point fractions with this denominator.
+constexpr std::uint64_t time_budget_scale = 1u << 16;
+
+/// @brief Time budgets, indexed by the assertion level (see \c budget_slot()).
+///
+/// A value of \c 0 means that the level has no time budget, otherwise the budget is `(value - 1) / time_budget_scale`.
+/// Thus, the zero-initialized table does not limit any level.
+inline std::atomic<std::uint32_t> time_budgets[budget_levels]{};
+
+/// @brief Returns the encoded time budget of a level (see \c time_budgets).
+/// @param level The assertion level.
+/// @return The scaled time budget plus one, or \c 0 if the level has no time budget.
+KASSERT_KASSERT_HPP_ATTRIBUTE_ALWAYS_INLINE inline std::uint32_t encoded_time_budget(int const level) {
+    return time_budgets[budget_slot(level)].load(std::memory_order_relaxed);
+}
+
+/// @brief Decodes a time budget.
+/// @param encoded The encoded time budget (see \c time_budgets).
+/// @return The time budget as a fraction of the wall time, \c 1 if there is no time budget.
+inline double decode_time_budget(std::uint32_t const encoded) {
+    return encoded == 0 ? 1.0 : static_cast<double>(encoded - 1) / static_cast<double>(time_budget_scale);
+}
+
+/// @brief Budget of a single thread for the time-budgeted assertions of a single level (token bucket).
+///
+/// The budget and the timestamp are only accessed by the owning thread. The counters may be read concurrently while a
+/// report is created and are thus atomics that are updated with relaxed loads and stores.
+class TimeBudgetAccount {
+public:
+    /// @brief Decides whether the next assertion is evaluated. First credits the budget earned since the previous
+    /// decision (the elapsed cycles multiplied by the time budget, capped at a burst of
+    /// \c KASSERT_TIME_BUDGET_WINDOW times the time budget), then admits the assertion if the budget is positive.
+    /// @param budget The time budget, scaled by \c time_budget_scale.
+    /// @param now The current value of the cycle counter.
+    /// @return Whether the assertion should be evaluated.
+    bool admit(std::uint64_t const budget, std::uint64_t const now) {
+        std::int64_t const burst = static_cast<std::int64_t>(KASSERT_TIME_BUDGET_WINDOW * budget);
+        if (_last == 0) {
+            // the first decision of this thread starts with a full bucket
+            _credit = burst;
+        } else {
+            std::uint64_t const elapsed = now > _last ? now - _last : 0;
+            add(_elapsed_cycles, elapsed);
+            std::uint64_t const earned = std::min<std::uint64_t>(elapsed, KASSERT_TIME_BUDGET_WINDOW) * budget;
+            _credit                    = std::min(_credit + static_cast<std::int64_t>(earned), burst);
+        }
+        _last = now;
+        if (_credit > 0) {
+            add(_evaluations, 1);
+            return true;
+        }
+        add(_skipped, 1);
+        return false;
+    }
+
+    /// @brief Charges the cycles spent evaluating an admitted assertion.
+    /// @param cycles The elapsed cycles.
+    void charge(std::uint64_t const cycles) {
+        _credit -= static_cast<std::int64_t>(cycles * time_budget_scale);
+        add(_cycles, cycles);
+    }
+
+    /// @brief Adds the counters of this account to the statistics of its level.
+    /// @param statistics The statistics.
+    void collect(TimeBudgetStatistics& statistics) const {
+        statistics.evaluations += _evaluations.load(std::memory_order_relaxed);
+        statistics.skipped += _skipped.load(std::memory_order_relaxed);
+        statistics.cycles += _cycles.load(std::memory_order_relaxed);
+        statistics.elapsed_cycles += _elapsed_cycles.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Resets the counters, but not the budget.
+    void reset() {
+        _evaluations.store(0, std::memory_order_relaxed);
+        _skipped.store(0, std::memory_order_relaxed);
+        _cycles.store(0, std::memory_order_relaxed);
+        _elapsed_cycles.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Increments a counter that is only written by the owning thread.
+    /// @param counter The counter.
+    /// @param value The value to add.
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t const value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::int64_t               _credit = 0;        ///< @brief Remaining budget, scaled by \c time_budget_scale.
+    std::uint64_t              _last   = 0;        ///< @brief Cycle counter at the previous decision, or zero.
+    std::atomic<std::uint64_t> _evaluations{0};    ///< @brief Number of admitted assertions.
+    std::atomic<std::uint64_t> _skipped{0};        ///< @brief Number of skipped assertions.
+    std::atomic<std::uint64_t> _cycles{0};         ///< @brief Cycles charged for admitted assertions.
+    std::atomic<std::uint64_t> _elapsed_cycles{0}; ///< @brief Cycles elapsed since the first decision.
+};
+
+class TimeBudgetAccounts;
+
+/// @brief Registry of the accounts of all threads that reached time-budgeted assertions.
+class TimeBudgetRegistry {
+public:
+    /// @brief Registers the accounts of a thread.
+    /// @param accounts The accounts.
+    void attach(TimeBudgetAccounts& accounts) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(&accounts);
+    }
+
+    /// @brief Merges the accounts of an exiting thread into the registry and deregisters them.
+    /// @param accounts The accounts.
+    void detach(TimeBudgetAccounts& accounts);
+
+    /// @brief Collects the statistics of all levels, aggregated over all threads.
+    /// @return The statistics of all levels for which some time-budgeted assertion was reached, sorted by level.
+    std::vector<TimeBudgetStatistics> collect();
+
+    /// @brief Resets the statistics of all levels.
+    void reset();
+
+private:
+    std::mutex                       _mutex;                   ///< @brief Protects all members.
+    TimeBudgetStatistics             _exited[budget_levels]{}; ///< @brief Counters of exited threads.
+    std::vector<TimeBudgetAccounts*> _threads;                 ///< @brief Accounts of running threads.
+};
+
+/// @brief Returns the global time budget registry. The registry is never destroyed, such that threads can still
+/// merge their accounts after static destruction has started.
+/// @return The registry.
+inline TimeBudgetRegistry& time_budget_registry() {
+    static TimeBudgetRegistry* registry = new TimeBudgetRegistry();
+    return *registry;
+}
+
+/// @brief Accounts of a single thread for all levels, indexed by \c budget_slot().
+class TimeBudgetAccounts {
+public:
+    /// @brief Registers the accounts with the registry.
+    TimeBudgetAccounts() {
+        time_budget_registry().attach(*this);
+    }
+
+    /// @brief Accounts cannot be copied.
+    TimeBudgetAccounts(TimeBudgetAccounts const&) = delete;
+
+    /// @brief Accounts cannot be copied.
+    /// @return This object.
+    TimeBudgetAccounts& operator=(TimeBudgetAccounts const&) = delete;
+
+    /// @brief Merges the accounts into the registry.
+    ~TimeBudgetAccounts() {
+        time_budget_registry().detach(*this);
+    }
+
+    /// @brief Returns the account of a level.
+    /// @param slot The index of the level, see \c budget_slot().
+    /// @return The account.
+    TimeBudgetAccount& operator[](std::size_t const slot) {
+        return _accounts[slot];
+    }
+
+private:
+    TimeBudgetAccount _accounts[budget_levels]{}; ///< @brief The accounts, indexed by \c budget_slot().
+};
+
+inline void TimeBudgetRegistry::detach(TimeBudgetAccounts& accounts) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t slot = 0; slot < static_cast<std::size_t>(budget_levels); ++slot) {
+        accounts[slot].collect(_exited[slot]);
+    }
+    _threads.erase(std::find(_threads.begin(), _threads.end(), &accounts));
+}
+
+inline std::vector<TimeBudgetStatistics> TimeBudgetRegistry::collect() {
+    std::lock_guard<std::mutex>       lock(_mutex);
+    std::vector<TimeBudgetStatistics> statistics;
+    for (std::size_t slot = 0; slot < static_cast<std::size_t>(budget_levels); ++slot) {
+        TimeBudgetStatistics level_statistics = _exited[slot];
+        for (TimeBudgetAccounts* accounts: _threads) {
+            (*accounts)[slot].collect(level_statistics);
+        }
+        if (level_statistics.evaluations + level_statistics.skipped > 0) {
+            level_statistics.level  = static_cast<int>(slot);
+            level_statistics.budget = decode_time_budget(encoded_time_budget(static_cast<int>(slot)));
+            statistics.push_back(level_statistics);
+        }
+    }
+    return statistics;
+}
+
+inline void TimeBudgetRegistry::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t slot = 0; slot < static_cast<std::size_t>(budget_levels); ++slot) {
+        _exited[slot] = TimeBudgetStatistics{};
+        for (TimeBudgetAccounts* accounts: _threads) {
+            (*accounts)[slot].reset();
+        }
+    }
+}
+
+/// @brief Returns the accounts of the calling thread.
+/// @return The accounts of the calling thread.
+inline TimeBudgetAccounts& time_budget_accounts() {
+    thread_local TimeBudgetAccounts accounts;
+    return accounts;
+}
+
+/// @brief Admits a time-budgeted assertion or block on construction and charges the elapsed cycles to the budget of
+/// the calling thread on destruction.
+class TimeBudgetScope {
+public:
+    /// @brief Decides whether the assertion or block is executed.
+    /// @param level The level of the assertion or block.
+    explicit TimeBudgetScope(int const level) : _account(nullptr), _start(0), _admitted(true) {
+        std::uint32_t const budget = encoded_time_budget(level);
+        if (budget == 0) {
+            return;
+        }
+        TimeBudgetAccount&  account = time_budget_accounts()[budget_slot(level)];
+        std::uint64_t const now     = read_cycle_counter();
+        _admitted                   = account.admit(budget - 1, now);
+        if (_admitted) {
+            _account = &account;
+            _start   = now;
+        }
+    }
+
+    /// @brief Scopes cannot be copied.
+    TimeBudgetScope(TimeBudgetScope const&) = delete;
+
+    /// @brief Scopes cannot be copied.
+    /// @return This object.
+    TimeBudgetScope& operator=(TimeBudgetScope const&) = delete;
+
+    /// @brief Charges the elapsed cycles if the assertion or block was admitted.
+    ~TimeBudgetScope() {
+        if (_account != nullptr) {
+            _account->charge(read_cycle_counter() - _start);
+        }
+    }
+
+    /// @brief Whether the assertion or block should be executed.
+    /// @return \c true if the level has no time budget or the calling thread has budget left.
+    [[nodiscard]] bool admitted() const {
+        return _admitted;
+    }
+
+private:
+    TimeBudgetAccount* _account;  ///< @brief The charged account, or \c nullptr if nothing is charged.
+    std::uint64_t      _start;    ///< @brief Cycle counter at admission.
+    bool               _admitted; ///< @brief Whether the assertion or block is executed.
+};
+} // namespace kassert::internal
+
+namespace kassert {
+/// @brief Sets the time budget of an assertion level. Each thread spends at most this fraction of its wall time on
+/// evaluating the time-budgeted assertions of this level (see KASSERT_TIME_BUDGETED()). The budget is resolved to
+/// multiples of `1 / 65536`.
+/// @param level The assertion level.
+/// @param fraction The time budget as a fraction of the wall time. A value of at least \c 1 removes the time budget,
+/// i.e., all assertions of the level are evaluated without reading the cycle counter; a value of \c 0 skips all
+/// assertions of the level.
+/// @return The previous time budget of the level, \c 1 if it had no time budget.
+inline double set_time_budget(int const level, double const fraction) {
+    std::uint32_t encoded = 0;
+    if (!(fraction >= 1.0)) {
+        double const scaled = fraction > 0.0 ? fraction * static_cast<double>(internal::time_budget_scale) : 0.0;
+        encoded             = static_cast<std::uint32_t>(scaled + 0.5) + 1;
+        encoded             = std::min(encoded, static_cast<std::uint32_t>(internal::time_budget_scale));
+    }
+    std::uint32_t const previous =
+        internal::time_budgets[internal::budget_slot(level)].exchange(encoded, std::memory_order_relaxed);
+    return internal::decode_time_budget(previous);
+}
+
+/// @brief Returns the time budget of an assertion level.
+/// @param level The assertion level.
+/// @return The time budget as a fraction of the wall time, \c 1 if the level has no time budget.
+inline double time_budget(int const level) {
+    return internal::decode_time_budget(internal::encoded_time_budget(level));
+}
+
+/// @brief Collects the statistics of the time-budgeted assertions of all levels, aggregated over all threads.
+/// Assertions of levels without time budget are not counted.
+/// @return The statistics of all levels for which some time-budgeted assertion was reached, sorted by level.
+inline std::vector<TimeBudgetStatistics> time_budget_statistics() {
+    return internal::time_budget_registry().collect();
+}
+
+/// @brief Resets the statistics of the time-budgeted assertions of all levels. The remaining budgets of the threads
+/// are not affected.
+inline void reset_time_budget_statistics() {
+    internal::time_budget_registry().reset();
+}
+
+/// @brief Prints the coverage of the time-budgeted assertions of all levels, i.e., the number of evaluated and skipped
+/// assertions and the fraction of the wall time spent evaluating them.
+/// @param out The output stream.
+inline void print_time_budget_report(std::ostream& out) {
+    out << std::left << std::setw(8) << "level" << std::setw(10) << "budget" << std::setw(16) << "evaluations"
+        << std::setw(16) << "skipped" << std::setw(12) << "coverage"
+        << "time\n";
+    for (auto const& level: time_budget_statistics()) {
+        out << std::left << std::setw(8) << level.level << std::fixed << std::setprecision(2) << std::setw(10)
+            << level.budget * 100.0 << std::setw(16) << level.evaluations << std::setw(16) << level.skipped
+            << std::setw(12) << level.coverage() * 100.0 << level.time_fraction() * 100.0 << std::defaultfloat
+            << "\n";
+    }
+}
+} // namespace kassert
+
+namespace kassert::internal {
+/// @brief Prints the time budget report at program exit if some time-budgeted assertion was skipped, i.e., if the
+/// coverage of some level is incomplete.
+inline void print_time_budget_report_at_exit() {
+    auto const statistics = time_budget_statistics();
+    if (std::none_of(statistics.begin(), statistics.end(), [](auto const& level) { return level.skipped > 0; })) {
+        return;
+    }
+    std::cerr << "KAssert: some time-budgeted assertions were skipped (budget, coverage and time in percent):\n";
+    print_time_budget_report(std::cerr);
+}
+
+/// @brief Registers \c print_time_budget_report_at_exit() with \c std::atexit() during static initialization. Since
+/// objects with thread storage duration of the main thread are destroyed before the handler runs, the report contains
+/// the accounts of the main thread.
+[[maybe_unused]] inline bool const time_budget_report_at_exit_registered =
+    (time_budget_registry(), std::atexit(print_time_budget_report_at_exit) == 0);
+} // namespace kassert::internal
@@ -0,0 +1,22 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Compiles the non-template failure-path functions of KAssert into the runtime library (CMake target
+// kassert::runtime). Translation units linking the library only reference these functions instead of defining them
+// inline.
+
+#ifndef KASSERT_RUNTIME_LIBRARY
+    #error "The runtime library must be compiled with KASSERT_RUNTIME_LIBRARY defined."
+#endif
+
+// The functions in the runtime library do not depend on the assertion level
+#ifndef KASSERT_ASSERTION_LEVEL
+    #define KASSERT_ASSERTION_LEVEL 0
+#endif
+
+#include "kassert/kassert.hpp"
+
+#include "kassert/internal/core_impl.hpp"
+#include "kassert/internal/exception_impl.hpp"
+#include "kassert/internal/kassert_impl.hpp"
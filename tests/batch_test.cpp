@@ -0,0 +1,104 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstddef>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/batch.hpp"
+#include "kassert/gmock.hpp"
+
+using namespace ::testing;
+using kassert::testing::FailsAssertion;
+
+namespace {
+/// @brief Sums up values and checks that they are non-negative in a batch.
+int checked_sum(std::vector<int> const& values) {
+    int sum = 0;
+    KASSERT_BATCH(nonnegative, i, values[i] >= 0, "negative value");
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        nonnegative.check(i);
+        sum += values[i];
+    }
+    return sum;
+}
+} // namespace
+
+TEST(BatchTest, failures_are_reported_at_scope_exit) {
+    EXPECT_THAT(
+        [] { checked_sum({1, 2, -3, 4, -5}); },
+        FailsAssertion(HasSubstr(
+            "FAILED ASSERTION\n\tvalues[i] >= 0\nwith expansion:\n\t-3 >= 0\n"
+            "first failure at index 2 (2 failed check(s) in total)\nnegative value"
+        ))
+    );
+    EXPECT_EQ(checked_sum({1, 2, 3}), 6);
+    EXPECT_EQ(checked_sum({}), 0);
+}
+
+TEST(BatchTest, failures_are_counted_before_scope_exit) {
+    std::vector<int> const values{3, 1, 2};
+    EXPECT_THAT(
+        [&] {
+            KASSERT_BATCH(sorted, i, values[i] <= values[i + 1]);
+            for (std::size_t i = values.size() - 1; i-- > 0;) {
+                sorted.check(i);
+            }
+            EXPECT_EQ(sorted.failures(), 1u);
+        },
+        FailsAssertion(HasSubstr("\tvalues[i] <= values[i + 1]\nwith expansion:\n\t3 <= 1\nfirst failure at index 0"))
+    );
+}
+
+TEST(BatchTest, undecomposable_expressions_are_reported) {
+    std::vector<int> const values{1, 20, 3};
+    EXPECT_THAT(
+        [&] {
+            KASSERT_BATCH(in_range, i, values[i] > 0 && values[i] < 10, "", kassert::assert::normal);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                in_range.check(i);
+            }
+        },
+        FailsAssertion(HasSubstr("\tvalues[i] > 0 && values[i] < 10\nfirst failure at index 1 (1 failed check(s)"))
+    );
+}
+
+TEST(BatchTest, batches_of_disabled_levels_are_not_evaluated) {
+    int  evaluations = 0;
+    auto evaluate    = [&](std::size_t) {
+        ++evaluations;
+        return false;
+    };
+    {
+        KASSERT_BATCH(disabled, i, evaluate(i), "", kassert::assert::normal + 1);
+        for (std::size_t i = 0; i < 10; ++i) {
+            disabled.check(i);
+        }
+        EXPECT_EQ(disabled.failures(), 0u);
+    }
+    EXPECT_EQ(evaluations, 0);
+}
+
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+TEST(BatchTest, runtime_level_is_checked_when_the_batch_is_declared) {
+    int const level = kassert::assertion_level();
+    kassert::set_assertion_level(kassert::assert::normal - 1);
+    int  evaluations = 0;
+    auto evaluate    = [&](std::size_t) {
+        ++evaluations;
+        return false;
+    };
+    {
+        KASSERT_BATCH(disabled, i, evaluate(i));
+        kassert::set_assertion_level(level);
+        disabled.check(0);
+    }
+    EXPECT_EQ(evaluations, 0);
+}
+#endif
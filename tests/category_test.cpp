@@ -0,0 +1,85 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <gmock/gmock.h>
+
+#include "kassert/gmock.hpp"
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+using kassert::testing::FailsAssertion;
+
+// Dummy assertion levels for tests
+namespace assert {
+constexpr int light = kassert::assert::normal - 10;
+constexpr int heavy = kassert::assert::normal + 10;
+} // namespace assert
+
+// The category levels are set in tests/CMakeLists.txt.
+static_assert(kassert::internal::category_level("heavy_component", KASSERT_CATEGORY_LEVELS, 30) == 40);
+static_assert(kassert::internal::category_level("disabled_component", KASSERT_CATEGORY_LEVELS, 30) == 0);
+static_assert(kassert::internal::category_level("overridden_component", KASSERT_CATEGORY_LEVELS, 30) == 20);
+static_assert(kassert::internal::category_level("unknown_component", KASSERT_CATEGORY_LEVELS, 30) == 30);
+
+static_assert(kassert::internal::category_level("a", "", 30) == 30);
+static_assert(kassert::internal::category_level("a", "a=-5", 30) == -5);
+static_assert(kassert::internal::category_level("a", "ab=10,a=20,b=40", 30) == 20);
+static_assert(kassert::internal::category_level("ab", "a=10", 30) == 30);
+static_assert(kassert::internal::category_level("a", "a=10,a=50", 30) == 50);
+
+TEST(CategoryTest, category_levels_override_assertion_level) {
+    EXPECT_TRUE(KASSERT_CATEGORY_ENABLED(heavy_component, assert::heavy));
+    EXPECT_FALSE(KASSERT_CATEGORY_ENABLED(heavy_component, assert::heavy + 1));
+    EXPECT_FALSE(KASSERT_CATEGORY_ENABLED(disabled_component, assert::light));
+    EXPECT_TRUE(KASSERT_CATEGORY_ENABLED(disabled_component, 0));
+    EXPECT_TRUE(KASSERT_CATEGORY_ENABLED(unknown_component, kassert::assert::normal));
+    EXPECT_FALSE(KASSERT_CATEGORY_ENABLED(unknown_component, assert::heavy));
+}
+
+TEST(CategoryTest, assertions_of_enabled_categories_are_checked) {
+    int const lhs = 2;
+    EXPECT_THAT(
+        [&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3, "message", assert::heavy); },
+        FailsAssertion(HasSubstr("FAILED ASSERTION [heavy_component]\n\tlhs == 3\nwith expansion:\n\t2 == 3\nmessage"))
+    );
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(unknown_component, lhs == 3); }, FailsAssertion());
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(overridden_component, lhs == 3, "", assert::light); }, FailsAssertion());
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 2, "", assert::heavy); }, Not(FailsAssertion()));
+}
+
+TEST(CategoryTest, assertions_of_disabled_categories_are_not_evaluated) {
+    int  evaluations = 0;
+    auto evaluate    = [&] {
+        ++evaluations;
+        return false;
+    };
+    KASSERT_IN_CATEGORY(disabled_component, evaluate(), "", assert::light);
+    KASSERT_IN_CATEGORY(overridden_component, evaluate());
+    KASSERT_IN_CATEGORY(unknown_component, evaluate(), "", assert::heavy);
+    EXPECT_EQ(evaluations, 0);
+}
+
+#ifdef KASSERT_RUNTIME_ASSERTION_LEVEL
+TEST(CategoryTest, runtime_level_gates_all_levels_of_a_category) {
+    int const level = kassert::assertion_level();
+    int const lhs   = 2;
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3, "", assert::heavy); }, FailsAssertion());
+
+    // lowering the runtime level disables expensive assertions of a raised category before cheap ones
+    kassert::set_assertion_level(kassert::assert::normal);
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3); }, FailsAssertion());
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3, "", assert::heavy); }, Not(FailsAssertion()));
+
+    kassert::set_assertion_level(assert::light);
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(unknown_component, lhs == 3); }, Not(FailsAssertion()));
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3); }, Not(FailsAssertion()));
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3, "", assert::heavy); }, Not(FailsAssertion()));
+    EXPECT_THAT([&] { KASSERT_IN_CATEGORY(heavy_component, lhs == 3, "", assert::light); }, FailsAssertion());
+    kassert::set_assertion_level(level);
+}
+#endif
@@ -4,10 +4,22 @@ include(GoogleTest)
 
 # Convenience wrapper for adding tests for Kassert.
 #
-# TARGET_NAME the target name EXCEPTION_MODE option to run tests in exception or assertion mode FILES the files of the
-# target
+# TARGET_NAME the target name EXCEPTION_MODE option to run tests in exception or assertion mode RUNTIME_ASSERTION_LEVEL
+# option to enable the runtime assertion level INSTRUMENTATION option to enable the instrumentation mode RUNTIME_LIBRARY
+# option to link the compiled runtime library COMPACT_CALL_SITES option to emit the call site metadata as constant
+# records STRIP_FUNCTION_NAMES option to strip template arguments from function names TYPE_ERASED_OPERANDS option to
+# format type-erased operands on the failure paths FILES the files of the target
 function (kassert_register_test KASSERT_TARGET_NAME)
-    cmake_parse_arguments("KASSERT" "EXCEPTION_MODE" "" "FILES" ${ARGN})
+    set(KASSERT_OPTIONS
+        EXCEPTION_MODE
+        RUNTIME_ASSERTION_LEVEL
+        INSTRUMENTATION
+        RUNTIME_LIBRARY
+        COMPACT_CALL_SITES
+        STRIP_FUNCTION_NAMES
+        TYPE_ERASED_OPERANDS
+    )
+    cmake_parse_arguments("KASSERT" "${KASSERT_OPTIONS}" "" "FILES" ${ARGN})
     add_executable(${KASSERT_TARGET_NAME} ${KASSERT_FILES})
     target_link_libraries(${KASSERT_TARGET_NAME} PRIVATE gtest gtest_main gmock kassert_base)
     target_compile_options(${KASSERT_TARGET_NAME} PRIVATE ${KASSERT_WARNING_FLAGS})
@@ -16,6 +28,30 @@ function (kassert_register_test KASSERT_TARGET_NAME)
     if (KASSERT_EXCEPTION_MODE)
         target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_EXCEPTION_MODE)
     endif ()
+
+    if (KASSERT_RUNTIME_ASSERTION_LEVEL)
+        target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_RUNTIME_ASSERTION_LEVEL)
+    endif ()
+
+    if (KASSERT_INSTRUMENTATION)
+        target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_INSTRUMENTATION)
+    endif ()
+
+    if (KASSERT_RUNTIME_LIBRARY)
+        target_link_libraries(${KASSERT_TARGET_NAME} PRIVATE kassert_runtime)
+    endif ()
+
+    if (KASSERT_COMPACT_CALL_SITES)
+        target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_COMPACT_CALL_SITES)
+    endif ()
+
+    if (KASSERT_STRIP_FUNCTION_NAMES)
+        target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_STRIP_FUNCTION_NAMES)
+    endif ()
+
+    if (KASSERT_TYPE_ERASED_OPERANDS)
+        target_compile_options(${KASSERT_TARGET_NAME} PRIVATE -DKASSERT_TYPE_ERASED_OPERANDS)
+    endif ()
 endfunction ()
 
 # Registers a set of tests which should fail to compile.
@@ -63,3 +99,41 @@ function (kassert_register_compilation_failure_test)
         set_tests_properties("${THIS_TARGETS_NAME}" PROPERTIES WILL_FAIL TRUE)
     endforeach ()
 endfunction ()
+
+# Open MPI refuses to start more processes than cores and to run as root unless told otherwise
+set(KASSERT_MPIEXEC_FLAGS "")
+set(KASSERT_MPIEXEC_ENVIRONMENT "")
+if (MPIEXEC_EXECUTABLE)
+    execute_process(COMMAND ${MPIEXEC_EXECUTABLE} --version OUTPUT_VARIABLE KASSERT_MPIEXEC_VERSION ERROR_QUIET)
+    if (KASSERT_MPIEXEC_VERSION MATCHES "Open MPI|OpenRTE")
+        set(KASSERT_MPIEXEC_FLAGS "--oversubscribe")
+        set(KASSERT_MPIEXEC_ENVIRONMENT "OMPI_ALLOW_RUN_AS_ROOT=1;OMPI_ALLOW_RUN_AS_ROOT_CONFIRM=1")
+    endif ()
+endif ()
+
+# Registers a test that is run with multiple MPI processes. Requires the kassert_collective target.
+#
+# TARGET_NAME the target name CORES the number of MPI processes NO_GTEST option to not link gtest, i.e., the test
+# provides its own main() and passes or fails by its output (see PASS_REGULAR_EXPRESSION) PASS_REGULAR_EXPRESSION
+# regular expression that the output must match for the test to pass FILES the files of the target
+function (kassert_register_mpi_test KASSERT_TARGET_NAME)
+    cmake_parse_arguments("KASSERT" "NO_GTEST" "CORES;PASS_REGULAR_EXPRESSION" "FILES" ${ARGN})
+    add_executable(${KASSERT_TARGET_NAME} ${KASSERT_FILES})
+    target_link_libraries(${KASSERT_TARGET_NAME} PRIVATE kassert_base MPI::MPI_CXX)
+    target_compile_options(${KASSERT_TARGET_NAME} PRIVATE ${KASSERT_WARNING_FLAGS})
+    if (NOT KASSERT_NO_GTEST)
+        target_link_libraries(${KASSERT_TARGET_NAME} PRIVATE gtest gmock)
+    endif ()
+
+    add_test(
+        NAME ${KASSERT_TARGET_NAME}
+        COMMAND ${MPIEXEC_EXECUTABLE} ${MPIEXEC_NUMPROC_FLAG} ${KASSERT_CORES} ${KASSERT_MPIEXEC_FLAGS}
+                ${MPIEXEC_PREFLAGS} $<TARGET_FILE:${KASSERT_TARGET_NAME}> ${MPIEXEC_POSTFLAGS}
+    )
+    set_tests_properties(${KASSERT_TARGET_NAME} PROPERTIES ENVIRONMENT "${KASSERT_MPIEXEC_ENVIRONMENT}")
+    if (DEFINED KASSERT_PASS_REGULAR_EXPRESSION)
+        set_tests_properties(
+            ${KASSERT_TARGET_NAME} PROPERTIES PASS_REGULAR_EXPRESSION "${KASSERT_PASS_REGULAR_EXPRESSION}"
+        )
+    endif ()
+endfunction ()
@@ -0,0 +1,110 @@
+# Compares the code generated for codegen_reference.cpp with and without assertions. Invoked by ctest with:
+#
+# NM, OBJDUMP the binutils to use BASELINE object file without assertions DISABLED_KASSERT,
+# DISABLED_KASSERT_EXCEPTION_MODE, DISABLED_THROWING_KASSERT, DISABLED_KASSERT_IN_CATEGORY object files with disabled
+# assertions ENABLED_KASSERT, ENABLED_THROWING_KASSERT object files with enabled assertions
+# ENABLED_KASSERT_COMPACT_CALL_SITES object file with enabled assertions and KASSERT_COMPACT_CALL_SITES
+# ENABLED_KASSERT_TYPE_ERASED_OPERANDS object file with enabled assertions and KASSERT_TYPE_ERASED_OPERANDS CALL_SITES
+# number of assertion call sites in the reference file
+# MAX_BYTES_PER_CALL_SITE maximum number of bytes an enabled assertion may add to the hot code
+#
+# Disabled assertions must not leave any residue, i.e., the disassembly of the .text section must be identical to the
+# baseline. For enabled assertions, the size of the reference functions (excluding the parts that the compiler moved
+# to cold sections) may grow by at most MAX_BYTES_PER_CALL_SITE bytes per call site. With KASSERT_COMPACT_CALL_SITES,
+# the reference functions must not be larger than without.
+cmake_minimum_required(VERSION 3.13)
+
+# Disassembles the .text section of an object file, without the file name.
+function (kassert_disassemble OBJECT OUTPUT_VARIABLE)
+    execute_process(
+        COMMAND ${OBJDUMP} -d --no-show-raw-insn -j .text ${OBJECT}
+        OUTPUT_VARIABLE DISASSEMBLY
+        RESULT_VARIABLE RESULT
+    )
+    if (NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Could not disassemble ${OBJECT}")
+    endif ()
+    string(REGEX REPLACE "[^\n]*file format[^\n]*\n" "" DISASSEMBLY "${DISASSEMBLY}")
+    set(${OUTPUT_VARIABLE}
+        "${DISASSEMBLY}"
+        PARENT_SCOPE
+    )
+endfunction ()
+
+# Computes the total size of the reference functions kassert_codegen_*, excluding cold parts (kassert_codegen_*.cold).
+function (kassert_text_size OBJECT OUTPUT_VARIABLE)
+    execute_process(
+        COMMAND ${NM} -S --defined-only ${OBJECT}
+        OUTPUT_VARIABLE SYMBOLS
+        RESULT_VARIABLE RESULT
+    )
+    if (NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Could not list the symbols of ${OBJECT}")
+    endif ()
+    string(REPLACE "\n" ";" SYMBOLS "${SYMBOLS}")
+    set(SIZE 0)
+    foreach (SYMBOL ${SYMBOLS})
+        if (SYMBOL MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [tT] kassert_codegen_[a-z_]+$")
+            math(EXPR SIZE "${SIZE} + 0x${CMAKE_MATCH_1}")
+        endif ()
+    endforeach ()
+    if (SIZE EQUAL 0)
+        message(FATAL_ERROR "No reference functions found in ${OBJECT}")
+    endif ()
+    set(${OUTPUT_VARIABLE}
+        ${SIZE}
+        PARENT_SCOPE
+    )
+endfunction ()
+
+set(FAILED FALSE)
+
+kassert_disassemble(${BASELINE} BASELINE_DISASSEMBLY)
+kassert_text_size(${BASELINE} BASELINE_SIZE)
+message(STATUS "Baseline: ${BASELINE_SIZE} bytes")
+
+foreach (
+    VARIANT
+    DISABLED_KASSERT
+    DISABLED_KASSERT_EXCEPTION_MODE
+    DISABLED_THROWING_KASSERT
+    DISABLED_KASSERT_IN_CATEGORY
+)
+    kassert_disassemble(${${VARIANT}} DISASSEMBLY)
+    if (NOT DISASSEMBLY STREQUAL BASELINE_DISASSEMBLY)
+        message(SEND_ERROR "${VARIANT}: disabled assertions changed the generated code\n${DISASSEMBLY}")
+        set(FAILED TRUE)
+    else ()
+        message(STATUS "${VARIANT}: identical to baseline")
+    endif ()
+endforeach ()
+
+foreach (
+    VARIANT
+    ENABLED_KASSERT
+    ENABLED_THROWING_KASSERT
+    ENABLED_KASSERT_COMPACT_CALL_SITES
+    ENABLED_KASSERT_TYPE_ERASED_OPERANDS
+)
+    kassert_text_size(${${VARIANT}} SIZE)
+    set(${VARIANT}_SIZE ${SIZE})
+    math(EXPR BYTES_PER_CALL_SITE "(${SIZE} - ${BASELINE_SIZE}) / ${CALL_SITES}")
+    if (BYTES_PER_CALL_SITE GREATER MAX_BYTES_PER_CALL_SITE)
+        message(
+            SEND_ERROR
+                "${VARIANT}: ${SIZE} bytes, i.e., ${BYTES_PER_CALL_SITE} bytes per call site (limit: ${MAX_BYTES_PER_CALL_SITE})"
+        )
+        set(FAILED TRUE)
+    else ()
+        message(STATUS "${VARIANT}: ${SIZE} bytes, i.e., ${BYTES_PER_CALL_SITE} bytes per call site")
+    endif ()
+endforeach ()
+
+if (ENABLED_KASSERT_COMPACT_CALL_SITES_SIZE GREATER ENABLED_KASSERT_SIZE)
+    message(SEND_ERROR "ENABLED_KASSERT_COMPACT_CALL_SITES: larger than ENABLED_KASSERT")
+    set(FAILED TRUE)
+endif ()
+
+if (FAILED)
+    message(FATAL_ERROR "Codegen regression test failed")
+endif ()
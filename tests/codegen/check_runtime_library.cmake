@@ -0,0 +1,51 @@
+# Checks that an object file compiled with KASSERT_RUNTIME_LIBRARY only references the failure-path functions of the
+# runtime library instead of defining them. Invoked by ctest with:
+#
+# NM the nm binary to use OBJECT the object file to check
+cmake_minimum_required(VERSION 3.13)
+
+# Functions that must be defined by the runtime library only (demangled names).
+set(KASSERT_RUNTIME_SYMBOLS
+    "kassert::internal::build_what"
+    "kassert::internal::fail_with_description"
+    "kassert::internal::write_to"
+    "kassert::KassertException::~KassertException"
+    "vtable for kassert::KassertException"
+)
+
+execute_process(
+    COMMAND ${NM} -C ${OBJECT}
+    OUTPUT_VARIABLE SYMBOLS
+    RESULT_VARIABLE RESULT
+)
+if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "Could not list the symbols of ${OBJECT}")
+endif ()
+string(REPLACE "\n" ";" SYMBOLS "${SYMBOLS}")
+
+set(FAILED FALSE)
+set(REFERENCED FALSE)
+foreach (SYMBOL ${SYMBOLS})
+    foreach (RUNTIME_SYMBOL ${KASSERT_RUNTIME_SYMBOLS})
+        string(FIND "${SYMBOL}" "${RUNTIME_SYMBOL}" POSITION)
+        if (POSITION EQUAL -1)
+            continue()
+        endif ()
+        if (SYMBOL MATCHES "^ +U ")
+            set(REFERENCED TRUE)
+        else ()
+            message(SEND_ERROR "${RUNTIME_SYMBOL} is defined in the object file: ${SYMBOL}")
+            set(FAILED TRUE)
+        endif ()
+    endforeach ()
+endforeach ()
+
+if (NOT REFERENCED)
+    message(SEND_ERROR "The object file does not reference the runtime library")
+    set(FAILED TRUE)
+endif ()
+
+if (FAILED)
+    message(FATAL_ERROR "Runtime library check failed")
+endif ()
+message(STATUS "The object file only references the runtime library")
@@ -0,0 +1,67 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Reference translation unit for the codegen regression test (see check_codegen.cmake). Each function below contains
+// call sites of the assertion macro selected by KASSERT_CODEGEN_CHECK:
+//
+// - KASSERT_CODEGEN_CHECK=0: no assertions (baseline)
+// - KASSERT_CODEGEN_CHECK=1: KASSERT()
+// - KASSERT_CODEGEN_CHECK=2: THROWING_KASSERT()
+// - KASSERT_CODEGEN_CHECK=3: KASSERT_IN_CATEGORY() of category `codegen`
+//
+// The test compiles this file with different assertion levels and compares the generated code against the baseline.
+// Keep KASSERT_CODEGEN_CALL_SITES in CMakeLists.txt in sync with the number of CHECK() call sites in this file.
+
+#include <cstddef>
+
+#include "kassert/kassert.hpp"
+
+#if KASSERT_CODEGEN_CHECK == 1
+    #define CHECK(expression) KASSERT(expression)
+#elif KASSERT_CODEGEN_CHECK == 2
+    #define CHECK(expression) THROWING_KASSERT(expression)
+#elif KASSERT_CODEGEN_CHECK == 3
+    #define CHECK(expression) KASSERT_IN_CATEGORY(codegen, expression)
+#else
+    #define CHECK(expression)
+#endif
+
+extern "C" {
+int kassert_codegen_sum(int const* data, std::size_t const size) {
+    int sum = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        CHECK(data[i] >= 0);
+        sum += data[i];
+    }
+    return sum;
+}
+
+int kassert_codegen_divide(int const dividend, int const divisor) {
+    CHECK(divisor != 0);
+    CHECK(dividend >= 0 && divisor > 0);
+    return dividend / divisor;
+}
+
+int kassert_codegen_at(int const* data, std::size_t const size, std::size_t const index) {
+    CHECK(data != nullptr);
+    CHECK(index < size);
+    return data[index];
+}
+
+struct Node {
+    Node* next;
+    int   value;
+};
+
+int kassert_codegen_chase(Node const* node) {
+    int sum = 0;
+    while (node != nullptr) {
+        CHECK(node->value >= 0);
+        CHECK(node->next != node);
+        sum += node->value;
+        node = node->next;
+    }
+    return sum;
+}
+}
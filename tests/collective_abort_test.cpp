@@ -0,0 +1,32 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Checks that kassert::CollectiveChecker::sync() reports failed checks on rank 0 and stops the job on all ranks. The
+// test passes if the output contains the report of the failed check (see tests/CMakeLists.txt).
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstdio>
+
+#include <mpi.h>
+
+#include "kassert/collective.hpp"
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    kassert::CollectiveChecker checker;
+    KASSERT_COLLECTIVE(checker, rank >= 0);
+    KASSERT_COLLECTIVE(checker, rank != 1);
+    checker.sync();
+
+    // not reached
+    std::printf("sync() did not stop the job\n");
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,183 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include "kassert/collective.hpp"
+
+using namespace ::testing;
+
+namespace {
+int comm_rank() {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+int comm_size() {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+// Sums every other int, i.e., the elements of the strided datatype used below.
+void sum_strided(void* in, void* inout, int* len, MPI_Datatype*) {
+    for (int i = 0; i < 3 * *len; i += 2) {
+        static_cast<int*>(inout)[i] += static_cast<int*>(in)[i];
+    }
+}
+} // namespace
+
+TEST(CollectiveTest, passing_checks_agree) {
+    kassert::CollectiveChecker checker;
+    int const                  rank = comm_rank();
+    KASSERT_COLLECTIVE(checker, rank >= 0);
+    KASSERT_COLLECTIVE(checker, rank < comm_size(), "rank out of range");
+    EXPECT_EQ(checker.pending_checks(), 2u);
+    EXPECT_FALSE(checker.has_local_failures());
+
+    EXPECT_TRUE(checker.agree());
+    EXPECT_EQ(checker.pending_checks(), 0u);
+    EXPECT_FALSE(checker.failed(0));
+    EXPECT_FALSE(checker.failed(1));
+    EXPECT_THAT(checker.reports(), IsEmpty());
+}
+
+TEST(CollectiveTest, failure_on_one_rank_is_agreed_on_by_all_ranks) {
+    kassert::CollectiveChecker checker;
+    int const                  rank = comm_rank();
+    KASSERT_COLLECTIVE(checker, rank >= 0);
+    KASSERT_COLLECTIVE(checker, rank != 1, "rank " << rank << " is not allowed");
+    KASSERT_COLLECTIVE(checker, rank < comm_size());
+    EXPECT_EQ(checker.has_local_failures(), rank == 1);
+
+    EXPECT_FALSE(checker.agree());
+    EXPECT_FALSE(checker.failed(0));
+    EXPECT_TRUE(checker.failed(1));
+    EXPECT_FALSE(checker.failed(2));
+    EXPECT_FALSE(checker.has_local_failures());
+
+    // only rank 0 receives the error messages
+    if (rank == 0) {
+        ASSERT_EQ(checker.reports().size(), 1u);
+        EXPECT_EQ(checker.reports()[0].rank, 1);
+        EXPECT_THAT(
+            checker.reports()[0].message,
+            AllOf(
+                HasSubstr("FAILED COLLECTIVE ASSERTION"),
+                HasSubstr("rank != 1"),
+                HasSubstr("1 != 1"),
+                HasSubstr("rank 1 is not allowed")
+            )
+        );
+    } else {
+        EXPECT_THAT(checker.reports(), IsEmpty());
+    }
+
+    // the next synchronization period starts without failures
+    KASSERT_COLLECTIVE(checker, rank >= 0);
+    EXPECT_TRUE(checker.agree());
+    EXPECT_FALSE(checker.failed(1));
+}
+
+TEST(CollectiveTest, failures_on_multiple_ranks_are_reported_by_rank) {
+    kassert::CollectiveChecker checker;
+    int const                  rank = comm_rank();
+    KASSERT_COLLECTIVE(checker, rank == 0, "failed on rank " << rank);
+
+    EXPECT_FALSE(checker.agree());
+    EXPECT_TRUE(checker.failed(0));
+    if (rank == 0) {
+        ASSERT_EQ(checker.reports().size(), static_cast<std::size_t>(comm_size() - 1));
+        for (std::size_t i = 0; i < checker.reports().size(); ++i) {
+            int const failing_rank = static_cast<int>(i) + 1;
+            EXPECT_EQ(checker.reports()[i].rank, failing_rank);
+            EXPECT_THAT(checker.reports()[i].message, HasSubstr("failed on rank " + std::to_string(failing_rank)));
+        }
+    }
+}
+
+TEST(CollectiveTest, checks_beyond_capacity_share_the_last_bit) {
+    kassert::CollectiveChecker checker(MPI_COMM_WORLD, 2);
+    int const                  rank = comm_rank();
+    for (int i = 0; i < 10; ++i) {
+        KASSERT_COLLECTIVE(checker, i != 7 || rank != 2);
+    }
+    EXPECT_EQ(checker.pending_checks(), 10u);
+
+    EXPECT_FALSE(checker.agree());
+    EXPECT_FALSE(checker.failed(0));
+    EXPECT_TRUE(checker.failed(1));
+    EXPECT_TRUE(checker.failed(7));
+}
+
+TEST(CollectiveTest, disabled_checks_are_not_counted) {
+    kassert::CollectiveChecker checker;
+    KASSERT_COLLECTIVE(checker, false, "disabled", kassert::assert::normal + 1);
+    EXPECT_EQ(checker.pending_checks(), 0u);
+    EXPECT_TRUE(checker.agree());
+}
+
+TEST(CollectiveTest, agreement_is_piggybacked_on_reduction) {
+    kassert::CollectiveChecker checker;
+    int const                  rank = comm_rank();
+    int const                  size = comm_size();
+    KASSERT_COLLECTIVE(checker, rank != size - 1);
+
+    long const local[2] = {rank, 2 * rank};
+    long       global[2] = {0, 0};
+    EXPECT_FALSE(checker.agree(local, global, 2, MPI_LONG, MPI_SUM));
+    EXPECT_EQ(global[0], size * (size - 1) / 2);
+    EXPECT_EQ(global[1], size * (size - 1));
+    EXPECT_TRUE(checker.failed(0));
+    if (rank == 0) {
+        ASSERT_EQ(checker.reports().size(), 1u);
+        EXPECT_EQ(checker.reports()[0].rank, size - 1);
+    }
+
+    // MPI_IN_PLACE
+    double value = static_cast<double>(rank + 1);
+    EXPECT_TRUE(checker.agree(MPI_IN_PLACE, &value, 1, MPI_DOUBLE, MPI_MAX));
+    EXPECT_EQ(value, static_cast<double>(size));
+}
+
+TEST(CollectiveTest, agreement_falls_back_to_separate_reductions_for_non_contiguous_types) {
+    kassert::CollectiveChecker checker;
+    int const                  rank = comm_rank();
+    KASSERT_COLLECTIVE(checker, rank != 0);
+
+    // every other int of the buffer
+    MPI_Datatype strided = MPI_DATATYPE_NULL;
+    MPI_Type_vector(2, 1, 2, MPI_INT, &strided);
+    MPI_Type_commit(&strided);
+    MPI_Op sum = MPI_OP_NULL;
+    MPI_Op_create(&sum_strided, 1, &sum);
+    int local[3]  = {1, -1, 2};
+    int global[3] = {0, 42, 0};
+    EXPECT_FALSE(checker.agree(local, global, 1, strided, sum));
+    MPI_Op_free(&sum);
+    MPI_Type_free(&strided);
+
+    EXPECT_EQ(global[0], comm_size());
+    EXPECT_EQ(global[1], 42);
+    EXPECT_EQ(global[2], 2 * comm_size());
+    EXPECT_TRUE(checker.failed(0));
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int const local_result = RUN_ALL_TESTS();
+
+    // the test fails if it fails on any rank
+    int result = 0;
+    MPI_Allreduce(&local_result, &result, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return result;
+}
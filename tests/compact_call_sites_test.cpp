@@ -0,0 +1,77 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <gmock/gmock.h>
+
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Function template with a failing assertion.
+/// @tparam T Some type.
+/// @param value Some value.
+template <typename T>
+void fail_in_template(T value) {
+    KASSERT(value < T{0});
+}
+
+/// @brief Class with a member function template with a failing assertion.
+struct FailingMember {
+    /// @brief Member function template with a failing assertion.
+    /// @tparam T Some type.
+    /// @param value Some value.
+    template <typename T>
+    void fail(T value) const {
+        KASSERT(value < T{0});
+    }
+};
+} // namespace
+
+// Test that template arguments are stripped from function names
+
+TEST(CompactCallSitesTest, function_name_length_ignores_template_arguments) {
+    using kassert::internal::function_name_length;
+
+    static_assert(function_name_length("void foo()") == 10);
+    static_assert(function_name_length("void foo(T) [with T = int]") == 11);
+    static_assert(function_name_length("void foo(T) [T = int]") == 11);
+    static_assert(function_name_length("int& Foo::operator[](std::size_t)") == 33);
+    static_assert(function_name_length("") == 0);
+
+    static constexpr auto stripped = kassert::internal::strip_function_name<11>("void foo(T) [with T = int]");
+    EXPECT_STREQ(stripped.data, "void foo(T)");
+}
+
+TEST(CompactCallSitesTest, failed_assertions_print_stripped_function_names) {
+#if defined(__GNUC__) || defined(__clang__)
+    EXPECT_EXIT(
+        { fail_in_template(42); },
+        KilledBySignal(SIGABRT),
+        "In function 'void [^']*fail_in_template\\(T\\)':\n[^\n]*: FAILED ASSERTION\n\tvalue < T\\{0\\}"
+    );
+    EXPECT_EXIT(
+        { FailingMember{}.fail(1.5); },
+        KilledBySignal(SIGABRT),
+        "In function 'void [^']*FailingMember::fail\\(T\\) const':"
+    );
+#endif
+}
+
+// Test that the call site metadata is a constant record
+
+TEST(CompactCallSitesTest, call_site_metadata_is_constant) {
+    KASSERT_KASSERT_HPP_DEFINE_ASSERTION_SITE(site, "ASSERTION", "1 + 1 == 2")
+    static_assert(std::is_trivially_copyable_v<kassert::internal::AssertionSite>);
+
+    constexpr kassert::internal::AssertionSite const* address = &site;
+    EXPECT_STREQ(address->type, "ASSERTION");
+    EXPECT_STREQ(address->expression, "1 + 1 == 2");
+    EXPECT_EQ(address->location.row, __LINE__ - 6);
+    EXPECT_THAT(address->location.function, HasSubstr("TestBody"));
+}
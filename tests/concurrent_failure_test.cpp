@@ -0,0 +1,108 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/kassert.hpp"
+#include "kassert/testing.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Sink that fails an assertion itself.
+class FailingSink final : public kassert::ReportSink {
+public:
+    void write(char const*, std::size_t const size, kassert::ReportSeverity) override {
+        KASSERT(size == 0u, "failure in the sink");
+    }
+};
+
+/// @brief Failure handler that fails an assertion itself.
+void fail_in_handler(char const*, std::size_t const size) {
+    KASSERT(size == 0u, "failure in the handler");
+}
+
+/// @brief Number of threads that fail concurrently.
+constexpr int concurrent_failures = 4;
+
+/// @brief Number of threads that have reached the failure handler.
+std::atomic<int> failed_threads{0};
+
+/// @brief Failure handler that holds each failing thread until all threads have failed, such that all of them take
+/// part in the protocol of concurrently failing threads, however they are scheduled.
+void wait_for_all_failures(char const*, std::size_t) {
+    failed_threads.fetch_add(1);
+    while (failed_threads.load() < concurrent_failures) {
+    }
+}
+
+/// @brief Builds a regular expression matching the complete reports of the failed assertions of the given number of
+/// threads, one after the other in any order, such that the report of each thread appears exactly once.
+std::string concurrent_failure_reports(int const threads) {
+    std::vector<int> order(static_cast<std::size_t>(threads));
+    std::iota(order.begin(), order.end(), 0);
+    std::string regex;
+    do {
+        regex += regex.empty() ? "^(" : "|";
+        for (int const thread: order) {
+            regex += "[^\n]*: In function '[^\n]*':\n[^\n]*: FAILED ASSERTION\n\tthread < 0\nwith expansion:\n\t"
+                     + std::to_string(thread) + " < 0\nthread " + std::to_string(thread) + " failed\n";
+        }
+    } while (std::next_permutation(order.begin(), order.end()));
+    return regex + ")$";
+}
+} // namespace
+
+TEST(ConcurrentFailureTest, reports_of_concurrent_failures_do_not_interleave) {
+    auto fail_concurrently = [] {
+        kassert::set_failure_handler(&wait_for_all_failures);
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < concurrent_failures; ++thread) {
+            workers.emplace_back([thread] { KASSERT(thread < 0, "thread " << thread << " failed"); });
+        }
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    };
+    EXPECT_EXIT(fail_concurrently(), KilledBySignal(SIGABRT), concurrent_failure_reports(concurrent_failures));
+}
+
+TEST(ConcurrentFailureTest, failure_while_reporting_a_failure_aborts) {
+    auto fail_in_sink = [] {
+        FailingSink sink;
+        kassert::set_report_sink(&sink);
+        KASSERT(false, "first failure");
+    };
+    EXPECT_EXIT(fail_in_sink(), KilledBySignal(SIGABRT), "");
+}
+
+TEST(ConcurrentFailureTest, failure_in_the_failure_handler_aborts) {
+    auto fail_in_failure_handler = [] {
+        kassert::set_failure_handler(&fail_in_handler);
+        KASSERT(false, "first failure");
+    };
+    // the handler is not called again for the second failure, which aborts without a report (a recursion would
+    // overflow the stack instead)
+    EXPECT_EXIT(fail_in_failure_handler(), KilledBySignal(SIGABRT), "^$");
+}
+
+TEST(ConcurrentFailureTest, failure_handlers_that_throw_leave_the_failure_path) {
+    {
+        kassert::testing::ThrowOnFailure const throw_on_failure;
+        EXPECT_THROW(KASSERT(false), kassert::testing::AssertionFailure);
+    }
+    EXPECT_EQ(kassert::internal::failing_threads.load(), 0u);
+    EXPECT_FALSE(kassert::internal::first_failure_claimed.load());
+}
@@ -0,0 +1,43 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include "kassert/exception.hpp"
+#include "kassert/kassert.hpp"
+
+// Each section contains an assertion that fails during constant evaluation and must therefore not compile.
+
+constexpr int odd(int const value) {
+    KASSERT(value % 2 == 1, "value is " << value);
+    return value;
+}
+
+constexpr int not_five(int const value) {
+    THROWING_KASSERT(value != 5);
+    return value;
+}
+
+constexpr int odd_in_category(int const value) {
+    KASSERT_IN_CATEGORY(odd_values, value % 2 == 1);
+    return value;
+}
+
+static_assert(odd(3) == 3);
+static_assert(not_five(3) == 3);
+static_assert(odd_in_category(3) == 3);
+
+#if defined(KASSERT_FAILS)
+static_assert(odd(2) == 2);
+#elif defined(THROWING_KASSERT_FAILS)
+static_assert(not_five(5) == 5);
+#elif defined(KASSERT_IN_CATEGORY_FAILS)
+static_assert(odd_in_category(2) == 2);
+#endif
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,75 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <array>
+#include <cstddef>
+
+#include <gmock/gmock.h>
+
+#include "kassert/exception.hpp"
+#include "kassert/gmock.hpp"
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+using kassert::testing::FailsAssertion;
+
+namespace {
+/// @brief Builds a table of squares and validates it with assertions of all kinds.
+template <std::size_t size>
+constexpr std::array<int, size> square_table(int const offset) {
+    std::array<int, size> table{};
+    for (std::size_t i = 0; i < size; ++i) {
+        int const value = static_cast<int>(i) + offset;
+        table[i]        = value * value;
+        KASSERT(table[i] >= 0, "square of " << value << " is negative");
+        KASSERT_ASSUME(table[i] >= value, "", kassert::assert::normal);
+        KASSERT_IN_CATEGORY(tables, i == 0u || table[i] > table[i - 1]);
+        THROWING_KASSERT(value != 42, "tables must not contain 42");
+    }
+    return table;
+}
+
+/// @brief Returns its argument if it is odd.
+constexpr int odd(int const value) {
+    KASSERT(value % 2 == 1, "value is " << value);
+    return value;
+}
+} // namespace
+
+static_assert(square_table<4>(1)[3] == 16);
+static_assert(odd(3) == 3);
+
+#if defined(__cpp_consteval)
+namespace {
+/// @brief Returns its argument if it is odd, only during constant evaluation.
+consteval int odd_at_compile_time(int const value) {
+    KASSERT(value % 2 == 1);
+    return value;
+}
+} // namespace
+
+static_assert(odd_at_compile_time(5) == 5);
+#endif
+
+TEST(ConstexprTest, assertions_in_constexpr_functions_are_checked_at_runtime) {
+    int const value = 2;
+    EXPECT_THAT(
+        [&] { odd(value); },
+        FailsAssertion(HasSubstr("value % 2 == 1\nwith expansion:\n\t0 == 1\nvalue is 2"))
+    );
+    EXPECT_THAT([&] { square_table<4>(-1); }, FailsAssertion(HasSubstr("i == 0u || table[i] > table[i - 1]")));
+    EXPECT_THAT([&] { square_table<4>(value); }, Not(FailsAssertion()));
+}
+
+TEST(ConstexprTest, throwing_assertions_in_constexpr_functions_are_checked_at_runtime) {
+#ifdef KASSERT_EXCEPTION_MODE
+    EXPECT_THROW(square_table<4>(40), kassert::KassertException);
+#else
+    EXPECT_THAT([] { square_table<4>(40); }, FailsAssertion(HasSubstr("tables must not contain 42")));
+#endif
+}
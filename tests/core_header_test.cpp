@@ -0,0 +1,153 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+// The core header must be included first such that we can check that it does not include heavy standard headers
+#include "kassert/core.hpp"
+
+#if defined(_GLIBCXX_IOSTREAM) || defined(_GLIBCXX_OSTREAM) || defined(_GLIBCXX_SSTREAM) || defined(_GLIBCXX_VECTOR) \
+    || defined(_GLIBCXX_STRING)
+    #error "kassert/core.hpp must not include <iostream>, <ostream>, <sstream>, <vector> or <string>"
+#endif
+#if defined(_LIBCPP_IOSTREAM) || defined(_LIBCPP_OSTREAM) || defined(_LIBCPP_SSTREAM) || defined(_LIBCPP_VECTOR) \
+    || defined(_LIBCPP_STRING)
+    #error "kassert/core.hpp must not include <iostream>, <ostream>, <sstream>, <vector> or <string>"
+#endif
+
+// THROWING_KASSERT() additionally requires the exception header, which does not depend on iostreams either
+#include "kassert/exception.hpp"
+
+#if defined(_GLIBCXX_IOSTREAM) || defined(_GLIBCXX_OSTREAM) || defined(_GLIBCXX_SSTREAM)
+    #error "kassert/exception.hpp must not include <iostream>, <ostream> or <sstream>"
+#endif
+#if defined(_LIBCPP_IOSTREAM) || defined(_LIBCPP_OSTREAM) || defined(_LIBCPP_SSTREAM)
+    #error "kassert/exception.hpp must not include <iostream>, <ostream> or <sstream>"
+#endif
+
+#include <string>
+#include <string_view>
+
+#include <gmock/gmock.h>
+
+using namespace ::testing;
+
+namespace {
+/// @brief Type that cannot be stringified.
+struct Opaque {
+    int value; ///< @brief Some value.
+
+    /// @brief Compares the values.
+    /// @param other The other object.
+    /// @return Whether the values are equal.
+    bool operator==(Opaque const& other) const {
+        return value == other.value;
+    }
+};
+
+/// @brief Type that can be stringified by an overload of the << operator of the logger.
+struct Point {
+    int x; ///< @brief The x coordinate.
+    int y; ///< @brief The y coordinate.
+
+    /// @brief Compares the coordinates.
+    /// @param other The other point.
+    /// @return Whether the coordinates are equal.
+    bool operator==(Point const& other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+/// @brief Stringifies a point.
+/// @tparam StreamT The underlying output target of the logger.
+/// @param logger The logger.
+/// @param point The point.
+/// @return The logger.
+template <typename StreamT>
+kassert::Logger<StreamT>& operator<<(kassert::Logger<StreamT>& logger, Point const& point) {
+    return logger << "<" << point.x << ", " << point.y << ">";
+}
+
+/// @brief Exception with a custom message.
+class CustomException : public std::exception {
+public:
+    /// @brief Constructs the exception.
+    /// @param message The message.
+    explicit CustomException(std::string message) : _what(std::move(message)) {}
+
+    /// @brief Returns the message.
+    /// @return The message.
+    [[nodiscard]] char const* what() const noexcept final {
+        return _what.c_str();
+    }
+
+private:
+    std::string _what; ///< @brief The message.
+};
+} // namespace
+
+// Test that assertions print operands and messages natively
+
+TEST(KassertCoreTest, kassert_prints_builtin_types) {
+    int const    answer = 42;
+    double const half  = 0.5;
+    std::string  name  = "kassert";
+
+    EXPECT_EXIT({ KASSERT(answer == 43); }, KilledBySignal(SIGABRT), "42 == 43");
+    EXPECT_EXIT({ KASSERT(half > 1.0); }, KilledBySignal(SIGABRT), "0.5 > 1");
+    EXPECT_EXIT({ KASSERT(name == "core"); }, KilledBySignal(SIGABRT), "kassert == core");
+    EXPECT_EXIT({ KASSERT(std::string_view(name).empty()); }, KilledBySignal(SIGABRT), "kassert");
+    EXPECT_EXIT(
+        { KASSERT(answer < 0, "answer=" << answer << " half=" << half << " flag=" << true); },
+        KilledBySignal(SIGABRT),
+        "answer=42 half=0.5 flag=true"
+    );
+}
+
+// Test that types that cannot be stringified are printed as <?>, unless the logger is overloaded for them
+
+TEST(KassertCoreTest, kassert_prints_custom_types) {
+    Opaque const opaque{1};
+    Point const  origin{0, 0};
+    Point const  point{1, 2};
+
+    EXPECT_EXIT({ KASSERT(opaque == Opaque{2}); }, KilledBySignal(SIGABRT), "<\\?> == <\\?>");
+    EXPECT_EXIT({ KASSERT(origin == point); }, KilledBySignal(SIGABRT), "<0, 0> == <1, 2>");
+}
+
+// Test that exception messages are built without iostreams
+
+TEST(KassertCoreTest, string_logger_formats_values) {
+    kassert::internal::StringLogger logger;
+    logger << "int=" << -42 << " bool=" << false << " point=" << Point{3, 4};
+    EXPECT_EQ(logger.str(), "int=-42 bool=false point=<3, 4>");
+}
+
+TEST(KassertCoreTest, throwing_kassert_formats_message) {
+    Point const point{1, 1};
+
+#ifdef KASSERT_EXCEPTION_MODE
+    EXPECT_THAT(
+        [&] { THROWING_KASSERT(1 + 1 == 3, point << " answer=" << 42); },
+        ThrowsMessage<kassert::KassertException>(HasSubstr("<1, 1> answer=42"))
+    );
+    EXPECT_THAT(
+        [] { THROWING_KASSERT_SPECIFIED(false, "custom " << 1.5, CustomException); },
+        ThrowsMessage<CustomException>(HasSubstr("custom 1.5"))
+    );
+#else  // KASSERT_EXCEPTION_MODE
+    EXPECT_EXIT(
+        { THROWING_KASSERT(1 + 1 == 3, point << " answer=" << 42); },
+        KilledBySignal(SIGABRT),
+        "<1, 1> answer=42"
+    );
+    EXPECT_EXIT(
+        { THROWING_KASSERT_SPECIFIED(false, "custom " << 1.5, CustomException); },
+        KilledBySignal(SIGABRT),
+        "custom 1.5"
+    );
+#endif // KASSERT_EXCEPTION_MODE
+}
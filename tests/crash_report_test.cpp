@@ -0,0 +1,178 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "kassert/crash_report.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Writes a crash report to a temporary file and returns its contents.
+std::string crash_report(std::string const& report, kassert::CrashReportOptions const& options) {
+    std::FILE* const file = std::tmpfile();
+    EXPECT_NE(file, nullptr);
+    kassert::internal::write_crash_report(
+        kassert::internal::FileDescriptor{fileno(file)},
+        report.data(),
+        report.size(),
+        options
+    );
+    std::rewind(file);
+    std::string contents;
+    char        buffer[4096];
+    for (std::size_t bytes; (bytes = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        contents.append(buffer, bytes);
+    }
+    std::fclose(file);
+    return contents;
+}
+
+/// @brief Number of threads that fail concurrently.
+constexpr int concurrent_failures = 4;
+
+/// @brief Number of threads that have reached the failure handler.
+std::atomic<int> failed_threads{0};
+
+/// @brief Failure handler that holds each failing thread until all threads have failed and then writes the crash
+/// report, such that all threads take part in the protocol of concurrently failing threads, however they are scheduled.
+void wait_for_all_failures_and_report_crash(char const* report, std::size_t const size) {
+    failed_threads.fetch_add(1);
+    while (failed_threads.load() < concurrent_failures) {
+    }
+    kassert::internal::report_crash(report, size);
+}
+
+/// @brief Sets the reported rank for the lifetime of this object.
+class ScopedRank {
+public:
+    explicit ScopedRank(int const rank) {
+        kassert::set_crash_report_rank(rank);
+    }
+
+    ~ScopedRank() {
+        kassert::set_crash_report_rank(-1);
+    }
+};
+} // namespace
+
+TEST(CrashReportTest, report_starts_with_assertion_report) {
+    std::string const contents = crash_report("__report__\n", {});
+    EXPECT_THAT(contents, StartsWith("__report__\n"));
+#if defined(__linux__)
+    EXPECT_THAT(contents, ContainsRegex("\nthread: [0-9]+\n"));
+#endif
+    EXPECT_THAT(contents, Not(HasSubstr("rank:")));
+}
+
+TEST(CrashReportTest, report_contains_rank_if_known) {
+    ScopedRank const rank(3);
+    EXPECT_THAT(crash_report("", {}), HasSubstr("rank: 3\n"));
+}
+
+#if KASSERT_KASSERT_HPP_HAS_BACKTRACE && defined(__linux__)
+TEST(CrashReportTest, report_contains_backtrace_and_executable_mappings) {
+    std::string const contents = crash_report("", {});
+    EXPECT_THAT(contents, ContainsRegex("backtrace:\n\t#0 0x[0-9a-f]+\n\t#1 0x[0-9a-f]+\n"));
+    EXPECT_THAT(contents, ContainsRegex("memory map:\n\t[0-9a-f]+-[0-9a-f]+ r-xp "));
+    EXPECT_THAT(contents, Not(ContainsRegex("\t[0-9a-f]+-[0-9a-f]+ r[w-]-p ")));
+}
+#endif
+
+TEST(CrashReportTest, parts_of_report_can_be_disabled) {
+    kassert::CrashReportOptions options;
+    options.backtrace  = false;
+    options.memory_map = false;
+    std::string const contents = crash_report("__report__\n", options);
+    EXPECT_THAT(contents, Not(HasSubstr("backtrace:")));
+    EXPECT_THAT(contents, Not(HasSubstr("memory map:")));
+}
+
+TEST(CrashReportTest, executable_mappings_are_detected) {
+    std::string const executable = "00400000-00452000 r-xp 00000000 08:02 173521 /usr/bin/dbus-daemon";
+    std::string const data       = "00651000-00652000 rw-p 00051000 08:02 173521 /usr/bin/dbus-daemon";
+    EXPECT_TRUE(kassert::internal::is_executable_mapping(executable.data(), executable.size()));
+    EXPECT_FALSE(kassert::internal::is_executable_mapping(data.data(), data.size()));
+    EXPECT_FALSE(kassert::internal::is_executable_mapping("00400000-00452000 r", 19));
+}
+
+TEST(CrashReportTest, rank_is_read_from_environment) {
+    EXPECT_EXIT(
+        {
+            setenv("PMI_RANK", "7", 1);
+            kassert::install_crash_reporter();
+            KASSERT(false, "__crash__");
+        },
+        KilledBySignal(SIGABRT),
+        "\n__crash__\n(thread: [0-9]+\n)?rank: 7\n"
+    );
+}
+
+TEST(CrashReportTest, failed_assertions_write_crash_report) {
+    EXPECT_EXIT(
+        {
+            kassert::install_crash_reporter();
+            int const lhs = 2;
+            KASSERT(lhs == 3, "__crash__");
+        },
+        KilledBySignal(SIGABRT),
+        "with expansion:\n\t2 == 3\n__crash__\n.*backtrace:\n\t#0 0x"
+    );
+}
+
+// complete crash reports, one after the other
+#define KASSERT_CONCURRENT_CRASH_REPORT                                                                            \
+    "[^\n]*: In function '[^\n]*':\n[^\n]*: FAILED ASSERTION\n\tthread < 0\nwith expansion:\n\t[0-9] < 0\nthread " \
+    "[0-9] crashed\n(thread: [0-9]+\n)?(backtrace:\n(\t[^\n]*\n)*)?(memory map:\n(\t[^\n]*\n)*)?"
+
+TEST(CrashReportTest, crash_reports_of_concurrent_failures_do_not_interleave) {
+    auto crash_concurrently = [] {
+        kassert::install_crash_reporter();
+        kassert::set_failure_handler(&wait_for_all_failures_and_report_crash);
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < concurrent_failures; ++thread) {
+            workers.emplace_back([thread] { KASSERT(thread < 0, "thread " << thread << " crashed"); });
+        }
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    };
+    EXPECT_EXIT(crash_concurrently(), KilledBySignal(SIGABRT), "^(" KASSERT_CONCURRENT_CRASH_REPORT "){4}$");
+}
+
+TEST(CrashReportTest, core_dumps_can_be_disabled) {
+    EXPECT_EXIT(
+        {
+            kassert::internal::disable_core_dumps();
+            struct rlimit limit {};
+            getrlimit(RLIMIT_CORE, &limit);
+            std::exit(limit.rlim_cur == 0 ? 0 : 1);
+        },
+        ExitedWithCode(0),
+        ""
+    );
+    EXPECT_EXIT(
+        {
+            kassert::CrashReportOptions options;
+            options.core_dump = false;
+            kassert::install_crash_reporter(options);
+            KASSERT(false);
+        },
+        KilledBySignal(SIGABRT),
+        "FAILED ASSERTION"
+    );
+}
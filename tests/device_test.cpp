@@ -0,0 +1,130 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#undef KASSERT_DEVICE_FAILURE_CAPACITY
+#define KASSERT_DEVICE_FAILURE_CAPACITY 4
+
+#include <memory>
+
+#include <gmock/gmock.h>
+
+#include "kassert/device.hpp"
+#include "kassert/gmock.hpp"
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+using kassert::internal::Decomposer;
+using kassert::internal::finalize_expr;
+using kassert::internal::record_device_failure;
+using kassert::testing::FailsAssertion;
+
+namespace {
+/// @brief Metadata of a fake device assertion call site.
+kassert::internal::DeviceAssertionSite const site{
+    {"kernel.cu", 42, "void kernel(int*)"}, "values[index] == index + 1", "values must be shifted"};
+
+/// @brief Index of a fake reporting lane.
+kassert::internal::DeviceThreadIndex const lane{{1, 2, 3}, {4, 5, 6}};
+
+enum class Color : short { red = -2 };
+} // namespace
+
+TEST(DeviceTest, operands_are_stored_by_value) {
+    using kassert::internal::DeviceOperandKind;
+    using kassert::internal::make_device_operand;
+
+    EXPECT_EQ(make_device_operand(true).kind, DeviceOperandKind::boolean);
+    EXPECT_EQ(make_device_operand('c').value.character, 'c');
+    EXPECT_EQ(make_device_operand(-5).value.signed_integer, -5);
+    EXPECT_EQ(make_device_operand(5u).kind, DeviceOperandKind::unsigned_integer);
+    EXPECT_EQ(make_device_operand(Color::red).value.signed_integer, -2);
+    EXPECT_EQ(make_device_operand(0.5f).value.floating_point, 0.5);
+    EXPECT_EQ(make_device_operand(nullptr).kind, DeviceOperandKind::pointer);
+    EXPECT_EQ(make_device_operand(std::make_unique<int>(1)).kind, DeviceOperandKind::unprintable);
+    int const value = 1;
+    EXPECT_EQ(make_device_operand(finalize_expr((Decomposer{} <= value) == 1)).value.boolean, true);
+}
+
+TEST(DeviceTest, drained_failures_are_formatted_like_host_failures) {
+    auto      buffer = std::make_unique<kassert::DeviceFailureBuffer>();
+    int const lhs    = 3;
+    int const rhs    = 2;
+    EXPECT_TRUE(record_device_failure(buffer.get(), site, finalize_expr((Decomposer{} <= lhs) == rhs + 1), 32, lane));
+    EXPECT_TRUE(record_device_failure(buffer.get(), site, finalize_expr(Decomposer{} <= !lhs), 1, lane));
+    EXPECT_TRUE(record_device_failure(buffer.get(), site, lhs == 4 && rhs == 2, 1, lane));
+
+    std::vector<std::string> const reports = kassert::drain_device_failures(*buffer);
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(
+        reports[0],
+        "kernel.cu: In function 'void kernel(int*)':\n"
+        "kernel.cu:42: FAILED DEVICE ASSERTION\n"
+        "\tvalues[index] == index + 1\n"
+        "with expansion:\n"
+        "\t3 == 3\n"
+        "values must be shifted\n"
+        "in block (1, 2, 3), thread (4, 5, 6) and 31 other lane(s) of its warp\n"
+    );
+    EXPECT_THAT(
+        reports[1],
+        HasSubstr("with expansion:\n\tfalse\nvalues must be shifted\nin block (1, 2, 3), thread (4, 5, 6)\n")
+    );
+    EXPECT_THAT(reports[2], HasSubstr("\tvalues[index] == index + 1\nvalues must be shifted\n"));
+    EXPECT_TRUE(kassert::drain_device_failures(*buffer).empty());
+}
+
+TEST(DeviceTest, failures_are_dropped_if_the_buffer_is_full) {
+    auto buffer = std::make_unique<kassert::DeviceFailureBuffer>();
+    for (int failure = 0; failure < 6; ++failure) {
+        EXPECT_EQ(
+            record_device_failure(buffer.get(), site, finalize_expr((Decomposer{} <= failure) < 0), 1, lane),
+            failure < 4
+        );
+    }
+    std::vector<std::string> const reports = kassert::drain_device_failures(*buffer);
+    ASSERT_EQ(reports.size(), 5u);
+    EXPECT_THAT(reports[3], HasSubstr("with expansion:\n\t3 < 0\n"));
+    EXPECT_EQ(reports[4], "2 failed device assertion(s) were not recorded because the buffer was full\n");
+
+    // the buffer is reused after it was drained
+    EXPECT_TRUE(record_device_failure(buffer.get(), site, finalize_expr((Decomposer{} <= 7) < 0), 1, lane));
+    EXPECT_THAT(kassert::drain_device_failures(*buffer), ElementsAre(HasSubstr("\t7 < 0\n")));
+}
+
+TEST(DeviceTest, incomplete_failures_are_counted) {
+    auto buffer = std::make_unique<kassert::DeviceFailureBuffer>();
+    EXPECT_TRUE(record_device_failure(buffer.get(), site, false, 1, lane));
+    // a lane reserved a record, but the kernel stopped before it was published
+    ++buffer->head;
+    EXPECT_THAT(
+        kassert::drain_device_failures(*buffer),
+        ElementsAre(HasSubstr("FAILED DEVICE ASSERTION"), HasSubstr("1 failed device assertion(s) were not recorded"))
+    );
+}
+
+TEST(DeviceTest, failures_without_buffer_are_not_recorded) {
+    EXPECT_FALSE(record_device_failure(nullptr, site, false, 1, lane));
+}
+
+TEST(DeviceTest, device_assertions_behave_like_kassert_in_host_code) {
+    int const lhs = 2;
+    EXPECT_THAT(
+        [&] { KASSERT_DEVICE(lhs == 3, "message"); },
+        FailsAssertion(HasSubstr("FAILED ASSERTION\n\tlhs == 3\nwith expansion:\n\t2 == 3\nmessage"))
+    );
+    EXPECT_THAT([&] { KASSERT_DEVICE(lhs == 3); }, FailsAssertion());
+    EXPECT_THAT([&] { KASSERT_DEVICE(lhs == 2, "", kassert::assert::normal); }, Not(FailsAssertion()));
+
+    int  evaluations = 0;
+    auto evaluate    = [&] {
+        ++evaluations;
+        return false;
+    };
+    KASSERT_DEVICE(evaluate(), "", kassert::assert::normal + 1);
+    EXPECT_EQ(evaluations, 0);
+}
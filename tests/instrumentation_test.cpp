@@ -0,0 +1,154 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+// Time every evaluation
+#define KASSERT_INSTRUMENTATION_CYCLE_SAMPLING_RATE 1
+
+#include <algorithm>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Looks up the statistics of the call site with the given expression.
+kassert::AssertionSiteStatistics statistics_of(std::string_view const expression) {
+    auto const statistics = kassert::instrumentation_statistics();
+    auto const site = std::find_if(statistics.begin(), statistics.end(), [&](auto const& candidate) {
+        return candidate.expression == expression;
+    });
+    EXPECT_NE(site, statistics.end()) << "no call site for expression " << expression;
+    return site != statistics.end() ? *site : kassert::AssertionSiteStatistics{};
+}
+
+/// @brief Contains an instrumented assertion, which is only evaluated by \c times_assertions_reaching_new_call_sites.
+bool nonnegative(int const value) {
+    KASSERT(value >= 0);
+    return true;
+}
+} // namespace
+
+TEST(InstrumentationTest, counts_evaluations_per_call_site) {
+    kassert::reset_instrumentation();
+    constexpr unsigned line = __LINE__ + 2;
+    for (int i = 0; i < 5; ++i) {
+        KASSERT(i >= 0);
+    }
+    KASSERT(1 + 1 == 2, "", kassert::assert::kthrow);
+
+    auto const site = statistics_of("i >= 0");
+    EXPECT_EQ(site.evaluations, 5u);
+    EXPECT_EQ(site.level, kassert::assert::normal);
+    EXPECT_EQ(site.where.row, line);
+    EXPECT_THAT(site.where.file, EndsWith("instrumentation_test.cpp"));
+
+    auto const other_site = statistics_of("1 + 1 == 2");
+    EXPECT_EQ(other_site.evaluations, 1u);
+    EXPECT_EQ(other_site.level, kassert::assert::kthrow);
+}
+
+TEST(InstrumentationTest, times_sampled_evaluations) {
+    kassert::reset_instrumentation();
+    for (int i = 0; i < 3; ++i) {
+        KASSERT(i != -1);
+    }
+    auto const site = statistics_of("i != -1");
+    EXPECT_EQ(site.evaluations, 3u);
+    EXPECT_EQ(site.timed_evaluations, 3u);
+    EXPECT_GT(site.estimated_cycles(), 0.0);
+}
+
+TEST(InstrumentationTest, times_assertions_reaching_new_call_sites) {
+    kassert::reset_instrumentation();
+    // the counters of a new thread only hold the outer call site, thus the first evaluation of the nested call site
+    // moves them while the outer evaluation is timed
+    std::thread([] { KASSERT(nonnegative(1)); }).join();
+
+    auto const site = statistics_of("nonnegative(1)");
+    EXPECT_EQ(site.evaluations, 1u);
+    EXPECT_EQ(site.timed_evaluations, 1u);
+    EXPECT_EQ(statistics_of("value >= 0").evaluations, 1u);
+}
+
+TEST(InstrumentationTest, aggregates_counters_of_all_threads) {
+    kassert::reset_instrumentation();
+    auto check = [](int const n) {
+        for (int i = 0; i < n; ++i) {
+            KASSERT(i < n);
+        }
+    };
+    std::thread first(check, 10);
+    std::thread second(check, 20);
+    first.join();
+    second.join();
+    check(30);
+
+    EXPECT_EQ(statistics_of("i < n").evaluations, 60u);
+}
+
+TEST(InstrumentationTest, counts_only_sampled_evaluations) {
+    kassert::reset_instrumentation();
+    for (int i = 0; i < 100; ++i) {
+        KASSERT_SAMPLED(i <= 100, "", kassert::assert::normal, 10);
+    }
+    EXPECT_EQ(statistics_of("i <= 100").evaluations, 10u);
+}
+
+TEST(InstrumentationTest, counts_evaluations_skipped_by_cost_budget) {
+    kassert::reset_instrumentation();
+    std::uint64_t const previous = kassert::set_cost_budget(kassert::assert::normal, 1000);
+    for (std::size_t size = 996; size < 1006; ++size) {
+        KASSERT_WITH_COST(size > 0u, "", kassert::assert::normal, kassert::Complexity::linear, size);
+    }
+    kassert::set_cost_budget(kassert::assert::normal, previous);
+
+    auto const site = statistics_of("size > 0u");
+    EXPECT_EQ(site.evaluations, 5u);
+    EXPECT_EQ(site.skipped_evaluations, 5u);
+}
+
+TEST(InstrumentationTest, prints_reports) {
+    kassert::reset_instrumentation();
+    for (int i = 0; i < 7; ++i) {
+        KASSERT(i != 42, "", kassert::assert::normal);
+    }
+
+    std::ostringstream table;
+    kassert::print_instrumentation_report(table);
+    EXPECT_THAT(table.str(), StartsWith("evaluations"));
+    EXPECT_THAT(table.str(), ContainsRegex("7 +0 +[0-9]+ +30 +.*instrumentation_test.cpp:[0-9]+: i != 42"));
+
+    std::ostringstream csv;
+    kassert::print_instrumentation_report(csv, kassert::InstrumentationReportFormat::csv);
+    EXPECT_THAT(
+        csv.str(),
+        StartsWith("file,line,function,expression,level,evaluations,timed_evaluations,timed_cycles,estimated_cycles,"
+                   "skipped_evaluations\n")
+    );
+    EXPECT_THAT(csv.str(), HasSubstr(",i != 42,30,7,7,"));
+}
+
+TEST(InstrumentationTest, prints_report_at_exit) {
+    // the report is printed after main() returns, i.e., it contains the counters of the main thread
+    EXPECT_EXIT(
+        {
+            setenv("KASSERT_INSTRUMENTATION_REPORT", "csv", 1);
+            for (int i = 0; i < 3; ++i) {
+                KASSERT(i != 1000);
+            }
+            std::exit(0);
+        },
+        ExitedWithCode(0),
+        ",i != 1000,30,3,"
+    );
+}
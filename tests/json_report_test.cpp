@@ -0,0 +1,201 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/gmock.hpp"
+#include "kassert/kassert.hpp"
+#include "kassert/range.hpp"
+
+using namespace ::testing;
+using kassert::testing::FailsAssertion;
+
+namespace {
+/// @brief Reports failed assertions in the given format for the lifetime of this object.
+class ScopedReportFormat {
+public:
+    explicit ScopedReportFormat(kassert::ReportFormat const format) : _previous(kassert::set_report_format(format)) {}
+
+    ~ScopedReportFormat() {
+        kassert::set_report_format(_previous);
+    }
+
+private:
+    kassert::ReportFormat _previous;
+};
+
+/// @brief Sink that records all reports.
+class RecordingSink final : public kassert::ReportSink {
+public:
+    void write(char const* data, std::size_t const size, kassert::ReportSeverity) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        reports.emplace_back(data, size);
+    }
+
+    std::vector<std::string> reports;
+
+private:
+    std::mutex _mutex;
+};
+
+/// @brief Matches a report that consists of a single JSON object on a single line.
+MATCHER(IsSingleRecord, "is a single-line JSON record") {
+    return !arg.empty() && arg.front() == '{' && arg.size() >= 2 && arg.compare(arg.size() - 2, 2, "}\n") == 0
+           && std::count(arg.begin(), arg.end(), '\n') == 1;
+}
+} // namespace
+
+TEST(JsonReportTest, decomposed_assertions_report_their_operands) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    int const                lhs = 2;
+    int const                rhs = 3;
+    EXPECT_THAT(
+        [&] { KASSERT(lhs == rhs, "lhs is " << lhs); },
+        FailsAssertion(AllOf(
+            IsSingleRecord(),
+            StartsWith("{\"severity\":\"fatal\",\"type\":\"ASSERTION\",\"file\":\""),
+            HasSubstr(
+                ",\"expression\":\"lhs == rhs\",\"relation\":\"==\",\"operands\":[\"2\",\"3\"],\"message\":\"lhs is 2\""
+            ),
+            HasSubstr(",\"level\":30,\"thread\":"),
+            Not(HasSubstr("\"truncated\""))
+        ))
+    );
+    EXPECT_THAT(
+        [&] { KASSERT(!lhs); },
+        FailsAssertion(HasSubstr("\"expression\":\"!lhs\",\"operands\":[\"false\"],\"message\":\"\""))
+    );
+}
+
+TEST(JsonReportTest, undecomposed_assertions_report_no_operands) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    int const                lhs = 2;
+    EXPECT_THAT(
+        [&] { KASSERT(lhs == 2 && lhs == 3); },
+        FailsAssertion(AllOf(
+            IsSingleRecord(),
+            HasSubstr("\"expression\":\"lhs == 2 && lhs == 3\",\"message\":\"\""),
+            Not(HasSubstr("\"operands\""))
+        ))
+    );
+}
+
+TEST(JsonReportTest, strings_are_escaped) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    std::string const        text = "a \"quoted\"\tline\n\\";
+    EXPECT_THAT(
+        [&] { KASSERT(text.empty(), "first\nsecond " << '\x01'); },
+        FailsAssertion(AllOf(
+            IsSingleRecord(),
+            HasSubstr("\"message\":\"first\\nsecond \\u0001\""),
+            HasSubstr("\"expression\":\"text.empty()\"")
+        ))
+    );
+    EXPECT_THAT(
+        [&] { KASSERT(text == "", "message"); },
+        FailsAssertion(HasSubstr("\"operands\":[\"a \\\"quoted\\\"\\tline\\n\\\\\",\"\"]"))
+    );
+}
+
+TEST(JsonReportTest, strings_remain_valid_utf8) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    EXPECT_THAT(
+        [] { KASSERT(false, "\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"); },
+        FailsAssertion(HasSubstr("\"message\":\"\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\""))
+    );
+    // invalid bytes, lone continuation bytes, incomplete sequences, overlong encodings and surrogates
+    EXPECT_THAT(
+        [] { KASSERT(false, "\xff|\x80|\xe2\x82|\xc0\xaf|\xed\xa0\x80|\xf4\x90\x80\x80"); },
+        FailsAssertion(HasSubstr(
+            "\"message\":\"\\ufffd|\\ufffd|\\ufffd\\ufffd|\\ufffd\\ufffd|\\ufffd\\ufffd\\ufffd|"
+            "\\ufffd\\ufffd\\ufffd\\ufffd\""
+        ))
+    );
+}
+
+TEST(JsonReportTest, truncation_does_not_split_utf8_sequences) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    std::string              text;
+    while (text.size() < 2 * KASSERT_LOGGER_BUFFER_SIZE) {
+        text += "\xe2\x82\xac";
+    }
+    for (std::size_t offset = 0; offset < 3; ++offset) {
+        std::string const message = std::string(offset, 'x') + text;
+        auto const        report  = kassert::testing::failure_report([&] { KASSERT(false, message); });
+        ASSERT_TRUE(report.has_value());
+        std::string const key   = "\"message\":\"";
+        std::size_t const begin = report->find(key) + key.size();
+        std::size_t const end   = report->find('"', begin);
+        ASSERT_NE(end, std::string::npos);
+        EXPECT_THAT(*report, EndsWith(",\"truncated\":true}\n"));
+        EXPECT_EQ((end - begin - offset) % 3, 0u) << "offset " << offset;
+    }
+}
+
+TEST(JsonReportTest, details_of_range_assertions_are_part_of_the_message) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    std::vector<int> const   lhs = {1, 2, 3};
+    std::vector<int> const   rhs = {1, 4, 3};
+    EXPECT_THAT(
+        [&] { KASSERT_RANGE_EQ(lhs, rhs, "message"); },
+        FailsAssertion(AllOf(IsSingleRecord(), HasSubstr("\"message\":\""), HasSubstr("message\",\"level\":30,")))
+    );
+}
+
+TEST(JsonReportTest, warnings_report_their_failure_counts) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    RecordingSink            sink;
+    kassert::ReportSink*     previous = kassert::set_report_sink(&sink);
+    auto                     warn_lt  = [](int const lhs, int const rhs) {
+        KASSERT_WARN(lhs < rhs, "warned " << lhs);
+    };
+    warn_lt(2, 1);
+    kassert::set_report_sink(previous);
+
+    ASSERT_EQ(sink.reports.size(), 1u);
+    EXPECT_THAT(sink.reports[0], IsSingleRecord());
+    EXPECT_THAT(sink.reports[0], StartsWith("{\"severity\":\"warning\",\"type\":\"WARNING\","));
+    EXPECT_THAT(
+        sink.reports[0],
+        HasSubstr(
+            "\"relation\":\"<\",\"operands\":[\"2\",\"1\"],\"message\":\"warned 2\",\"suppressed\":0,\"failures\":1,"
+            "\"level\":30,"
+        )
+    );
+}
+
+TEST(JsonReportTest, rank_is_reported_if_known) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    kassert::set_report_rank(7);
+    EXPECT_THAT([] { KASSERT(false); }, FailsAssertion(HasSubstr(",\"rank\":7}\n")));
+    kassert::set_report_rank(-1);
+    EXPECT_THAT([] { KASSERT(false); }, FailsAssertion(Not(HasSubstr("\"rank\""))));
+}
+
+TEST(JsonReportTest, truncated_records_remain_valid) {
+    ScopedReportFormat const json(kassert::ReportFormat::json);
+    std::string const        text(2 * KASSERT_LOGGER_BUFFER_SIZE, '"');
+    EXPECT_THAT(
+        [&] { KASSERT(text.empty(), text); },
+        FailsAssertion(AllOf(IsSingleRecord(), EndsWith(",\"truncated\":true}\n")))
+    );
+}
+
+TEST(JsonReportTest, text_reports_are_unchanged) {
+    ScopedReportFormat const text(kassert::ReportFormat::text);
+    int const                lhs = 2;
+    EXPECT_THAT(
+        [&] { KASSERT(lhs == 3, "message"); },
+        FailsAssertion(HasSubstr("FAILED ASSERTION\n\tlhs == 3\nwith expansion:\n\t2 == 3\nmessage\n"))
+    );
+}
@@ -10,6 +10,9 @@
 #define ASSERTION_LEVEL_LOWER_THAN_NORMAL  -10000
 #define ASSERTION_LEVEL_HIGHER_THAN_NORMAL 10000
 
+#include <cstdint>
+#include <limits>
+
 #include <gmock/gmock.h>
 
 #include "kassert/kassert.hpp"
@@ -126,6 +129,107 @@ TEST(KassertTest, kthrow_does_nothing_on_true_expression) {
     THROWING_KASSERT_SPECIFIED(true, "", ZeroCustomArgException);
 }
 
+// Check that failed assertions name the function that contains them, and not the lambda that constructs the exception
+// of THROWING_KASSERT().
+TEST(KassertTest, failed_assertions_name_enclosing_function) {
+    ASSERT_KASSERT_FAILS(KASSERT(false), "In function '[^']*TestBody\\(\\)'");
+#ifdef KASSERT_EXCEPTION_MODE
+    try {
+        THROWING_KASSERT(false);
+        FAIL() << "THROWING_KASSERT() did not throw";
+    } catch (kassert::KassertException const& e) {
+        EXPECT_THAT(e.what(), HasSubstr("TestBody()'"));
+        EXPECT_THAT(e.what(), Not(HasSubstr("lambda")));
+    }
+    try {
+        THROWING_KASSERT_SPECIFIED(false, "", kassert::KassertException);
+        FAIL() << "THROWING_KASSERT_SPECIFIED() did not throw";
+    } catch (kassert::KassertException const& e) {
+        EXPECT_THAT(e.what(), HasSubstr("TestBody()'"));
+        EXPECT_THAT(e.what(), Not(HasSubstr("lambda")));
+    }
+#else  // KASSERT_EXCEPTION_MODE
+    ASSERT_KASSERT_FAILS(THROWING_KASSERT(false), "In function '[^']*TestBody\\(\\)'");
+#endif // KASSERT_EXCEPTION_MODE
+}
+
+// Check that THROWING_KASSERT() reports the expansion of decomposed expressions.
+TEST(KassertTest, kthrow_reports_expansion) {
+    int const lhs = 2;
+#ifdef KASSERT_EXCEPTION_MODE
+    try {
+        THROWING_KASSERT(lhs == 3, "lhs is " << lhs);
+        FAIL() << "THROWING_KASSERT() did not throw";
+    } catch (kassert::KassertException const& e) {
+        EXPECT_THAT(e.what(), HasSubstr("FAILED ASSERTION\n\tlhs == 3\nwith expansion:\n\t2 == 3\nlhs is 2\n"));
+    }
+    try {
+        THROWING_KASSERT_SPECIFIED(lhs == 3, "lhs is " << lhs, kassert::KassertException);
+        FAIL() << "THROWING_KASSERT_SPECIFIED() did not throw";
+    } catch (kassert::KassertException const& e) {
+        EXPECT_THAT(e.what(), HasSubstr("\tlhs == 3\nwith expansion:\n\t2 == 3\nlhs is 2\n"));
+    }
+#else  // KASSERT_EXCEPTION_MODE
+    EXPECT_EXIT(
+        { THROWING_KASSERT(lhs == 3, "lhs is " << lhs); },
+        KilledBySignal(SIGABRT),
+        "lhs == 3\nwith expansion:\n\t2 == 3\nlhs is 2"
+    );
+#endif // KASSERT_EXCEPTION_MODE
+}
+
+// Check that the exceptions thrown by THROWING_KASSERT() expose the parts of their description.
+TEST(KassertTest, kthrow_exception_is_structured) {
+    int const lhs = 2;
+    auto      check = [&] {
+        THROWING_KASSERT(lhs == 3, "lhs is " << lhs);
+    };
+#ifdef KASSERT_EXCEPTION_MODE
+    try {
+        check();
+        FAIL() << "THROWING_KASSERT() did not throw";
+    } catch (kassert::KassertException const& e) {
+        EXPECT_THAT(e.file(), HasSubstr("kassert_test.cpp"));
+        EXPECT_GT(e.line(), 0u);
+        EXPECT_THAT(e.function(), HasSubstr("TestBody"));
+        EXPECT_STREQ(e.expression(), "lhs == 3");
+        EXPECT_EQ(e.message(), "lhs is 2");
+        EXPECT_EQ(e.expansion(), "2 == 3");
+
+        // copies build their own description
+        kassert::KassertException copy = e;
+        EXPECT_STREQ(copy.what(), e.what());
+        EXPECT_NE(copy.what(), e.what());
+        copy = kassert::KassertException("replaced");
+        EXPECT_STREQ(copy.what(), "replaced");
+        copy = e;
+        EXPECT_STREQ(copy.what(), e.what());
+        EXPECT_EQ(copy.expansion(), "2 == 3");
+    }
+    try {
+        THROWING_KASSERT(lhs == 2 && lhs == 3);
+        FAIL() << "THROWING_KASSERT() did not throw";
+    } catch (kassert::KassertException const& e) {
+        // expressions using && cannot be decomposed
+        EXPECT_EQ(e.expansion(), "");
+        EXPECT_THAT(e.what(), Not(HasSubstr("with expansion")));
+    }
+#else  // KASSERT_EXCEPTION_MODE
+    EXPECT_EXIT(check(), KilledBySignal(SIGABRT), "lhs is 2");
+#endif // KASSERT_EXCEPTION_MODE
+}
+
+// Check that exceptions constructed from a description report it verbatim.
+TEST(KassertTest, kassert_exception_from_description) {
+    kassert::KassertException const e("description");
+    EXPECT_STREQ(e.what(), "description");
+    EXPECT_EQ(e.message(), "description");
+    EXPECT_STREQ(e.expression(), "");
+    EXPECT_STREQ(e.file(), "");
+    EXPECT_EQ(e.line(), 0u);
+    EXPECT_EQ(e.expansion(), "");
+}
+
 // Test that expressions are evaluated as expected
 // The following tests do not check the expression expansion!
 
@@ -455,3 +559,307 @@ TEST(KassertTest, kassert_enabled_works) {
     EXPECT_TRUE(flag);
     flag = false;
 }
+
+// Test that decomposed expressions are statically dispatched and cheap to copy
+
+TEST(KassertTest, decomposed_expressions_are_not_polymorphic) {
+    using IntLessInt     = kassert::internal::BinaryExpression<int, int, kassert::internal::operators::Less>;
+    using IntVecEqIntVec = kassert::internal::
+        BinaryExpression<std::vector<int>, std::vector<int>, kassert::internal::operators::Equal>;
+    using UnaryBool = kassert::internal::UnaryExpression<bool>;
+
+    static_assert(!std::is_polymorphic_v<IntLessInt>);
+    static_assert(!std::is_polymorphic_v<IntVecEqIntVec>);
+    static_assert(!std::is_polymorphic_v<UnaryBool>);
+
+    // small trivially copyable operands are stored by value, all other operands by reference
+    static_assert(std::is_trivially_copyable_v<IntLessInt>);
+    static_assert(sizeof(IntLessInt) <= 3 * sizeof(int));
+    static_assert(sizeof(IntVecEqIntVec) <= 3 * sizeof(void*));
+    static_assert(sizeof(UnaryBool) == sizeof(bool));
+
+    // decomposition is usable in constant expressions
+    using namespace kassert::internal;
+    static_assert(finalize_expr((Decomposer{} <= 1) < 2).result());
+    static_assert(!finalize_expr(((Decomposer{} <= 1) == 1) == 5).result());
+}
+
+// Test that the buffered logger used for assertion messages formats values and truncates overlong output
+
+TEST(KassertTest, buffered_logger_formats_and_truncates) {
+    auto log_values = [] {
+        kassert::internal::FdLogger logger(kassert::internal::standard_error);
+        logger << "int=" << -42 << " uint=" << 42u << " bool=" << true << " char=" << 'c' << " double=" << 0.5
+               << " str=" << std::string("abc") << " null=" << static_cast<char const*>(nullptr) << "\n";
+    };
+    EXPECT_EXIT(
+        {
+            log_values();
+            std::abort();
+        },
+        KilledBySignal(SIGABRT),
+        "int=-42 uint=42 bool=true char=c double=0.5 str=abc null=\\(null\\)"
+    );
+
+    auto log_long_message = [] {
+        kassert::internal::FdLogger logger(kassert::internal::standard_error);
+        logger << std::string(2 * KASSERT_LOGGER_BUFFER_SIZE, 'x');
+    };
+    EXPECT_EXIT(
+        {
+            log_long_message();
+            std::abort();
+        },
+        KilledBySignal(SIGABRT),
+        "x \\[...\\] \\(truncated\\)"
+    );
+}
+
+// Test sampled assertions
+
+TEST(KassertTest, kassert_sampled_evaluates_every_nth_time) {
+    int  evaluations = 0;
+    auto check       = [&](int const value) {
+        KASSERT_SAMPLED((++evaluations, value >= 0), "", kassert::assert::normal, 10);
+    };
+    for (int i = 0; i < 100; ++i) {
+        check(i);
+    }
+    EXPECT_EQ(evaluations, 10);
+
+    // a sampling rate of 1 evaluates the expression every time
+    int  evaluations_rate_1 = 0;
+    auto check_rate_1       = [&] {
+        KASSERT_SAMPLED((++evaluations_rate_1, true), "", kassert::assert::normal, 1);
+    };
+    for (int i = 0; i < 10; ++i) {
+        check_rate_1();
+    }
+    EXPECT_EQ(evaluations_rate_1, 10);
+
+    // disabled assertions are never evaluated
+    int  evaluations_disabled = 0;
+    auto check_disabled       = [&] {
+        KASSERT_SAMPLED((++evaluations_disabled, true), "", assert::heavy, 1);
+    };
+    check_disabled();
+    EXPECT_EQ(evaluations_disabled, 0);
+}
+
+TEST(KassertTest, kassert_sampled_clamps_runtime_rates) {
+    using kassert::internal::clamp_sampling_rate;
+    using kassert::internal::max_sampling_rate;
+    static_assert(clamp_sampling_rate(-1) == 1);
+    static_assert(clamp_sampling_rate(0) == 1);
+    static_assert(clamp_sampling_rate(10u) == 10);
+    static_assert(clamp_sampling_rate(max_sampling_rate) == max_sampling_rate);
+    static_assert(clamp_sampling_rate(std::int64_t{max_sampling_rate} + 1) == max_sampling_rate);
+    static_assert(clamp_sampling_rate(std::numeric_limits<std::uint64_t>::max()) == max_sampling_rate);
+
+    // non-positive rates evaluate the expression every time instead of wrapping around to huge rates
+    for (int const rate: {0, -1, std::numeric_limits<int>::min()}) {
+        int  evaluations = 0;
+        auto check       = [&] {
+            KASSERT_SAMPLED((++evaluations, true), "", kassert::assert::normal, rate);
+        };
+        auto check_randomized = [&] {
+            KASSERT_SAMPLED_RANDOMIZED((++evaluations, true), "", kassert::assert::normal, rate);
+        };
+        for (int i = 0; i < 10; ++i) {
+            check();
+            check_randomized();
+        }
+        EXPECT_EQ(evaluations, 20) << "rate " << rate;
+    }
+
+    // too large rates still sample the first evaluation (the rate is not const, since constant rates outside of the
+    // valid range do not compile)
+    std::uint64_t huge_rate   = std::numeric_limits<std::uint64_t>::max();
+    int           evaluations = 0;
+    auto          check       = [&] {
+        KASSERT_SAMPLED((++evaluations, true), "", kassert::assert::normal, huge_rate);
+        KASSERT_SAMPLED_RANDOMIZED((++evaluations, true), "", kassert::assert::normal, huge_rate);
+    };
+    for (int i = 0; i < 10; ++i) {
+        check();
+    }
+    EXPECT_EQ(evaluations, 2);
+}
+
+TEST(KassertTest, kassert_sampled_randomized_evaluates_every_nth_time_on_average) {
+    int  evaluations = 0;
+    auto check       = [&] {
+        KASSERT_SAMPLED_RANDOMIZED((++evaluations, true), "", kassert::assert::normal, 10);
+    };
+    for (int i = 0; i < 100000; ++i) {
+        check();
+    }
+    EXPECT_GT(evaluations, 9000);
+    EXPECT_LT(evaluations, 11000);
+}
+
+TEST(KassertTest, kassert_sampled_failure_is_reported) {
+    // the first evaluation is always sampled
+    auto sampled_lt = [](int const lhs, int const rhs) {
+        KASSERT_SAMPLED(lhs < rhs, "sampled " << lhs, kassert::assert::normal, 1000);
+    };
+    auto randomized_lt = [](int const lhs, int const rhs) {
+        KASSERT_SAMPLED_RANDOMIZED(lhs < rhs, "randomized " << lhs, kassert::assert::normal, 1000);
+    };
+    EXPECT_KASSERT_FAILS(sampled_lt(2, 1), "FAILED ASSERTION\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nsampled 2");
+    EXPECT_KASSERT_FAILS(randomized_lt(2, 1), "FAILED ASSERTION\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nrandomized 2");
+}
+
+// Test cost-budgeted assertions
+
+TEST(KassertTest, estimated_cost_of_complexity_classes) {
+    using kassert::Complexity;
+    static_assert(kassert::estimated_cost(Complexity::constant, 1000) == 1);
+    static_assert(kassert::estimated_cost(Complexity::logarithmic, 0) == 1);
+    static_assert(kassert::estimated_cost(Complexity::logarithmic, 1024) == 11);
+    static_assert(kassert::estimated_cost(Complexity::linear, 1000) == 1000);
+    static_assert(kassert::estimated_cost(Complexity::linearithmic, 1024) == 11 * 1024);
+    static_assert(kassert::estimated_cost(Complexity::quadratic, 1000) == 1000 * 1000);
+    static_assert(kassert::estimated_cost(Complexity::cubic, 1000) == 1000 * 1000 * 1000);
+    // costs saturate instead of overflowing
+    static_assert(kassert::estimated_cost(Complexity::quadratic, 1ull << 32) == kassert::unlimited_cost_budget);
+    static_assert(kassert::estimated_cost(Complexity::cubic, 1ull << 22) == kassert::unlimited_cost_budget);
+}
+
+TEST(KassertTest, kassert_with_cost_respects_cost_budget_of_its_level) {
+    int  evaluations = 0;
+    auto check       = [&](std::size_t const size) {
+        KASSERT_WITH_COST((++evaluations, true), "", kassert::assert::normal, kassert::Complexity::quadratic, size);
+    };
+    EXPECT_EQ(kassert::cost_budget(kassert::assert::normal), kassert::unlimited_cost_budget);
+    check(1'000'000);
+    EXPECT_EQ(evaluations, 1);
+
+    std::uint64_t const previous = kassert::set_cost_budget(kassert::assert::normal, 10'000);
+    EXPECT_EQ(previous, kassert::unlimited_cost_budget);
+    EXPECT_EQ(kassert::cost_budget(kassert::assert::normal), 10'000u);
+    check(100);
+    check(101);
+    EXPECT_EQ(evaluations, 2);
+
+    // the budgets of other levels are not affected
+    int  light_evaluations = 0;
+    auto check_light       = [&](std::size_t const size) {
+        KASSERT_WITH_COST((++light_evaluations, true), "", assert::light, kassert::Complexity::quadratic, size);
+    };
+    check_light(101);
+    EXPECT_EQ(light_evaluations, 1);
+
+    kassert::set_cost_budget(kassert::assert::normal, previous);
+    check(101);
+    EXPECT_EQ(evaluations, 3);
+}
+
+TEST(KassertTest, kassert_with_cost_shares_budgets_of_levels_out_of_range) {
+    int  evaluations = 0;
+    auto check       = [&] {
+        KASSERT_WITH_COST((++evaluations, true), "", ASSERTION_LEVEL_LOWER_THAN_NORMAL, kassert::Complexity::linear, 2);
+    };
+    kassert::set_cost_budget(0, 1);
+    EXPECT_EQ(kassert::cost_budget(ASSERTION_LEVEL_LOWER_THAN_NORMAL), 1u);
+    check();
+    EXPECT_EQ(evaluations, 0);
+
+    kassert::set_cost_budget(kassert::unlimited_cost_budget);
+    check();
+    EXPECT_EQ(evaluations, 1);
+}
+
+TEST(KassertTest, kassert_with_cost_does_not_evaluate_size_if_disabled) {
+    int  sizes       = 0;
+    int  evaluations = 0;
+    auto check       = [&] {
+        KASSERT_WITH_COST((++evaluations, true), "", assert::heavy, kassert::Complexity::linear, (++sizes, 1));
+    };
+    check();
+    EXPECT_EQ(sizes, 0);
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST(KassertTest, kassert_with_cost_failure_is_reported) {
+    auto linear_lt = [](int const lhs, int const rhs) {
+        KASSERT_WITH_COST(lhs < rhs, "costly " << lhs, kassert::assert::normal, kassert::Complexity::linear, 10);
+    };
+    EXPECT_KASSERT_FAILS(linear_lt(2, 1), "FAILED ASSERTION\n\tlhs < rhs\nwith expansion:\n\t2 < 1\ncostly 2");
+
+    // assertions exceeding the budget are not evaluated, thus cannot fail
+    kassert::set_cost_budget(kassert::assert::normal, 9);
+    linear_lt(2, 1);
+    kassert::set_cost_budget(kassert::assert::normal, kassert::unlimited_cost_budget);
+}
+
+// Test non-fatal assertions
+
+TEST(KassertTest, kassert_warn_overloads_compile) {
+    KASSERT_WARN(true);
+    KASSERT_WARN(true, "message");
+    KASSERT_WARN(true, "message", kassert::assert::normal);
+
+    // disabled warnings are never evaluated
+    int evaluations = 0;
+    KASSERT_WARN((++evaluations, false), "", assert::heavy);
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST(KassertTest, kassert_warn_reports_and_continues) {
+    auto warn_lt = [](int const lhs, int const rhs) {
+        KASSERT_WARN(lhs < rhs, "warned " << lhs, kassert::assert::normal);
+    };
+    testing::internal::CaptureStderr();
+    warn_lt(2, 1);
+    warn_lt(1, 2);
+    std::string const output = testing::internal::GetCapturedStderr();
+    EXPECT_THAT(output, HasSubstr("FAILED WARNING\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nwarned 2\n"));
+    EXPECT_THAT(output, Not(HasSubstr("suppressed")));
+}
+
+TEST(KassertTest, kassert_warn_is_rate_limited) {
+    auto warn = [](int const i) {
+        KASSERT_WARN(i < 0, "failure " << i, kassert::assert::normal);
+    };
+    testing::internal::CaptureStderr();
+    for (int i = 1; i <= 100; ++i) {
+        warn(i);
+    }
+    std::string const output = testing::internal::GetCapturedStderr();
+
+    // the first KASSERT_WARNING_BURST failures, then the failures whose number is a power of two
+    std::size_t reports = 0;
+    std::size_t pos     = output.find("FAILED WARNING");
+    while (pos != std::string::npos) {
+        ++reports;
+        pos = output.find("FAILED WARNING", pos + 1);
+    }
+    EXPECT_EQ(reports, 11u);
+    EXPECT_THAT(output, HasSubstr("failure 8\n"));
+    EXPECT_THAT(output, Not(HasSubstr("failure 9\n")));
+    EXPECT_THAT(output, HasSubstr("failure 16\n(7 similar warnings suppressed, 16 in total)\n"));
+    EXPECT_THAT(output, HasSubstr("failure 32\n(15 similar warnings suppressed, 32 in total)\n"));
+    EXPECT_THAT(output, HasSubstr("failure 64\n(31 similar warnings suppressed, 64 in total)\n"));
+}
+
+// Test that KASSERT_ASSUME() behaves like KASSERT() if enabled
+
+TEST(KassertTest, kassert_assume_overloads_compile) {
+    KASSERT_ASSUME(true);
+    KASSERT_ASSUME(true, "message");
+    KASSERT_ASSUME(true, "message", kassert::assert::normal);
+
+    // disabled assertions are lowered to optimizer hints
+    int const  value   = 5;
+    int const* pointer = &value;
+    KASSERT_ASSUME(pointer != nullptr, "", assert::heavy);
+    KASSERT_ASSUME(value % 5 == 0, "", assert::heavy);
+}
+
+TEST(KassertTest, kassert_assume_fails_if_enabled) {
+    auto assume_lt = [](int const lhs, int const rhs) {
+        KASSERT_ASSUME(lhs < rhs, "assumed " << lhs, kassert::assert::normal);
+    };
+    EXPECT_KASSERT_FAILS(assume_lt(2, 1), "FAILED ASSERTION\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nassumed 2");
+}
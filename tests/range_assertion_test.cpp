@@ -0,0 +1,282 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/range.hpp"
+#include "kassert/thread_range_executor.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Returns the vector `[0, 1, ..., size - 1]`.
+std::vector<std::int64_t> iota_vector(std::size_t const size) {
+    std::vector<std::int64_t> values(size);
+    std::iota(values.begin(), values.end(), 0);
+    return values;
+}
+} // namespace
+
+TEST(RangeAssertionTest, range_eq_holds) {
+    std::vector<std::int64_t> const lhs = iota_vector(1000);
+    std::vector<std::int64_t> const rhs = iota_vector(1000);
+    KASSERT_RANGE_EQ(lhs, rhs);
+    KASSERT_RANGE_EQ(lhs, rhs, "message");
+    KASSERT_RANGE_EQ(lhs, rhs, "message", kassert::assert::normal);
+
+    // arguments containing commas must be parenthesized, as for KASSERT()
+    std::vector<int> const empty;
+    KASSERT_RANGE_EQ(empty, (std::array<int, 0>{}));
+    KASSERT_RANGE_EQ((std::list<double>{1.0, 2.0}), (std::vector<double>{1.0, 2.0}));
+    KASSERT_RANGE_EQ((std::vector<std::string>{"a", "b"}), (std::vector<std::string>{"a", "b"}));
+}
+
+TEST(RangeAssertionTest, range_eq_reports_first_mismatch) {
+    std::vector<std::int64_t> const lhs = iota_vector(100'000);
+    std::vector<std::int64_t>       rhs = lhs;
+    rhs[1234]                           = -1;
+    rhs[5000]                           = -1;
+
+    // only the window around the first mismatch is printed, not the whole ranges
+    EXPECT_EXIT(
+        { KASSERT_RANGE_EQ(lhs, rhs, "custom message"); }, KilledBySignal(SIGABRT),
+        "FAILED ASSERTION\n\tlhs == rhs\nwith expansion:\n\tfirst mismatch at index 1234: 1234 != -1\n"
+        "\tlhs\\[1231..1237\\]: \\[\\.\\.\\., 1231, 1232, 1233, 1234, 1235, 1236, 1237, \\.\\.\\.\\]\n"
+        "\trhs\\[1231..1237\\]: \\[\\.\\.\\., 1231, 1232, 1233, -1, 1235, 1236, 1237, \\.\\.\\.\\]\n"
+        "custom message"
+    );
+}
+
+TEST(RangeAssertionTest, range_eq_reports_size_mismatch) {
+    std::vector<int> const lhs = {1, 2, 3};
+    std::vector<int> const rhs = {1, 2, 3, 4};
+    EXPECT_EXIT(
+        { KASSERT_RANGE_EQ(lhs, rhs); }, KilledBySignal(SIGABRT),
+        "\tsizes differ: 3 != 4\n\tthe first 3 elements are equal\n\tlhs\\[0..2\\]: \\[1, 2, 3\\]\n"
+        "\trhs\\[0..3\\]: \\[1, 2, 3, 4\\]\n"
+    );
+
+    std::vector<int> const empty;
+    EXPECT_EXIT({ KASSERT_RANGE_EQ(empty, rhs); }, KilledBySignal(SIGABRT), "\tlhs: \\[\\]\n");
+}
+
+TEST(RangeAssertionTest, range_eq_generic_ranges) {
+    std::list<int> const   lhs = {1, 2, 3, 4};
+    std::vector<int> const rhs = {1, 2, 5, 4};
+    EXPECT_EXIT({ KASSERT_RANGE_EQ(lhs, rhs); }, KilledBySignal(SIGABRT), "first mismatch at index 2: 3 != 5\n");
+}
+
+TEST(RangeAssertionTest, range_eq_memcmp_kernel_finds_mismatch_in_every_block) {
+    // mismatches at the start and end of blocks and in the scalar tail
+    for (std::size_t const index: {0ul, 255ul, 256ul, 511ul, 999ul}) {
+        std::vector<std::uint8_t> const lhs(1000, 7);
+        std::vector<std::uint8_t>       rhs = lhs;
+        rhs[index]                          = 8;
+        EXPECT_EQ(kassert::internal::contiguous_mismatch(lhs.data(), rhs.data(), 0, lhs.size()), index);
+        EXPECT_FALSE(kassert::internal::check_range_equal(lhs, rhs).result());
+    }
+}
+
+TEST(RangeAssertionTest, sorted) {
+    std::vector<std::int64_t> values = iota_vector(10'000);
+    KASSERT_SORTED(values);
+    KASSERT_SORTED(std::vector<int>{});
+    KASSERT_SORTED((std::vector<int>{1, 1, 2}));
+    KASSERT_SORTED((std::list<int>{1, 2, 3}), "message", kassert::assert::normal);
+
+    for (std::size_t const index: {1ul, 255ul, 256ul, 257ul, 9999ul}) {
+        std::vector<std::int64_t> unsorted = values;
+        unsorted[index]                    = -1;
+        EXPECT_FALSE(kassert::internal::check_range_sorted(unsorted).result());
+    }
+
+    values[7000] = 0;
+    EXPECT_EXIT(
+        { KASSERT_SORTED(values); }, KilledBySignal(SIGABRT),
+        "\tis_sorted\\(values\\)\nwith expansion:\n\telement at index 7000 is smaller than its predecessor: 0 < 6999\n"
+        "\trange\\[6997..7003\\]: \\[\\.\\.\\., 6997, 6998, 6999, 0, 7001, 7002, 7003, \\.\\.\\.\\]\n"
+    );
+}
+
+TEST(RangeAssertionTest, all_of) {
+    std::vector<std::int64_t> values = iota_vector(10'000);
+    KASSERT_ALL_OF(values, [](std::int64_t const value) { return value >= 0; });
+    KASSERT_ALL_OF(std::list<int>{}, [](int) { return false; });
+
+    values[300] = -5;
+    EXPECT_EXIT(
+        { KASSERT_ALL_OF(values, [](std::int64_t const value) { return value >= 0; }, "negative value"); },
+        KilledBySignal(SIGABRT),
+        "\tpredicate does not hold for the element at index 300: -5\n"
+        "\trange\\[297..303\\]: \\[\\.\\.\\., 297, 298, 299, -5, 301, 302, 303, \\.\\.\\.\\]\nnegative value"
+    );
+}
+
+TEST(RangeAssertionTest, unique) {
+    KASSERT_UNIQUE(iota_vector(1000));
+    KASSERT_UNIQUE((std::vector<std::string>{"a", "b", "c"}));
+    KASSERT_UNIQUE(std::vector<int>{});
+    EXPECT_FALSE(kassert::internal::check_range_unique(std::vector<std::string>{"a", "b", "a"}).result());
+
+    // the first element that repeats an earlier element is reported, i.e., index 4 (and not index 5)
+    std::vector<int> const values = {9, 3, 8, 1, 8, 3};
+    EXPECT_EXIT(
+        { KASSERT_UNIQUE(values); }, KilledBySignal(SIGABRT),
+        "\telement at index 4 equals the element at index 2: 8\n\trange\\[0..5\\]: \\[9, 3, 8, 1, 8, 3\\]\n"
+        "\trange\\[1..5\\]: \\[\\.\\.\\., 3, 8, 1, 8, 3\\]\n"
+    );
+}
+
+TEST(RangeAssertionTest, disabled_range_assertions_are_not_evaluated) {
+    std::vector<int> const values = {2, 1, 1};
+    KASSERT_RANGE_EQ(values, std::vector<int>{}, "", kassert::assert::normal + 1);
+    KASSERT_SORTED(values, "", kassert::assert::normal + 1);
+    KASSERT_ALL_OF(values, [](int) { return false; }, "", kassert::assert::normal + 1);
+    KASSERT_UNIQUE(values, "", kassert::assert::normal + 1);
+}
+
+namespace {
+/// @brief Range executor that runs the tasks of parallel range checks in reverse order on a ThreadRangeExecutor and
+/// counts them.
+class CountingRangeExecutor final : public kassert::RangeExecutor {
+public:
+    explicit CountingRangeExecutor(std::size_t const threads) : RangeExecutor(1024), _executor(threads, 1024) {}
+
+    void run(std::size_t const tasks, kassert::RangeTask const& task) override {
+        auto const reversed = [&](std::size_t const i) {
+            _tasks.fetch_add(1, std::memory_order_relaxed);
+            task(tasks - 1 - i);
+        };
+        _executor.run(tasks, kassert::RangeTask(reversed));
+        ++_runs;
+    }
+
+    [[nodiscard]] std::size_t concurrency() const override {
+        return _executor.concurrency();
+    }
+
+    std::size_t runs() const {
+        return _runs;
+    }
+
+    std::size_t tasks() const {
+        return _tasks.load();
+    }
+
+private:
+    kassert::ThreadRangeExecutor _executor;
+    std::size_t                  _runs = 0;
+    std::atomic<std::size_t>     _tasks{0};
+};
+
+/// @brief Installs a range executor for the lifetime of the object.
+class ScopedRangeExecutor {
+public:
+    explicit ScopedRangeExecutor(kassert::RangeExecutor& executor)
+        : _previous(kassert::set_range_executor(&executor)) {}
+
+    ~ScopedRangeExecutor() {
+        kassert::set_range_executor(_previous);
+    }
+
+private:
+    kassert::RangeExecutor* _previous;
+};
+} // namespace
+
+TEST(RangeAssertionTest, parallel_checks_of_large_ranges) {
+    CountingRangeExecutor     executor(4);
+    ScopedRangeExecutor const scope(executor);
+    EXPECT_EQ(kassert::range_executor(), &executor);
+
+    std::vector<std::int64_t> const values = iota_vector(100'000);
+    KASSERT_RANGE_EQ(values, iota_vector(100'000));
+    KASSERT_SORTED(values);
+    KASSERT_ALL_OF(values, [](std::int64_t const value) { return value >= 0; });
+    EXPECT_EQ(executor.runs(), 3);
+    EXPECT_GT(executor.tasks(), 3);
+
+    // small and non-contiguous ranges are checked by the calling thread
+    KASSERT_SORTED(iota_vector(1000));
+    KASSERT_SORTED((std::list<int>(2000, 1)));
+    EXPECT_EQ(executor.runs(), 3);
+}
+
+TEST(RangeAssertionTest, parallel_checks_report_first_violation) {
+    CountingRangeExecutor     executor(4);
+    ScopedRangeExecutor const scope(executor);
+
+    // violations in several chunks, which are checked in reverse order: the first violation is reported regardless
+    std::vector<std::int64_t> const values = iota_vector(100'000);
+    std::vector<std::int64_t>       broken = values;
+    for (std::size_t const index: {90'001ul, 50'001ul, 30'001ul, 30'002ul}) {
+        broken[index] = -1;
+    }
+    EXPECT_EQ(kassert::internal::check_range_equal(values, broken).result(), false);
+    EXPECT_EQ(kassert::internal::check_range_sorted(broken).result(), false);
+    EXPECT_EQ(kassert::internal::check_range_all_of(broken, [](std::int64_t v) { return v >= 0; }).result(), false);
+    EXPECT_GT(executor.runs(), 0);
+
+    EXPECT_EXIT({ KASSERT_RANGE_EQ(values, broken); }, KilledBySignal(SIGABRT), "first mismatch at index 30001: ");
+    EXPECT_EXIT(
+        { KASSERT_SORTED(broken); }, KilledBySignal(SIGABRT), "element at index 30001 is smaller than its predecessor"
+    );
+    EXPECT_EXIT(
+        { KASSERT_ALL_OF(broken, [](std::int64_t const value) { return value >= 0; }); }, KilledBySignal(SIGABRT),
+        "predicate does not hold for the element at index 30001: -1"
+    );
+
+    // the parallel search of the first violation agrees with the sequential search for every position
+    for (std::size_t index = 1; index < values.size(); index += 997) {
+        std::vector<std::int64_t> unsorted = values;
+        unsorted[index]                    = -1;
+        unsorted[values.size() - 1]        = -1;
+        std::size_t const found            = kassert::internal::parallel_find_first(
+            executor,
+            unsorted.size(),
+            [&](std::size_t const begin, std::size_t const end) {
+                return kassert::internal::contiguous_sorted_until(unsorted.data(), begin, end);
+            }
+        );
+        EXPECT_EQ(found, index);
+    }
+}
+
+TEST(RangeAssertionTest, single_threaded_executor_is_not_used) {
+    CountingRangeExecutor     executor(1);
+    ScopedRangeExecutor const scope(executor);
+    KASSERT_SORTED(iota_vector(100'000));
+    EXPECT_EQ(executor.runs(), 0);
+}
+
+#if defined(_OPENMP)
+TEST(RangeAssertionTest, openmp_executor) {
+    kassert::OpenMPRangeExecutor executor(1024);
+    ScopedRangeExecutor const    scope(executor);
+
+    std::vector<std::int64_t> values = iota_vector(100'000);
+    KASSERT_SORTED(values);
+    values[12'345] = 0;
+    EXPECT_EQ(kassert::internal::check_range_sorted(values).result(), false);
+    if (executor.concurrency() > 1) {
+        EXPECT_EXIT(
+            { KASSERT_SORTED(values); }, KilledBySignal(SIGABRT),
+            "element at index 12345 is smaller than its predecessor"
+        );
+    }
+}
+#endif
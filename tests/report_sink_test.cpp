@@ -0,0 +1,172 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include "kassert/async_report_sink.hpp"
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Sink that records all reports.
+class RecordingSink final : public kassert::ReportSink {
+public:
+    void write(char const* data, std::size_t const size, kassert::ReportSeverity const severity) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        reports.emplace_back(data, size);
+        severities.push_back(severity);
+    }
+
+    std::vector<std::string>             reports;
+    std::vector<kassert::ReportSeverity> severities;
+
+private:
+    std::mutex _mutex;
+};
+
+/// @brief Sink that prefixes all reports and writes them to the standard error stream.
+class PrefixingSink final : public kassert::ReportSink {
+public:
+    void write(char const* data, std::size_t const size, kassert::ReportSeverity const severity) override {
+        std::string report = severity == kassert::ReportSeverity::fatal ? "[fatal] " : "[warning] ";
+        report.append(data, size);
+        kassert::internal::write_to(kassert::internal::standard_error, report.data(), report.size());
+    }
+};
+
+/// @brief Installs a report sink for the lifetime of this object.
+class ScopedReportSink {
+public:
+    explicit ScopedReportSink(kassert::ReportSink& sink) : _previous(kassert::set_report_sink(&sink)) {}
+
+    ~ScopedReportSink() {
+        kassert::set_report_sink(_previous);
+    }
+
+private:
+    kassert::ReportSink* _previous;
+};
+
+/// @brief Reads everything that was written to a temporary file.
+std::string read_file(std::FILE* file) {
+    std::fflush(file);
+    std::rewind(file);
+    std::string contents;
+    char        buffer[256];
+    std::size_t length = 0;
+    while ((length = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, length);
+    }
+    return contents;
+}
+
+/// @brief Counts the occurrences of a pattern.
+std::size_t count(std::string const& str, std::string const& pattern) {
+    std::size_t occurrences = 0;
+    std::size_t pos         = str.find(pattern);
+    while (pos != std::string::npos) {
+        ++occurrences;
+        pos = str.find(pattern, pos + 1);
+    }
+    return occurrences;
+}
+} // namespace
+
+TEST(ReportSinkTest, warnings_are_passed_to_the_installed_sink) {
+    RecordingSink sink;
+    {
+        ScopedReportSink const scope(sink);
+        EXPECT_EQ(kassert::report_sink(), &sink);
+        auto warn_lt = [](int const lhs, int const rhs) {
+            KASSERT_WARN(lhs < rhs, "warned " << lhs);
+        };
+        warn_lt(2, 1);
+    }
+    EXPECT_EQ(kassert::report_sink(), nullptr);
+
+    ASSERT_EQ(sink.reports.size(), 1u);
+    EXPECT_THAT(sink.reports[0], HasSubstr("FAILED WARNING\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nwarned 2\n"));
+    EXPECT_EQ(sink.severities[0], kassert::ReportSeverity::warning);
+}
+
+TEST(ReportSinkTest, fatal_reports_are_passed_to_the_installed_sink) {
+    auto fail_lt = [](int const lhs, int const rhs) {
+        PrefixingSink          sink;
+        ScopedReportSink const scope(sink);
+        KASSERT(lhs < rhs, "failed " << lhs);
+    };
+    EXPECT_EXIT(fail_lt(2, 1), KilledBySignal(SIGABRT), "\\[fatal\\] .*FAILED ASSERTION\n\tlhs < rhs\n");
+}
+
+TEST(ReportSinkTest, async_sink_writes_reports_of_all_threads) {
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    constexpr int threads             = 4;
+    constexpr int warnings_per_thread = 5;
+    {
+        kassert::AsyncReportSink sink(threads * warnings_per_thread, kassert::internal::FileDescriptor{fileno(file)});
+        ScopedReportSink const   scope(sink);
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([thread] {
+                for (int i = 0; i < warnings_per_thread; ++i) {
+                    KASSERT_WARN(thread < 0, "thread " << thread);
+                }
+            });
+        }
+        for (auto& worker: workers) {
+            worker.join();
+        }
+        sink.flush();
+        EXPECT_EQ(sink.dropped(), 0u);
+    }
+
+    std::string const output = read_file(file);
+    std::fclose(file);
+    EXPECT_EQ(count(output, "FAILED WARNING"), static_cast<std::size_t>(threads * warnings_per_thread));
+    for (int thread = 0; thread < threads; ++thread) {
+        std::string const message = "thread " + std::to_string(thread) + "\n";
+        EXPECT_EQ(count(output, message), static_cast<std::size_t>(warnings_per_thread));
+    }
+}
+
+TEST(ReportSinkTest, async_sink_drops_reports_if_full) {
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    kassert::AsyncReportSink sink(1, kassert::internal::FileDescriptor{fileno(file)});
+    EXPECT_EQ(sink.capacity(), 2u);
+
+    // submitting reports faster than the background thread writes them drops reports, but never silently
+    constexpr std::size_t reports = 1000;
+    for (std::size_t i = 0; i < reports; ++i) {
+        sink.write("report\n", 7, kassert::ReportSeverity::warning);
+    }
+    sink.flush();
+    std::string const output = read_file(file);
+    std::fclose(file);
+    EXPECT_EQ(count(output, "report\n") + sink.dropped(), reports);
+}
+
+TEST(ReportSinkTest, async_sink_writes_pending_reports_before_fatal_report) {
+    auto fail = [] {
+        kassert::AsyncReportSink sink;
+        ScopedReportSink const   scope(sink);
+        KASSERT_WARN(false, "pending warning");
+        KASSERT(false, "fatal failure");
+    };
+    EXPECT_EXIT(fail(), KilledBySignal(SIGABRT), "pending warning\n(.|\n)*fatal failure");
+}
@@ -0,0 +1,97 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <gmock/gmock.h>
+
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+
+// Dummy assertion levels for tests
+namespace assert {
+constexpr int light = kassert::assert::normal - 1;
+constexpr int heavy = kassert::assert::normal + 1;
+} // namespace assert
+
+/// @brief Fixture that restores the runtime assertion level after each test.
+class RuntimeAssertionLevelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        _level = kassert::assertion_level();
+    }
+
+    void TearDown() override {
+        kassert::set_assertion_level(_level);
+    }
+
+private:
+    int _level = 0;
+};
+
+TEST_F(RuntimeAssertionLevelTest, parse_assertion_level) {
+    int level = -1;
+    EXPECT_TRUE(kassert::internal::parse_assertion_level("60", level));
+    EXPECT_EQ(level, 60);
+    EXPECT_TRUE(kassert::internal::parse_assertion_level("-5", level));
+    EXPECT_EQ(level, -5);
+
+    // invalid levels do not change the output parameter
+    level = 42;
+    EXPECT_FALSE(kassert::internal::parse_assertion_level(nullptr, level));
+    EXPECT_FALSE(kassert::internal::parse_assertion_level("", level));
+    EXPECT_FALSE(kassert::internal::parse_assertion_level("normal", level));
+    EXPECT_FALSE(kassert::internal::parse_assertion_level("30x", level));
+    EXPECT_FALSE(kassert::internal::parse_assertion_level("99999999999999999999", level));
+    EXPECT_EQ(level, 42);
+}
+
+TEST_F(RuntimeAssertionLevelTest, runtime_level_does_not_depend_on_the_compile_time_level) {
+    // the level is shared by all translation units, thus it must not be initialized to KASSERT_ASSERTION_LEVEL
+    static_assert(kassert::assert::unlimited > KASSERT_ASSERTION_LEVEL);
+    EXPECT_EQ(kassert::assertion_level(), kassert::assert::unlimited);
+    EXPECT_EQ(kassert::internal::runtime_assertion_level.load(), kassert::assert::unlimited);
+}
+
+TEST_F(RuntimeAssertionLevelTest, set_assertion_level) {
+    kassert::set_assertion_level(assert::light);
+    EXPECT_EQ(kassert::assertion_level(), assert::light);
+    kassert::set_assertion_level(kassert::assert::normal);
+    EXPECT_EQ(kassert::assertion_level(), kassert::assert::normal);
+}
+
+TEST_F(RuntimeAssertionLevelTest, lowered_runtime_level_disables_assertions) {
+    kassert::set_assertion_level(assert::light);
+
+    bool evaluated = false;
+    auto evaluate  = [&] {
+        evaluated = true;
+        return false;
+    };
+    KASSERT(evaluate(), "", kassert::assert::normal);
+    EXPECT_FALSE(evaluated);
+
+    EXPECT_EXIT({ KASSERT(false, "", assert::light); }, KilledBySignal(SIGABRT), "FAILED ASSERTION");
+}
+
+TEST_F(RuntimeAssertionLevelTest, runtime_level_does_not_exceed_compile_time_level) {
+    kassert::set_assertion_level(10000);
+    KASSERT(false, "", assert::heavy); // disabled at compile time
+
+    kassert::set_assertion_level(kassert::assert::normal);
+    EXPECT_EXIT({ KASSERT(false, "", kassert::assert::normal); }, KilledBySignal(SIGABRT), "FAILED ASSERTION");
+}
+
+#ifndef KASSERT_EXCEPTION_MODE
+TEST_F(RuntimeAssertionLevelTest, lowered_runtime_level_disables_throwing_assertions) {
+    kassert::set_assertion_level(kassert::assert::kthrow - 1);
+    THROWING_KASSERT(false);
+
+    kassert::set_assertion_level(kassert::assert::kthrow);
+    EXPECT_EXIT({ THROWING_KASSERT(false); }, KilledBySignal(SIGABRT), "FAILED ASSERTION");
+}
+#endif
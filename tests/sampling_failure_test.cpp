@@ -0,0 +1,38 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstdint>
+
+#include "kassert/kassert.hpp"
+
+// Each section contains a sampled assertion with a constant rate outside of [1, 2^31] and must therefore not compile.
+
+void valid_rates() {
+    constexpr std::uint64_t max_rate = std::uint64_t{1} << 31;
+    KASSERT_SAMPLED(true, "", kassert::assert::normal, 1);
+    KASSERT_SAMPLED_RANDOMIZED(true, "", kassert::assert::normal, max_rate);
+}
+
+void invalid_rates() {
+#if defined(ZERO_RATE)
+    KASSERT_SAMPLED(true, "", kassert::assert::normal, 0);
+#elif defined(NEGATIVE_RATE)
+    KASSERT_SAMPLED_RANDOMIZED(true, "", kassert::assert::normal, -1);
+#elif defined(TOO_LARGE_RATE)
+    constexpr std::uint64_t rate = (std::uint64_t{1} << 31) + 1;
+    KASSERT_SAMPLED(true, "", kassert::assert::normal, rate);
+#elif defined(DISABLED_ASSERTION_WITH_INVALID_RATE)
+    KASSERT_SAMPLED(true, "", kassert::assert::heavy, -1);
+#endif
+}
+
+int main() {
+    valid_rates();
+    invalid_rates();
+    return 0;
+}
@@ -0,0 +1,138 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <array>
+#include <forward_list>
+#include <list>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/kassert.hpp"
+
+using namespace ::testing;
+
+namespace {
+/// @brief Stringifies a value in the same way as the operands of failed assertions.
+template <typename ValueT>
+std::string stringify(ValueT const& value) {
+    kassert::Logger<std::string> logger;
+    kassert::internal::stringify_value(logger, value);
+    return logger.str();
+}
+
+/// @brief Sets the stringification limits for the lifetime of the object and restores the defaults afterwards.
+class ScopedLimits {
+public:
+    ScopedLimits(std::size_t const max_elements, std::size_t const max_depth, std::size_t const max_bytes) {
+        kassert::StringificationLimits limits;
+        limits.max_elements = max_elements;
+        limits.max_depth    = max_depth;
+        limits.max_bytes    = max_bytes;
+        kassert::set_stringification_limits(limits);
+    }
+
+    ~ScopedLimits() {
+        kassert::set_stringification_limits(kassert::StringificationLimits{});
+    }
+};
+} // namespace
+
+TEST(StringificationTest, default_limits) {
+    kassert::StringificationLimits const limits = kassert::stringification_limits();
+    EXPECT_EQ(limits.max_elements, KASSERT_STRINGIFICATION_MAX_ELEMENTS);
+    EXPECT_EQ(limits.max_depth, KASSERT_STRINGIFICATION_MAX_DEPTH);
+    EXPECT_EQ(limits.max_bytes, KASSERT_STRINGIFICATION_MAX_BYTES);
+}
+
+TEST(StringificationTest, standard_ranges) {
+    EXPECT_EQ(stringify(std::array<int, 3>{1, 2, 3}), "[1, 2, 3]");
+    EXPECT_EQ(stringify(std::list<int>{1, 2}), "[1, 2]");
+    EXPECT_EQ(stringify(std::forward_list<int>{1, 2}), "[1, 2]");
+    EXPECT_EQ(stringify(std::set<int>{3, 1, 2}), "[1, 2, 3]");
+    EXPECT_EQ(stringify(std::map<int, char>{{1, 'a'}, {2, 'b'}}), "[(1, a), (2, b)]");
+    EXPECT_EQ(stringify(std::vector<std::vector<int>>{{}, {1}}), "[[], [1]]");
+    EXPECT_EQ(stringify(std::vector<std::string>{"a", "b"}), "[a, b]");
+}
+
+TEST(StringificationTest, tuples_and_optionals) {
+    EXPECT_EQ(stringify(std::tuple<>{}), "()");
+    EXPECT_EQ(stringify(std::tuple<int, char, bool>{1, 'a', true}), "(1, a, true)");
+    EXPECT_EQ(stringify(std::optional<int>{}), "nullopt");
+    EXPECT_EQ(stringify(std::optional<int>{42}), "42");
+    EXPECT_EQ(stringify(std::vector<std::optional<int>>{1, std::nullopt}), "[1, nullopt]");
+}
+
+TEST(StringificationTest, unsupported_element_type) {
+    struct CustomType {};
+    EXPECT_EQ(stringify(std::vector<CustomType>(2)), "[<?>, <?>]");
+}
+
+TEST(StringificationTest, elide_middle_elements) {
+    ScopedLimits const limits(5, 0, 0);
+    std::vector<int>   values(100);
+    std::iota(values.begin(), values.end(), 0);
+    EXPECT_EQ(stringify(values), "[0, 1, 2, ..., 98, 99] (size=100)");
+    EXPECT_EQ(stringify(std::list<int>(values.begin(), values.end())), "[0, 1, 2, ..., 98, 99] (size=100)");
+    EXPECT_EQ(stringify(std::forward_list<int>(values.begin(), values.end())), "[0, 1, 2, ..., 98, 99] (size=100)");
+    EXPECT_EQ(stringify(std::vector<int>{1, 2, 3, 4, 5}), "[1, 2, 3, 4, 5]");
+}
+
+TEST(StringificationTest, single_element_limit) {
+    ScopedLimits const limits(1, 0, 0);
+    EXPECT_EQ(stringify(std::vector<int>{1, 2, 3}), "[1, ...] (size=3)");
+}
+
+TEST(StringificationTest, unlimited) {
+    ScopedLimits const limits(0, 0, 0);
+    std::vector<int>   values(1000, 7);
+    std::string const  output = stringify(values);
+    EXPECT_EQ(output.size(), 2 + 1000 + 2 * 999);
+}
+
+TEST(StringificationTest, max_depth) {
+    ScopedLimits const limits(0, 2, 0);
+    std::vector<std::vector<std::vector<int>>> const nested = {{{1}, {2}}};
+    EXPECT_EQ(stringify(nested), "[[[...], [...]]]");
+    EXPECT_EQ(stringify(std::pair<int, std::tuple<int, std::tuple<int>>>{1, {2, {3}}}), "(1, (2, (...)))");
+    EXPECT_EQ(stringify(std::vector<int>{1}), "[1]");
+}
+
+TEST(StringificationTest, max_bytes) {
+    ScopedLimits const     limits(0, 0, 16);
+    std::vector<int> const values(100, 1);
+    std::string const      output = stringify(values);
+    EXPECT_THAT(output, StartsWith("[1, 1, 1, 1, 1, 1, ..."));
+    EXPECT_THAT(output, EndsWith(", ...] (size=100)"));
+
+    // the byte limit applies to the outermost range
+    std::vector<std::vector<int>> const nested(10, std::vector<int>(10, 1));
+    EXPECT_THAT(stringify(nested), EndsWith("...] (size=10)"));
+    EXPECT_LT(stringify(nested).size(), 64);
+}
+
+TEST(StringificationTest, failed_assertion_with_large_range) {
+    std::vector<int> lhs(5'000'000);
+    std::iota(lhs.begin(), lhs.end(), 0);
+    std::vector<int> const rhs;
+    ScopedLimits const     limits(5, 0, 0);
+
+    auto eq = [&] {
+        KASSERT(lhs == rhs);
+    };
+    EXPECT_EXIT(
+        { eq(); }, KilledBySignal(SIGABRT), "\\[0, 1, 2, \\.\\.\\., 4999998, 4999999\\] \\(size=5000000\\) == \\[\\]"
+    );
+}
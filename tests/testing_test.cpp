@@ -0,0 +1,123 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "kassert/gmock.hpp"
+#include "kassert/kassert.hpp"
+#include "kassert/range.hpp"
+#include "kassert/testing.hpp"
+
+using namespace ::testing;
+using kassert::testing::FailsAssertion;
+
+namespace {
+/// @brief Reports received by \c recording_handler.
+std::vector<std::string> recorded_reports;
+
+/// @brief Failure handler that records the report and returns, i.e., the program is aborted afterwards.
+void recording_handler(char const* report, std::size_t const size) {
+    recorded_reports.emplace_back(report, size);
+    kassert::internal::write_to(kassert::internal::standard_error, "[recorded]", 10);
+}
+} // namespace
+
+TEST(TestingTest, failed_assertions_throw_while_handler_is_installed) {
+    int const lhs = 2;
+    try {
+        kassert::testing::ThrowOnFailure const handler;
+        KASSERT(lhs == 3, "lhs is " << lhs);
+        FAIL() << "KASSERT() did not throw";
+    } catch (kassert::testing::AssertionFailure const& failure) {
+        EXPECT_THAT(
+            failure.report(),
+            HasSubstr("FAILED ASSERTION\n\tlhs == 3\nwith expansion:\n\t2 == 3\nlhs is 2\n")
+        );
+        EXPECT_STREQ(failure.what(), failure.report().c_str());
+    }
+    EXPECT_EQ(kassert::failure_handler(), nullptr);
+}
+
+TEST(TestingTest, failure_report_of_passing_function_is_empty) {
+    EXPECT_EQ(kassert::testing::failure_report([] { KASSERT(1 + 1 == 2); }), std::nullopt);
+    EXPECT_THAT(kassert::testing::failure_report([] { KASSERT(1 + 1 == 3); }), Optional(HasSubstr("2 == 3")));
+}
+
+TEST(TestingTest, matchers_check_assertions_in_process) {
+    int const lhs = 2;
+    EXPECT_THAT([&] { KASSERT(lhs == 3); }, FailsAssertion());
+    EXPECT_THAT([&] { KASSERT(lhs == 3, "message " << lhs); }, FailsAssertion(HasSubstr("2 == 3\nmessage 2")));
+    EXPECT_THAT([&] { KASSERT(lhs == 2); }, Not(FailsAssertion()));
+    EXPECT_THAT([&] { KASSERT(lhs == 3); }, Not(FailsAssertion(HasSubstr("2 == 2"))));
+}
+
+TEST(TestingTest, matchers_describe_mismatches) {
+    auto const matcher = FailsAssertion(HasSubstr("2 == 3"));
+    EXPECT_EQ(
+        DescribeMatcher<std::function<void()>>(matcher),
+        "fails an assertion whose report has substring \"2 == 3\""
+    );
+
+    StringMatchResultListener listener;
+    EXPECT_FALSE(ExplainMatchResult(matcher, [] {}, &listener));
+    EXPECT_EQ(listener.str(), "which does not fail an assertion");
+}
+
+TEST(TestingTest, handler_covers_all_fatal_assertions) {
+    std::vector<int> const values{1, 3, 2};
+    EXPECT_THAT(
+        [&] { KASSERT_SORTED(values); },
+        FailsAssertion(HasSubstr("index 2 is smaller than its predecessor: 2 < 3"))
+    );
+    EXPECT_THAT([&] { KASSERT_ASSUME(values.size() == 2u); }, FailsAssertion(HasSubstr("3 == 2")));
+    EXPECT_THAT([&] { KASSERT_SAMPLED(values.empty(), "", kassert::assert::normal, 1); }, FailsAssertion());
+#ifndef KASSERT_EXCEPTION_MODE
+    EXPECT_THAT(
+        [&] { THROWING_KASSERT(values.size() == 2u, "throwing"); },
+        FailsAssertion(HasSubstr("3 == 2\nthrowing"))
+    );
+#endif
+}
+
+TEST(TestingTest, warnings_do_not_call_handler) {
+    EXPECT_THAT([] { KASSERT_WARN(false); }, Not(FailsAssertion()));
+}
+
+TEST(TestingTest, reports_are_not_written_if_handler_throws) {
+    internal::CaptureStderr();
+    EXPECT_THAT([] { KASSERT(false, "__not_written__"); }, FailsAssertion(HasSubstr("__not_written__")));
+    EXPECT_EQ(internal::GetCapturedStderr(), "");
+}
+
+TEST(TestingTest, program_is_aborted_if_handler_returns) {
+    EXPECT_EXIT(
+        {
+            kassert::set_failure_handler(&recording_handler);
+            KASSERT(false, "__recorded__");
+        },
+        KilledBySignal(SIGABRT),
+        "\\[recorded\\].*FAILED ASSERTION\n\tfalse\n.*__recorded__"
+    );
+}
+
+TEST(TestingTest, set_failure_handler_returns_previous_handler) {
+    EXPECT_EQ(kassert::set_failure_handler(&recording_handler), nullptr);
+    EXPECT_EQ(kassert::failure_handler(), &recording_handler);
+    {
+        kassert::testing::ThrowOnFailure const handler;
+        EXPECT_EQ(kassert::failure_handler(), &kassert::testing::throw_assertion_failure);
+    }
+    EXPECT_EQ(kassert::set_failure_handler(nullptr), &recording_handler);
+    EXPECT_TRUE(recorded_reports.empty());
+}
@@ -0,0 +1,233 @@
+// This file is part of KAssert.
+//
+// Copyright 2021-2022 The KAssert Authors
+
+// Overwrite build option and set assertion level to normal
+#undef KASSERT_ASSERTION_LEVEL
+#define KASSERT_ASSERTION_LEVEL 30 // up to normal assertions
+
+// Small burst such that the time fraction converges quickly
+#define KASSERT_TIME_BUDGET_WINDOW (1ull << 16)
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include "kassert/time_budget.hpp"
+
+using namespace ::testing;
+
+namespace {
+// Each test uses its own level such that the accounts of the tests do not interfere.
+constexpr int           unlimited_level = 20;
+constexpr int           zero_level      = 21;
+constexpr int           block_level     = 22;
+constexpr int           adaptive_level  = 23;
+constexpr int           thread_level    = 24;
+constexpr int           report_level    = 25;
+constexpr int           failure_level   = 26;
+constexpr int           disabled_level  = kassert::assert::normal + 1;
+constexpr std::uint64_t window          = KASSERT_TIME_BUDGET_WINDOW;
+
+/// @brief Sets the time budget of a level for the lifetime of this object and resets the statistics.
+class ScopedTimeBudget {
+public:
+    ScopedTimeBudget(int const level, double const fraction)
+        : _level(level),
+          _previous(kassert::set_time_budget(level, fraction)) {
+        kassert::reset_time_budget_statistics();
+    }
+
+    ~ScopedTimeBudget() {
+        kassert::set_time_budget(_level, _previous);
+    }
+
+private:
+    int    _level;
+    double _previous;
+};
+
+/// @brief Looks up the statistics of a level.
+kassert::TimeBudgetStatistics statistics_of(int const level) {
+    auto const statistics = kassert::time_budget_statistics();
+    auto const entry      = std::find_if(statistics.begin(), statistics.end(), [&](auto const& candidate) {
+        return candidate.level == level;
+    });
+    return entry != statistics.end() ? *entry : kassert::TimeBudgetStatistics{level, 1.0, 0, 0, 0, 0};
+}
+
+/// @brief Busy-waits for the given number of cycles.
+void spin(std::uint64_t const cycles) {
+    std::uint64_t const start = kassert::internal::read_cycle_counter();
+    while (kassert::internal::read_cycle_counter() - start < cycles) {
+    }
+}
+} // namespace
+
+TEST(TimeBudgetTest, account_is_a_token_bucket) {
+    constexpr std::uint64_t              quarter = kassert::internal::time_budget_scale / 4;
+    kassert::internal::TimeBudgetAccount account;
+
+    // the first decision starts with a full bucket of window / 4 cycles
+    EXPECT_TRUE(account.admit(quarter, 1000));
+    account.charge(window / 4);
+    EXPECT_FALSE(account.admit(quarter, 1000));
+
+    // four elapsed cycles earn one cycle of budget
+    EXPECT_TRUE(account.admit(quarter, 1004));
+    account.charge(1);
+    EXPECT_FALSE(account.admit(quarter, 1004));
+
+    // an evaluation that exceeds the budget is repaid before the next evaluation
+    EXPECT_TRUE(account.admit(quarter, 1008));
+    account.charge(3);
+    EXPECT_FALSE(account.admit(quarter, 1012));
+    EXPECT_FALSE(account.admit(quarter, 1016));
+    EXPECT_TRUE(account.admit(quarter, 1017));
+    account.charge(1);
+
+    // idle periods earn at most window / 4 cycles of budget
+    EXPECT_TRUE(account.admit(quarter, 1017 + 100 * window));
+    account.charge(window / 4);
+    EXPECT_FALSE(account.admit(quarter, 1017 + 100 * window));
+
+    kassert::TimeBudgetStatistics statistics{};
+    account.collect(statistics);
+    EXPECT_EQ(statistics.evaluations, 5u);
+    EXPECT_EQ(statistics.skipped, 5u);
+    EXPECT_EQ(statistics.cycles, window / 2 + 5);
+    EXPECT_EQ(statistics.elapsed_cycles, 17u + 100 * window);
+}
+
+TEST(TimeBudgetTest, set_time_budget_returns_previous_budget) {
+    EXPECT_EQ(kassert::time_budget(unlimited_level), 1.0);
+    EXPECT_EQ(kassert::set_time_budget(unlimited_level, 0.25), 1.0);
+    EXPECT_EQ(kassert::time_budget(unlimited_level), 0.25);
+    EXPECT_EQ(kassert::set_time_budget(unlimited_level, 2.0), 0.25);
+    EXPECT_EQ(kassert::time_budget(unlimited_level), 1.0);
+    EXPECT_EQ(kassert::set_time_budget(unlimited_level, -1.0), 1.0);
+    EXPECT_EQ(kassert::set_time_budget(unlimited_level, 1.0), 0.0);
+}
+
+TEST(TimeBudgetTest, levels_without_budget_are_always_evaluated) {
+    kassert::reset_time_budget_statistics();
+    int evaluations = 0;
+    for (int i = 0; i < 100; ++i) {
+        KASSERT_TIME_BUDGETED((++evaluations, true), "", unlimited_level);
+    }
+    EXPECT_EQ(evaluations, 100);
+    EXPECT_EQ(statistics_of(unlimited_level).evaluations, 0u);
+}
+
+TEST(TimeBudgetTest, zero_budget_skips_all_assertions) {
+    ScopedTimeBudget budget(zero_level, 0.0);
+    int              evaluations = 0;
+    for (int i = 0; i < 100; ++i) {
+        KASSERT_TIME_BUDGETED((++evaluations, true), "", zero_level);
+    }
+    EXPECT_EQ(evaluations, 0);
+    EXPECT_EQ(statistics_of(zero_level).skipped, 100u);
+    EXPECT_EQ(statistics_of(zero_level).coverage(), 0.0);
+}
+
+TEST(TimeBudgetTest, blocks_are_executed_completely_or_skipped) {
+    ScopedTimeBudget budget(block_level, 0.01);
+    int              first  = 0;
+    int              second = 0;
+    for (int i = 0; i < 1000; ++i) {
+        KASSERT_TIME_BUDGETED_BLOCK(block_level) {
+            ++first;
+            spin(1000);
+            ++second;
+        }
+    }
+    EXPECT_EQ(first, second);
+    EXPECT_GT(first, 0);
+    EXPECT_LT(first, 1000);
+
+    auto const statistics = statistics_of(block_level);
+    EXPECT_EQ(statistics.evaluations, static_cast<std::uint64_t>(first));
+    EXPECT_EQ(statistics.evaluations + statistics.skipped, 1000u);
+}
+
+TEST(TimeBudgetTest, disabled_blocks_are_not_executed) {
+    int executed = 0;
+    KASSERT_TIME_BUDGETED_BLOCK(disabled_level) {
+        ++executed;
+    }
+    KASSERT_TIME_BUDGETED((++executed, true), "", disabled_level);
+    EXPECT_EQ(executed, 0);
+}
+
+TEST(TimeBudgetTest, time_spent_adapts_to_budget) {
+    ScopedTimeBudget budget(adaptive_level, 0.1);
+    auto             expensive = [] {
+        spin(20000);
+        return true;
+    };
+    for (int i = 0; i < 2000; ++i) {
+        spin(20000);
+        KASSERT_TIME_BUDGETED(expensive(), "", adaptive_level);
+    }
+
+    // evaluations cost about as much as the remaining work, i.e., about one in ten assertions fits into the budget
+    auto const statistics = statistics_of(adaptive_level);
+    EXPECT_EQ(statistics.evaluations + statistics.skipped, 2000u);
+    EXPECT_GT(statistics.coverage(), 0.0);
+    EXPECT_LT(statistics.coverage(), 0.5);
+    EXPECT_LT(statistics.time_fraction(), 0.3);
+}
+
+TEST(TimeBudgetTest, statistics_are_aggregated_over_threads) {
+    ScopedTimeBudget budget(thread_level, 0.0);
+    auto             check = [] {
+        for (int i = 0; i < 10; ++i) {
+            KASSERT_TIME_BUDGETED(false, "", thread_level);
+        }
+    };
+    std::thread first(check);
+    std::thread second(check);
+    first.join();
+    second.join();
+    check();
+    EXPECT_EQ(statistics_of(thread_level).skipped, 30u);
+}
+
+TEST(TimeBudgetTest, prints_report) {
+    ScopedTimeBudget budget(report_level, 0.0);
+    for (int i = 0; i < 4; ++i) {
+        KASSERT_TIME_BUDGETED(i < 0, "", report_level);
+    }
+    std::ostringstream report;
+    kassert::print_time_budget_report(report);
+    EXPECT_THAT(report.str(), StartsWith("level"));
+    EXPECT_THAT(report.str(), ContainsRegex("25 +0.00 +0 +4 +0.00 +"));
+}
+
+TEST(TimeBudgetTest, prints_report_at_exit_if_assertions_were_skipped) {
+    EXPECT_EXIT(
+        {
+            kassert::set_time_budget(report_level, 0.0);
+            KASSERT_TIME_BUDGETED(false, "", report_level);
+            std::exit(0);
+        },
+        ExitedWithCode(0),
+        "some time-budgeted assertions were skipped"
+    );
+}
+
+TEST(TimeBudgetTest, failures_are_reported) {
+    ScopedTimeBudget budget(failure_level, 0.5);
+    auto             lt = [](int const lhs, int const rhs) {
+        KASSERT_TIME_BUDGETED(lhs < rhs, "budgeted " << lhs, failure_level);
+    };
+    // the first assertion of each thread starts with a full bucket
+    EXPECT_EXIT(
+        lt(2, 1),
+        KilledBySignal(SIGABRT),
+        "FAILED ASSERTION\n\tlhs < rhs\nwith expansion:\n\t2 < 1\nbudgeted 2"
+    );
+}